@@ -2,5 +2,24 @@
 /**
  * @brief Shared constants
  */
-#define EPS 0.0001
-#define NEGATIVE_INFINITY -1.0 * INFINITY
\ No newline at end of file
+namespace raytracerchallenge {
+  /**
+   * @brief The floating-point type used for geometry and color. Define
+   * RAYTRACERCHALLENGE_SINGLE_PRECISION to build the library with floats,
+   * which halves the size of tuples, colors and intersections.
+   */
+#ifdef RAYTRACERCHALLENGE_SINGLE_PRECISION
+  using Scalar = float;
+#else
+  using Scalar = double;
+#endif
+  /**
+   * @brief Tolerance used to compare values, and to offset points from
+   * surfaces, at a given precision. Rounding errors in float intersections
+   * are far larger, so floats need a wider margin.
+   */
+  template <typename T> constexpr T epsilon = T(0.0001);
+  template <> constexpr float epsilon<float> = 0.0002F;
+}  // namespace raytracerchallenge
+#define EPS raytracerchallenge::epsilon<raytracerchallenge::Scalar>
+#define NEGATIVE_INFINITY (-INFINITY)
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <raytracerchallenge/base/BoundingBox.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace raytracerchallenge {
+  /**
+   * @brief Algorithms available for building a bounding volume hierarchy
+   */
+  enum class BVHMethod {
+    /* Binned surface area heuristic; slower to build, faster to traverse */
+    SAH,
+    /* Linear BVH over primitives sorted by the Morton code of their centroids */
+    Morton
+  };
+  /**
+   * @brief Parameters controlling how a bounding volume hierarchy is built
+   */
+  struct BVHOptions {
+    /* Algorithm used to choose splits */
+    BVHMethod method = BVHMethod::SAH;
+    /* Largest number of primitives which may share a leaf */
+    unsigned int maxLeafSize = 4;
+    /* Cost of visiting a node, relative to intersectionCost */
+    double traversalCost = 1.0;
+    /* Cost of intersecting a single primitive */
+    double intersectionCost = 1.0;
+    /* Number of centroid bins evaluated on each axis */
+    unsigned int bins = 16;
+    /* Ranges with at least this many primitives have their subtrees built
+       concurrently, until every build thread has a subtree; the root range,
+       and any other built while no other subtree is, is binned on every core */
+    size_t parallelThreshold = 16384;
+    /* Number of threads subtrees are built on; zero for one per core */
+    unsigned int buildThreads = 0;
+    /* Length of the Morton codes used by BVHMethod::Morton; either 30 or 63 */
+    unsigned int mortonBits = 30;
+    /* A refitted hierarchy is rebuilt once its SAH cost grows beyond this
+       multiple of its cost when it was built */
+    double rebuildThreshold = 1.5;
+    /* Allow nodes to be split in space, clipping primitives which straddle the
+       split into both children. Only LinearBVH::create(shapes) uses this, as a
+       group cannot hold the same shape twice. */
+    bool spatialSplits = false;
+    /* Upper bound on the number of primitive references created by spatial
+       splits, as a multiple of the number of primitives */
+    double spatialSplitBudget = 1.5;
+    /* Spatial splits are only tried where the children of the best object
+       split overlap by more than this fraction of the root's surface area */
+    double spatialSplitOverlap = 1e-5;
+    /* Children per node of the hierarchy compiled by World::build: 2 for a
+       LinearBVH, or 4 or 8 for a WideBVH. Only a LinearBVH traces the
+       World's ray packets together; a WideBVH traces them one at a time */
+    unsigned int width = 2;
+  };
+  /**
+   * @brief Statistics describing a completed build
+   */
+  struct BVHBuildStats {
+    /* Wall-clock time taken by the build, in seconds */
+    double buildSeconds = 0.0;
+    /* Number of nodes in the tree, including leaves */
+    size_t nodes = 0;
+    /* Number of leaves in the tree */
+    size_t leaves = 0;
+    /* Number of primitive references in the leaves; this exceeds the number
+       of primitives when spatial splits have duplicated some of them */
+    size_t references = 0;
+    /* Expected cost of tracing a ray through the tree, estimated with the
+       surface area heuristic; lower is better */
+    double sahCost = 0.0;
+  };
+  /**
+   * @brief A node in the intermediate tree produced by a BVHBuilder
+   */
+  class BVHBuildNode {
+  public:
+    /* Bounds of every primitive below this node */
+    BoundingBox bounds;
+    /* Children of an interior node; both are null for leaves */
+    std::unique_ptr<BVHBuildNode> left;
+    std::unique_ptr<BVHBuildNode> right;
+    /* First entry of the builder's ordering covered by this node */
+    size_t first = 0;
+    /* Number of entries of the builder's ordering covered by this node */
+    size_t count = 0;
+    /* Axis this node was split on */
+    int axis = 0;
+    /**
+     * @brief Return true if this node has no children
+     * @return true if this is a leaf
+     */
+    [[nodiscard]] bool isLeaf() const { return this->left == nullptr; }
+  };
+  /**
+   * @brief Returns the bounds of the part of a primitive inside a box
+   */
+  using BVHClipFunction = std::function<BoundingBox(size_t primitive, const BoundingBox &box)>;
+  /**
+   * @brief Builds a bounding volume hierarchy over a set of primitive bounds,
+   * choosing splits with the binned surface area heuristic, optionally with
+   * spatial splits, or, for faster builds, by sorting primitives along a
+   * Morton curve. Large SAH ranges are
+   * binned and recursed into in parallel; the resulting tree is the same as
+   * a sequential build.
+   */
+  class BVHBuilder {
+  public:
+    /**
+     * @brief Create a builder
+     * @param options build parameters
+     */
+    explicit BVHBuilder(BVHOptions options = BVHOptions());
+    /**
+     * @brief Build a hierarchy over the provided bounds
+     * @param bounds Bounds of each primitive; these must be finite
+     * @param clip Clips primitives for spatial splits; if empty, their bounds
+     * are clipped instead
+     * @return The root of the hierarchy, or nullptr if bounds is empty
+     */
+    std::unique_ptr<BVHBuildNode> build(const std::vector<BoundingBox> &bounds,
+                                        const BVHClipFunction &clip = nullptr);
+    /**
+     * @brief Primitive indices in the order in which the leaves reference them.
+     * A primitive appears more than once if spatial splits duplicated it.
+     * @return ordering of the primitives passed to build()
+     */
+    [[nodiscard]] const std::vector<size_t> &order() const;
+    /**
+     * @brief Statistics describing the last call to build()
+     * @return build statistics
+     */
+    [[nodiscard]] const BVHBuildStats &stats() const;
+
+  private:
+    struct BinGrid;
+    struct Reference {
+      size_t primitive;
+      BoundingBox box;
+    };
+    BVHOptions options;
+    BVHClipFunction clipper;
+    size_t referenceBudget = 0;
+    size_t referenceCount = 0;
+    double rootArea = 0.0;
+    BVHBuildStats buildStats;
+    std::vector<size_t> indices;
+    std::vector<BoundingBox> primitiveBounds;
+    std::vector<Tuple> centroids;
+    unsigned int threads = 1;
+    std::unique_ptr<BVHBuildNode> buildRange(size_t first, size_t last, unsigned int tasks);
+    std::unique_ptr<BVHBuildNode> buildSpatial(std::vector<Reference> &references,
+                                               unsigned int depth);
+    BoundingBox clip(const Reference &reference, const BoundingBox &box) const;
+    std::unique_ptr<BVHBuildNode> buildMorton();
+    std::unique_ptr<BVHBuildNode> emitMorton(const std::vector<std::uint64_t> &codes, size_t first,
+                                             size_t last, int bit) const;
+    void binRange(size_t first, size_t last, const BoundingBox &centroidBounds,
+                  BinGrid &grid) const;
+  };
+}  // namespace raytracerchallenge
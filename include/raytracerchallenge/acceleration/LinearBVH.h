@@ -0,0 +1,116 @@
+#pragma once
+
+#include <raytracerchallenge/acceleration/LinearBVHNode.h>
+#include <raytracerchallenge/acceleration/RayPacket.h>
+#include <raytracerchallenge/shapes/Shape.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace raytracerchallenge {
+  /**
+   * @brief A bounding volume hierarchy compiled into a flat array of nodes,
+   * which is traversed iteratively rather than by recursing through groups
+   */
+  class LinearBVH : public Shape {
+  public:
+    /* Nodes in depth-first order, starting with the root */
+    std::vector<LinearBVHNode> nodes;
+    /* Primitives referenced by the leaves */
+    std::vector<std::shared_ptr<Shape>> primitives;
+    /**
+     * @brief Compile a shape hierarchy into a LinearBVH. Nested groups with an
+     * identity transform are flattened into nodes; any other shape, including a
+     * transformed group, becomes a primitive. The root group's transform is
+     * carried over to the new shape.
+     * @param root Shape to compile, normally a Group
+     * @return a pointer to a new LinearBVH
+     */
+    static std::shared_ptr<Shape> create(const std::shared_ptr<Shape> &root);
+    /**
+     * @brief Build a LinearBVH over a list of shapes using the surface area heuristic.
+     * The shapes keep their own transforms and must have finite bounds. With
+     * spatial splits enabled, a shape may be referenced by several leaves.
+     * @param shapes Shapes to build the hierarchy over
+     * @param options build parameters
+     * @return a pointer to a new LinearBVH
+     */
+    static std::shared_ptr<Shape> create(const std::vector<std::shared_ptr<Shape>> &shapes,
+                                         const BVHOptions &options = BVHOptions());
+    Tuple localNormalAt(Tuple point, Intersection hit) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
+    bool localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection &closest) override;
+    bool localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) override;
+    /**
+     * @brief Find the nearest intersection along each ray of a packet,
+     * traversing the hierarchy once for all of them with a shared stack.
+     * Each node is tested against every ray still passing through its
+     * parent at once; where only a few rays reach a node they finish its
+     * subtree one at a time.
+     * @param packet rays in object space, each with the range of t to
+     * search; the end of each range shrinks to the nearest hit found
+     * @param rays the same rays, indexed by lane, for testing primitives
+     * @param closest set to the nearest intersection along each ray which
+     * hits, indexed by lane
+     * @return mask of the lanes whose rays hit
+     */
+    template <unsigned int Width>
+    unsigned int localIntersectClosest(RayPacket<Width> &packet, const Ray *rays,
+                                       Intersection *closest);
+    /**
+     * @brief Find which rays of a packet are blocked by any shadow-casting
+     * primitive, traversing the hierarchy once for all of them
+     * @param packet rays in object space, each with the range of t to search
+     * @param rays the same rays, indexed by lane, for testing primitives
+     * @return mask of the lanes whose rays are blocked
+     */
+    template <unsigned int Width>
+    unsigned int localIntersectsAny(const RayPacket<Width> &packet, const Ray *rays);
+    BoundingBox bounds() override;
+    [[nodiscard]] bool includes(const Shape &object) const override;
+    void setMaterial(std::shared_ptr<Material> &newMaterial) override;
+    void freeze() override;
+    void thaw() override;
+    /**
+     * @brief Recompute node bounds bottom-up after primitives have moved,
+     * keeping the node layout. The hierarchy is rebuilt instead once its SAH
+     * cost grows past the rebuild threshold.
+     */
+    void refit() override;
+    /**
+     * @brief Estimate the cost of tracing a ray through this hierarchy with
+     * the surface area heuristic
+     * @return estimated cost; lower is better
+     */
+    [[nodiscard]] double sahCost() const;
+
+  private:
+    struct Item {
+      std::shared_ptr<Shape> shape;
+      BoundingBox box;
+      bool expand;
+    };
+    std::shared_ptr<Shape> root;
+    BoundingBox rootBounds;
+    BVHOptions options;
+    double builtCost = 0.0;
+    unsigned int depth = 0;
+    /* Whether spatial splits placed any primitive in more than one leaf */
+    bool duplicates = false;
+    /* Whether each primitive reference shares its primitive with another leaf */
+    std::vector<bool> split;
+    static std::vector<Item> itemsOf(const std::shared_ptr<Shape> &group);
+    void clear();
+    void build();
+    void build(const std::vector<std::shared_ptr<Shape>> &shapes);
+    bool closestFrom(std::uint32_t start, const Ray &ray, Scalar tMin, Scalar tMax,
+                     Intersection &closest);
+    bool anyFrom(std::uint32_t start, const Ray &ray, Scalar tMin, Scalar tMax);
+    std::uint32_t flatten(const std::vector<Item> &items, unsigned int level);
+    std::uint32_t emit(const BVHBuildNode &node, const std::vector<std::shared_ptr<Shape>> &shapes,
+                       const std::vector<size_t> &order,
+                       const std::vector<unsigned int> &references, unsigned int level);
+  };
+}  // namespace raytracerchallenge
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <raytracerchallenge/base/BoundingBox.h>
+#include <raytracerchallenge/base/Ray.h>
+
+#include <cstdint>
+#include <limits>
+
+namespace raytracerchallenge {
+  /**
+   * @brief A node of a LinearBVH. The first child of an interior node is stored
+   * directly after it and the second child at offset; a leaf covers count
+   * primitives starting at offset. Bounds are rounded outwards to floats.
+   */
+  struct LinearBVHNode {
+    float min[3];
+    float max[3];
+    /* Second child of an interior node, or first primitive of a leaf */
+    std::uint32_t offset;
+    /* Number of primitives in a leaf; zero for interior nodes */
+    std::uint16_t count;
+    /* Axis used to order traversal of an interior node's children */
+    std::uint8_t axis;
+    std::uint8_t pad;
+  };
+  static_assert(sizeof(LinearBVHNode) == 32, "LinearBVHNode should fit in half a cache line");
+  /**
+   * @brief Round a value down to the nearest float which is not above it
+   * @param value value to round
+   * @return the rounded value
+   */
+  float roundDown(double value);
+  /**
+   * @brief Round a value up to the nearest float which is not below it
+   * @param value value to round
+   * @return the rounded value
+   */
+  float roundUp(double value);
+  /**
+   * @brief Build a node whose bounds hold a box, rounded outwards to floats.
+   * Its axis is the longest axis of the box, and it has no children.
+   * @param box bounds of the node
+   * @return the new node
+   */
+  LinearBVHNode packNode(const BoundingBox &box);
+  /**
+   * @brief A ray prepared for repeated tests against node bounds
+   */
+  struct NodeRay {
+    Scalar origin[3];
+    Scalar inverse[3];
+    int sign[3];
+    explicit NodeRay(const Ray &ray)
+        : origin{ray.origin.x, ray.origin.y, ray.origin.z},
+          inverse{ray.inverseDirection.x, ray.inverseDirection.y, ray.inverseDirection.z},
+          sign{ray.sign[0], ray.sign[1], ray.sign[2]} {}
+  };
+  /**
+   * Bound on the relative rounding error of each distance to a plane. Widening
+   * exits by it keeps a ray through an edge or corner of a box from slipping
+   * between the slabs, as it may where a vertex lies exactly on the box.
+   */
+  constexpr Scalar NODE_SLAB_ERROR = 4 * std::numeric_limits<Scalar>::epsilon();
+  /**
+   * @brief Return true if a ray passes through the bounds of a node with t in
+   * [tMin, tMax]. Defined here so that traversal loops can inline it.
+   * @param node node to test
+   * @param ray ray to test
+   * @param tMin smallest t to accept
+   * @param tMax largest t to accept
+   * @return true if the ray may hit something in the node
+   */
+  inline bool intersectsNode(const LinearBVHNode &node, const NodeRay &ray, Scalar tMin,
+                             Scalar tMax) {
+    const float *planes[2] = {node.min, node.max};
+    for (auto axis = 0; axis < 3; axis++) {
+      auto t0 = (Scalar(planes[ray.sign[axis]][axis]) - ray.origin[axis]) * ray.inverse[axis];
+      auto t1 = (Scalar(planes[1 - ray.sign[axis]][axis]) - ray.origin[axis]) * ray.inverse[axis];
+      t1 *= t1 > 0 ? 1 + NODE_SLAB_ERROR : 1 - NODE_SLAB_ERROR;
+      // Written so that a NaN, from a ray starting on a plane it runs along, is ignored
+      tMin = t0 > tMin ? t0 : tMin;
+      tMax = t1 < tMax ? t1 : tMax;
+    }
+    return tMin <= tMax;
+  }
+}  // namespace raytracerchallenge
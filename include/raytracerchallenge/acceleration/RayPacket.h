@@ -0,0 +1,57 @@
+#pragma once
+
+#include <raytracerchallenge/base/Ray.h>
+
+#include <cstdint>
+
+namespace raytracerchallenge {
+  /**
+   * @brief Up to Width rays traced together through a bounding volume
+   * hierarchy, stored as structures of arrays so that a single SIMD pass can
+   * test every ray against a node's bounds. Each lane also holds the range
+   * of t still searched along its ray, which shrinks as hits are found.
+   */
+  template <unsigned int Width> struct alignas(32) RayPacket {
+    static_assert(Width == 4 || Width == 8 || Width == 16, "packets hold 4, 8 or 16 rays");
+    Scalar origin[3][Width];
+    Scalar inverse[3][Width];
+    Scalar tMin[Width];
+    Scalar tMax[Width];
+    /* Mask of the lanes which hold rays */
+    std::uint32_t active = 0;
+  };
+  /**
+   * @brief Store a ray in one lane of a packet
+   * @param packet packet to fill
+   * @param lane lane to fill
+   * @param ray ray to store
+   * @param tMin smallest t to accept
+   * @param tMax intersections at or beyond this t are ignored
+   */
+  template <unsigned int Width>
+  void setRayLane(RayPacket<Width> &packet, unsigned int lane, const Ray &ray, Scalar tMin,
+                  Scalar tMax) {
+    packet.origin[0][lane] = ray.origin.x;
+    packet.origin[1][lane] = ray.origin.y;
+    packet.origin[2][lane] = ray.origin.z;
+    packet.inverse[0][lane] = ray.inverseDirection.x;
+    packet.inverse[1][lane] = ray.inverseDirection.y;
+    packet.inverse[2][lane] = ray.inverseDirection.z;
+    packet.tMin[lane] = tMin;
+    packet.tMax[lane] = tMax;
+    packet.active |= 1U << lane;
+  }
+  /**
+   * @brief Test the rays of a packet against a box, using SSE where the
+   * processor has it. Each lane gives exactly the result of testing its ray
+   * alone, so a packet visits every node that its rays would.
+   * @param packet rays to test, each over its own range of t
+   * @param min lower corner of the box
+   * @param max upper corner of the box
+   * @param mask lanes to test
+   * @return the lanes of mask whose rays pass through the box
+   */
+  template <unsigned int Width>
+  unsigned int intersectBounds(const RayPacket<Width> &packet, const float *min, const float *max,
+                               unsigned int mask);
+}  // namespace raytracerchallenge
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <raytracerchallenge/base/Ray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace raytracerchallenge {
+  /**
+   * @brief Four or eight triangles stored as structures of arrays, one lane
+   * per triangle, so that a single SIMD pass can intersect a ray with all of
+   * them. Each triangle is held as its first vertex and two edges in floats,
+   * with the largest magnitude of each, which bound the rounding error of the
+   * test. Unused lanes hold NaNs, which fail every comparison.
+   */
+  template <unsigned int Width> struct alignas(32) TrianglePacket {
+    float p1X[Width];
+    float p1Y[Width];
+    float p1Z[Width];
+    float e1X[Width];
+    float e1Y[Width];
+    float e1Z[Width];
+    float e2X[Width];
+    float e2Y[Width];
+    float e2Z[Width];
+    /* Largest magnitude of any coordinate of the first vertex, and of either edge */
+    float p1Scale[Width];
+    float e1Scale[Width];
+    float e2Scale[Width];
+    /* Index of the triangle held in each lane, as known to the packet's owner */
+    std::uint32_t triangle[Width];
+  };
+  static_assert(sizeof(TrianglePacket<4>) == 224,
+                "TrianglePacket<4> should hold 52 bytes a lane, padded to 32 bytes");
+  static_assert(sizeof(TrianglePacket<8>) == 416, "TrianglePacket<8> should hold 52 bytes a lane");
+  /**
+   * @brief A ray prepared for testing against triangle packets
+   */
+  struct PacketRay {
+    float origin[3];
+    float direction[3];
+    /* Largest magnitude of any coordinate of the origin, and of the direction */
+    float originScale;
+    float directionScale;
+    explicit PacketRay(const Ray &ray)
+        : origin{float(ray.origin.x), float(ray.origin.y), float(ray.origin.z)},
+          direction{float(ray.direction.x), float(ray.direction.y), float(ray.direction.z)},
+          originScale(float(std::max(
+              {std::abs(ray.origin.x), std::abs(ray.origin.y), std::abs(ray.origin.z)}))),
+          directionScale(float(std::max({std::abs(ray.direction.x), std::abs(ray.direction.y),
+                                         std::abs(ray.direction.z)}))) {}
+  };
+  /**
+   * @brief Store a triangle in one lane of a packet
+   * @param packet packet to fill
+   * @param lane lane to fill
+   * @param p1 first vertex
+   * @param p2 second vertex
+   * @param p3 third vertex
+   * @param triangle index reported for this lane
+   */
+  template <unsigned int Width>
+  void setTriangleLane(TrianglePacket<Width> &packet, unsigned int lane, const Tuple &p1,
+                       const Tuple &p2, const Tuple &p3, std::uint32_t triangle) {
+    auto e1 = p2 - p1;
+    auto e2 = p3 - p1;
+    packet.p1X[lane] = float(p1.x);
+    packet.p1Y[lane] = float(p1.y);
+    packet.p1Z[lane] = float(p1.z);
+    packet.e1X[lane] = float(e1.x);
+    packet.e1Y[lane] = float(e1.y);
+    packet.e1Z[lane] = float(e1.z);
+    packet.e2X[lane] = float(e2.x);
+    packet.e2Y[lane] = float(e2.y);
+    packet.e2Z[lane] = float(e2.z);
+    packet.p1Scale[lane] = float(std::max({std::abs(p1.x), std::abs(p1.y), std::abs(p1.z)}));
+    packet.e1Scale[lane] = float(std::max({std::abs(e1.x), std::abs(e1.y), std::abs(e1.z)}));
+    packet.e2Scale[lane] = float(std::max({std::abs(e2.x), std::abs(e2.y), std::abs(e2.z)}));
+    packet.triangle[lane] = triangle;
+  }
+  /**
+   * @brief Fill one lane of a packet with NaNs, so that no ray hits it
+   * @param packet packet to fill
+   * @param lane lane to clear
+   */
+  template <unsigned int Width>
+  void clearTriangleLane(TrianglePacket<Width> &packet, unsigned int lane) {
+    auto nan = std::numeric_limits<Scalar>::quiet_NaN();
+    auto point = Tuple::point(nan, nan, nan);
+    setTriangleLane(packet, lane, point, point, point, 0);
+  }
+  /**
+   * @brief Intersect a ray with every triangle of a packet by Möller–Trumbore
+   * in one SIMD pass, using SSE for four lanes and AVX2 for eight where the
+   * processor supports it. The test runs in floats, widening each comparison
+   * by a bound on the rounding error, so that it never misses a triangle the
+   * test would hit at full precision. Callers confirm each lane reported at
+   * full precision.
+   * @param packet triangles to test
+   * @param ray ray to test
+   * @param tMin smallest t to accept
+   * @param tMax intersections beyond this t are ignored
+   * @return a mask with a bit set for each lane which may be hit
+   */
+  unsigned int intersectPacket(const TrianglePacket<4> &packet, const PacketRay &ray, float tMin,
+                               float tMax);
+  /**
+   * @brief Intersect a ray with every triangle of an eight-wide packet
+   * @param packet triangles to test
+   * @param ray ray to test
+   * @param tMin smallest t to accept
+   * @param tMax intersections beyond this t are ignored
+   * @return a mask with a bit set for each lane which may be hit
+   */
+  unsigned int intersectPacket(const TrianglePacket<8> &packet, const PacketRay &ray, float tMin,
+                               float tMax);
+}  // namespace raytracerchallenge
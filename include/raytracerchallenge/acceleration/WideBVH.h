@@ -0,0 +1,108 @@
+#pragma once
+
+#include <raytracerchallenge/shapes/Shape.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace raytracerchallenge {
+  /**
+   * @brief A node of a WideBVH. The bounds of all children are stored as
+   * structures of arrays so that a single SIMD step can test a ray against
+   * every child. Bounds are rounded outwards to floats; unused lanes hold empty
+   * bounds which no ray can hit.
+   */
+  template <unsigned int Width> struct alignas(32) WideBVHNode {
+    float minX[Width];
+    float minY[Width];
+    float minZ[Width];
+    float maxX[Width];
+    float maxY[Width];
+    float maxZ[Width];
+    /* Index of an interior child, or first primitive of a leaf */
+    std::uint32_t child[Width];
+    /* Number of primitives in a leaf; zero for interior and unused lanes */
+    std::uint32_t count[Width];
+  };
+  static_assert(sizeof(WideBVHNode<4>) == 128, "WideBVHNode<4> should fit in two cache lines");
+  static_assert(sizeof(WideBVHNode<8>) == 256, "WideBVHNode<8> should fit in four cache lines");
+  /**
+   * @brief A bounding volume hierarchy whose nodes have four or eight
+   * children, built by collapsing a binary SAH hierarchy. Each traversal step
+   * tests all of a node's children at once with SSE or AVX2, chosen at
+   * runtime, falling back to scalar code on other processors.
+   */
+  class WideBVH : public Shape {
+  public:
+    /* Nodes of a 4-wide hierarchy in depth-first order, starting with the root */
+    std::vector<WideBVHNode<4>> nodes4;
+    /* Nodes of an 8-wide hierarchy in depth-first order, starting with the root */
+    std::vector<WideBVHNode<8>> nodes8;
+    /* Primitives referenced by the leaves */
+    std::vector<std::shared_ptr<Shape>> primitives;
+    /**
+     * @brief Build a WideBVH over a list of shapes. The shapes keep their own
+     * transforms and must have finite bounds. BVHOptions::width selects four
+     * or eight children per node; eight is only used where the processor
+     * supports AVX2. Spatial splits are not supported.
+     * @param shapes Shapes to build the hierarchy over
+     * @param options build parameters
+     * @return a pointer to a new WideBVH
+     */
+    static std::shared_ptr<Shape> create(const std::vector<std::shared_ptr<Shape>> &shapes,
+                                         const BVHOptions &options = BVHOptions());
+    /**
+     * @brief Return true if this processor can traverse nodes of the given
+     * width with SIMD instructions
+     * @param width number of children per node
+     * @return true if the width is supported
+     */
+    static bool supportsWidth(unsigned int width);
+    /**
+     * @brief Return the number of children per node
+     * @return 4 or 8
+     */
+    [[nodiscard]] unsigned int width() const;
+    Tuple localNormalAt(Tuple point, Intersection hit) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
+    bool localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection &closest) override;
+    bool localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) override;
+    BoundingBox bounds() override;
+    [[nodiscard]] bool includes(const Shape &object) const override;
+    void setMaterial(std::shared_ptr<Material> &newMaterial) override;
+    void freeze() override;
+    void thaw() override;
+    /**
+     * @brief Recompute node bounds bottom-up after primitives have moved,
+     * keeping the node layout. The hierarchy is rebuilt instead once its SAH
+     * cost grows past the rebuild threshold.
+     */
+    void refit() override;
+    /**
+     * @brief Estimate the cost of tracing a ray through this hierarchy with
+     * the surface area heuristic
+     * @return estimated cost; lower is better
+     */
+    [[nodiscard]] double sahCost() const;
+
+  private:
+    BoundingBox rootBounds;
+    BVHOptions options;
+    double builtCost = 0.0;
+    unsigned int depth = 0;
+    void build(const std::vector<std::shared_ptr<Shape>> &shapes);
+    template <unsigned int Width>
+    std::uint32_t collapse(const BVHBuildNode &node, std::vector<WideBVHNode<Width>> &nodes,
+                           const std::vector<std::shared_ptr<Shape>> &shapes,
+                           const std::vector<size_t> &order, unsigned int level);
+    template <unsigned int Width> void refitNodes(std::vector<WideBVHNode<Width>> &nodes);
+    template <unsigned int Width> double sahCost(const std::vector<WideBVHNode<Width>> &nodes) const;
+    template <unsigned int Width, typename Visit>
+    void traverse(const std::vector<WideBVHNode<Width>> &nodes, const Ray &ray, Scalar tMin,
+                  Scalar &tMax, Visit visit) const;
+    template <typename Visit> void traverse(const Ray &ray, Scalar tMin, Scalar &tMax,
+                                            Visit visit) const;
+  };
+}  // namespace raytracerchallenge
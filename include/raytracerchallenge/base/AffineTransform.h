@@ -0,0 +1,314 @@
+#pragma once
+
+#include <raytracerchallenge/Constants.h>
+
+#include "Transform.h"
+#include "Tuple.h"
+
+namespace raytracerchallenge {
+  /**
+   * @brief Square root usable in constant expressions, by Newton's method
+   * @param value a non-negative number
+   * @return the square root of value
+   */
+  constexpr double constexprSqrt(double value) {
+    if (value <= 0.0) {
+      return 0.0;
+    }
+    double root = value > 1.0 ? value : 1.0;
+    for (int i = 0; i < 1024; i++) {
+      double next = 0.5 * (root + value / root);
+      if (next >= root) {
+        break;
+      }
+      root = next;
+    }
+    return root;
+  }
+  /**
+   * @brief Sine usable in constant expressions. The angle is reduced to
+   * [-pi/2, pi/2] and summed as a Taylor series, which is accurate to a few
+   * units in the last place.
+   * @param radians angle in radians
+   * @return the sine of the angle
+   */
+  constexpr double constexprSin(double radians) {
+    constexpr double pi = 3.14159265358979323846;
+    double turns = radians / (2.0 * pi);
+    auto whole = static_cast<long long>(turns + (turns >= 0.0 ? 0.5 : -0.5));
+    double x = radians - static_cast<double>(whole) * (2.0 * pi);
+    if (x > pi / 2.0) {
+      x = pi - x;
+    } else if (x < -pi / 2.0) {
+      x = -pi - x;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 16; n++) {
+      term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+      sum += term;
+    }
+    return sum;
+  }
+  /**
+   * @brief Cosine usable in constant expressions
+   * @param radians angle in radians
+   * @return the cosine of the angle
+   */
+  constexpr double constexprCos(double radians) {
+    return constexprSin(radians + 3.14159265358979323846 / 2.0);
+  }
+  /**
+   * @brief An affine transform held as the top three rows of a 4x4 matrix in
+   * a plain array, so that it can be built and composed in constant
+   * expressions. Static scene fragments can compute their transforms at
+   * compile time and assign them to a Transform when they are used.
+   */
+  template <typename T> class BasicAffineTransform {
+  public:
+    /* Top three rows; the bottom row is always (0, 0, 0, 1) */
+    T m[3][4];
+    /**
+     * @brief Construct an identity transform
+     */
+    constexpr BasicAffineTransform()
+        : m{{T(1), T(0), T(0), T(0)}, {T(0), T(1), T(0), T(0)}, {T(0), T(0), T(1), T(0)}} {}
+    /**
+     * @brief Transform equality operator
+     * @param transform transform for comparison
+     * @return true if the transforms are approximately equal, as Transform compares them
+     */
+    constexpr bool operator==(const BasicAffineTransform &transform) const {
+      // Eigen's isApprox on the 4x4 matrices, whose shared bottom row (0, 0, 0, 1) adds one to
+      // each squared norm and nothing to their difference
+      T difference = T(0), norm = T(1), otherNorm = T(1);
+      for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 4; col++) {
+          T element = this->m[row][col], otherElement = transform.m[row][col];
+          difference += (element - otherElement) * (element - otherElement);
+          norm += element * element;
+          otherNorm += otherElement * otherElement;
+        }
+      }
+      return difference <= epsilon<T> * epsilon<T> * (norm < otherNorm ? norm : otherNorm);
+    }
+    /**
+     * @brief Transform inequality operator
+     * @param transform transform for comparison
+     * @return true if the transforms are not approximately equal, as Transform compares them
+     */
+    constexpr bool operator!=(const BasicAffineTransform &transform) const {
+      return !(*this == transform);
+    }
+    /**
+     * @brief Compose two transforms
+     * @param transform transform to be applied before this one
+     * @return product of the two transforms
+     */
+    constexpr BasicAffineTransform operator*(const BasicAffineTransform &transform) const {
+      BasicAffineTransform result;
+      for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 4; col++) {
+          T sum = col == 3 ? this->m[row][3] : T(0);
+          for (int k = 0; k < 3; k++) {
+            sum += this->m[row][k] * transform.m[k][col];
+          }
+          result.m[row][col] = sum;
+        }
+      }
+      return result;
+    }
+    /**
+     * @brief Apply this transform to a Tuple
+     * @param tuple Tuple to transform
+     * @return the transformed Tuple
+     */
+    constexpr BasicTuple<T> operator*(const BasicTuple<T> &tuple) const {
+      const auto &a = this->m;
+      return {a[0][0] * tuple.x + a[0][1] * tuple.y + a[0][2] * tuple.z + a[0][3] * tuple.w,
+              a[1][0] * tuple.x + a[1][1] * tuple.y + a[1][2] * tuple.z + a[1][3] * tuple.w,
+              a[2][0] * tuple.x + a[2][1] * tuple.y + a[2][2] * tuple.z + a[2][3] * tuple.w,
+              tuple.w};
+    }
+    /**
+     * @brief Convert to a Transform
+     * @return a Transform with the same elements
+     */
+    operator BasicTransform<T>() const {  // NOLINT(google-explicit-constructor)
+      typename BasicTransform<T>::Matrix4 matrix;
+      matrix << this->m[0][0], this->m[0][1], this->m[0][2], this->m[0][3], this->m[1][0],
+          this->m[1][1], this->m[1][2], this->m[1][3], this->m[2][0], this->m[2][1], this->m[2][2],
+          this->m[2][3], T(0), T(0), T(0), T(1);
+      return BasicTransform<T>(matrix);
+    }
+    /**
+     * @brief Translate this transform using the provided x, y, z values
+     * @return translated transform
+     */
+    [[nodiscard]] constexpr BasicAffineTransform translated(T x, T y, T z) const {
+      // Translating only moves the last column, so no full product is needed
+      auto result = *this;
+      result.m[0][3] += x;
+      result.m[1][3] += y;
+      result.m[2][3] += z;
+      return result;
+    }
+    /**
+     * @brief Scale this transform using the provided x, y, z values
+     * @return scaled transform
+     */
+    [[nodiscard]] constexpr BasicAffineTransform scaled(T x, T y, T z) const {
+      auto result = *this;
+      const T factors[3] = {x, y, z};
+      for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 4; col++) {
+          result.m[row][col] *= factors[row];
+        }
+      }
+      return result;
+    }
+    /**
+     * @brief Rotate this transform for the provided radians on the X axis
+     * @return X-rotated transform
+     */
+    [[nodiscard]] constexpr BasicAffineTransform rotatedX(T radians) const {
+      return rotationX(radians) * *this;
+    }
+    /**
+     * @brief Rotate this transform for the provided radians on the Y axis
+     * @return Y-rotated transform
+     */
+    [[nodiscard]] constexpr BasicAffineTransform rotatedY(T radians) const {
+      return rotationY(radians) * *this;
+    }
+    /**
+     * @brief Rotate this transform for the provided radians on the Z axis
+     * @return Z-rotated transform
+     */
+    [[nodiscard]] constexpr BasicAffineTransform rotatedZ(T radians) const {
+      return rotationZ(radians) * *this;
+    }
+    /**
+     * @brief Shear this transform using the provided params
+     * @return sheared transform
+     */
+    [[nodiscard]] constexpr BasicAffineTransform sheared(T xy, T xz, T yx, T yz, T zx, T zy) const {
+      return shearing(xy, xz, yx, yz, zx, zy) * *this;
+    }
+    /**
+     * @brief Return the identity transform
+     * @return identity transform
+     */
+    static constexpr BasicAffineTransform identity() { return {}; }
+    /**
+     * @brief Return a translation transform for the provided x, y, z values
+     * @return translation transform
+     */
+    static constexpr BasicAffineTransform translation(T x, T y, T z) {
+      return identity().translated(x, y, z);
+    }
+    /**
+     * @brief Return a scaling transform for the provided x, y, z values
+     * @return scaling transform
+     */
+    static constexpr BasicAffineTransform scaling(T x, T y, T z) {
+      BasicAffineTransform result;
+      result.m[0][0] = x;
+      result.m[1][1] = y;
+      result.m[2][2] = z;
+      return result;
+    }
+    /**
+     * @brief Return an X-rotation transform for the provided radians
+     * @return X-rotation transform
+     */
+    static constexpr BasicAffineTransform rotationX(T radians) {
+      BasicAffineTransform result;
+      result.m[1][1] = T(constexprCos(radians));
+      result.m[1][2] = T(-constexprSin(radians));
+      result.m[2][1] = T(constexprSin(radians));
+      result.m[2][2] = T(constexprCos(radians));
+      return result;
+    }
+    /**
+     * @brief Return a Y-rotation transform for the provided radians
+     * @return Y-rotation transform
+     */
+    static constexpr BasicAffineTransform rotationY(T radians) {
+      BasicAffineTransform result;
+      result.m[0][0] = T(constexprCos(radians));
+      result.m[0][2] = T(constexprSin(radians));
+      result.m[2][0] = T(-constexprSin(radians));
+      result.m[2][2] = T(constexprCos(radians));
+      return result;
+    }
+    /**
+     * @brief Return a Z-rotation transform for the provided radians
+     * @return Z-rotation transform
+     */
+    static constexpr BasicAffineTransform rotationZ(T radians) {
+      BasicAffineTransform result;
+      result.m[0][0] = T(constexprCos(radians));
+      result.m[0][1] = T(-constexprSin(radians));
+      result.m[1][0] = T(constexprSin(radians));
+      result.m[1][1] = T(constexprCos(radians));
+      return result;
+    }
+    /**
+     * @brief Return a shearing transform for the provided params
+     * @return shearing transform
+     */
+    static constexpr BasicAffineTransform shearing(T xy, T xz, T yx, T yz, T zx, T zy) {
+      BasicAffineTransform result;
+      result.m[0][1] = xy;
+      result.m[0][2] = xz;
+      result.m[1][0] = yx;
+      result.m[1][2] = yz;
+      result.m[2][0] = zx;
+      result.m[2][1] = zy;
+      return result;
+    }
+    /**
+     * @brief Return the view transform
+     * @param from location of eye
+     * @param to point where eye is looking
+     * @param up vector representing up
+     * @return View transform
+     */
+    static constexpr BasicAffineTransform view(BasicTuple<T> from, BasicTuple<T> to,
+                                               BasicTuple<T> up) {
+      double forward[3] = {double(to.x) - from.x, double(to.y) - from.y, double(to.z) - from.z};
+      normalize(forward);
+      double upward[3] = {up.x, up.y, up.z};
+      normalize(upward);
+      double left[3] = {};
+      cross(forward, upward, left);
+      double trueUp[3] = {};
+      cross(left, forward, trueUp);
+      BasicAffineTransform orientation;
+      for (int col = 0; col < 3; col++) {
+        orientation.m[0][col] = T(left[col]);
+        orientation.m[1][col] = T(trueUp[col]);
+        orientation.m[2][col] = T(-forward[col]);
+      }
+      return orientation * translation(-from.x, -from.y, -from.z);
+    }
+
+  private:
+    static constexpr void normalize(double (&v)[3]) {
+      double length = constexprSqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+      for (double &component : v) {
+        component /= length;
+      }
+    }
+    static constexpr void cross(const double (&a)[3], const double (&b)[3], double (&result)[3]) {
+      result[0] = a[1] * b[2] - a[2] * b[1];
+      result[1] = a[2] * b[0] - a[0] * b[2];
+      result[2] = a[0] * b[1] - a[1] * b[0];
+    }
+  };
+  /**
+   * @brief An AffineTransform in the precision the library is built with
+   */
+  using AffineTransform = BasicAffineTransform<Scalar>;
+}  // namespace raytracerchallenge
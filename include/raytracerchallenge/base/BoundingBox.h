@@ -1,6 +1,5 @@
 #pragma once
 
-#include <raytracerchallenge/base/Matrix.h>
 #include <raytracerchallenge/base/Ray.h>
 #include <raytracerchallenge/base/Tuple.h>
 
@@ -13,7 +12,7 @@ namespace raytracerchallenge {
     /* Point representing the minimum bound */
     Tuple min = Tuple::point(INFINITY, INFINITY, INFINITY);
     /* Point representing the maximum bound */
-    Tuple max = Tuple::point(double(-INFINITY), double(-INFINITY), double(-INFINITY));
+    Tuple max = Tuple::point(Scalar(-INFINITY), Scalar(-INFINITY), Scalar(-INFINITY));
     /**
      * @brief Default constructor
      */
@@ -57,18 +56,61 @@ namespace raytracerchallenge {
      * @param matrix Transformation matrix
      * @return Transformed box
      */
-    [[nodiscard]] BoundingBox transform(const Matrix &matrix) const;
+    [[nodiscard]] BoundingBox transform(const Transform &matrix) const;
     /**
      * @brief Check if a ray intersects this boc
      * @param ray
      * @return True if ray intersects this box
      */
     [[nodiscard]] bool intersects(Ray ray) const;
+    /**
+     * @brief Check if a ray passes through this box between two points along it
+     * @param ray
+     * @param tMin start of the interval along the ray
+     * @param tMax end of the interval along the ray
+     * @return True if the ray is inside this box somewhere in [tMin, tMax]
+     */
+    [[nodiscard]] bool intersects(Ray ray, Scalar tMin, Scalar tMax) const;
+    /**
+     * @brief Narrow an interval along a ray to the part inside this box, using
+     * the ray's precomputed inverse direction and signs
+     * @param ray
+     * @param tMin start of the interval, raised to where the ray enters the box
+     * @param tMax end of the interval, lowered to where the ray leaves the box
+     * @return True if any of the interval lies inside the box
+     */
+    bool clip(const Ray &ray, Scalar &tMin, Scalar &tMax) const;
     /**
      * Split this box in two
      * @return A vector, where the first element is the
      * left-hand box and the second is the right-hand box
      */
     std::vector<BoundingBox> split();
+    /**
+     * @brief Return the point at the centre of this box
+     * @return centre point
+     */
+    [[nodiscard]] Tuple centroid() const;
+    /**
+     * @brief Return the total area of the faces of this box
+     * @return surface area, or zero for an empty box
+     */
+    [[nodiscard]] Scalar surfaceArea() const;
+    /**
+     * @brief Returns true if every component of the box is finite
+     * @return true if the box has finite extent on every axis
+     */
+    [[nodiscard]] bool isFinite() const;
+    /**
+     * @brief Return true if this box contains no points
+     * @return true if min exceeds max on any axis
+     */
+    [[nodiscard]] bool isEmpty() const;
+    /**
+     * @brief Return the overlap between this box and another
+     * @param box box to clip against
+     * @return the intersection of the two boxes, which is empty if they are disjoint
+     */
+    [[nodiscard]] BoundingBox clipped(const BoundingBox &box) const;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "Transform.h"
+
+namespace raytracerchallenge {
+  /**
+   * @brief A Transform which computes its inverse, and the matrix used to
+   * transform normals, once when it is assigned rather than each time they
+   * are used. Assign a new transform instead of modifying m, which would leave
+   * them stale.
+   */
+  class CachedTransform : public Transform {
+  public:
+    /**
+     * @brief Construct an identity transform
+     */
+    CachedTransform();
+    /**
+     * @brief Construct a cached copy of a transform
+     * @param transform transform to copy
+     */
+    CachedTransform(const Transform &transform);  // NOLINT(google-explicit-constructor)
+    /**
+     * @brief Copy a cached transform with its inverse and normal matrix, but
+     * not the counter it reports changes to
+     * @param transform transform to copy
+     */
+    CachedTransform(const CachedTransform &transform);
+    /**
+     * @brief Replace this transform, updating its inverse and normal matrix
+     * @param transform new transform
+     * @return this transform
+     */
+    CachedTransform &operator=(const Transform &transform);
+    /**
+     * @brief Replace this transform with a copy of another cached transform,
+     * keeping the counter this one reports changes to
+     * @param transform new transform
+     * @return this transform
+     */
+    CachedTransform &operator=(const CachedTransform &transform);
+    /**
+     * @brief Return the precomputed inverse of this transform
+     * @return the inverse of this transform
+     */
+    [[nodiscard]] const Transform &inverse() const;
+    /**
+     * @brief Return the transpose of the inverse of this transform, without
+     * its translation, which maps normals from object to parent space
+     * @return the normal matrix
+     */
+    [[nodiscard]] const Transform &normalMatrix() const;
+    /**
+     * @brief Return a number which changes whenever this transform is assigned
+     * @return version of this transform; zero for a default transform
+     */
+    [[nodiscard]] std::uint64_t version() const;
+    /**
+     * @brief Increment a counter each time this transform is assigned. Shapes
+     * share one counter across a hierarchy, so that a child can tell whether
+     * any parent has moved without visiting them.
+     * @param counter counter to increment, or nullptr to stop counting
+     */
+    void reportChangesTo(std::shared_ptr<std::atomic<std::uint64_t>> counter);
+
+  private:
+    Transform inverseTransform;
+    Transform normalTransform;
+    std::uint64_t currentVersion = 0;
+    std::shared_ptr<std::atomic<std::uint64_t>> changes;
+    void update();
+  };
+}  // namespace raytracerchallenge
@@ -1,7 +1,7 @@
 #pragma once
 
+#include <raytracerchallenge/base/CachedTransform.h>
 #include <raytracerchallenge/base/Canvas.h>
-#include <raytracerchallenge/base/Matrix.h>
 #include <raytracerchallenge/base/Ray.h>
 #include <raytracerchallenge/base/World.h>
 
@@ -13,18 +13,18 @@ namespace raytracerchallenge {
   public:
     int hSize;
     int vSize;
-    double pixelSize;
-    double fieldOfView;
-    double halfWidth;
-    double halfHeight;
-    Matrix transform;
+    Scalar pixelSize;
+    Scalar fieldOfView;
+    Scalar halfWidth;
+    Scalar halfHeight;
+    CachedTransform transform;
     /**
      * Create a new camera
      * @param hSize horizontal size of canvas
      * @param vSize vertical size of canvas
      * @param fieldOfView camera angle
      */
-    Camera(int hSize, int vSize, double fieldOfView);
+    Camera(int hSize, int vSize, Scalar fieldOfView);
     /**
      * Return a ray targeting the pixel at this position
      * @param x X position
@@ -1,56 +1,95 @@
 #pragma once
 
+#include <raytracerchallenge/Constants.h>
+
+#include "Lanes4.h"
+
 namespace raytracerchallenge {
   /**
-   * @brief Represents an RGB color.
+   * @brief Represents an RGB color in floats or doubles. Channels are padded
+   * to four values so that arithmetic is defined inline with SIMD
+   * instructions.
    */
-  class Color {
+  template <typename T> class alignas(16) BasicColor {
   public:
-    double red{};
-    double green{};
-    double blue{};
+    T red{};
+    T green{};
+    T blue{};
     /**
      * Default constructor
      */
-    Color();
+    BasicColor() = default;
     /**
      * Constructor for a Color
      * @param red red value
      * @param green green value
      * @param blue value
      */
-    Color(double red, double green, double blue);
+    BasicColor(T red, T green, T blue);
     /**
      * @brief binary subtraction operator
      * @param c target for subtraction
      * @return difference of the operands
      */
-    Color operator-(const Color &c) const;
+    BasicColor operator-(const BasicColor &c) const;
     /**
      * @brief binary addition operator
      * @param c target for addition
      * @return sum of the operands
      */
-    Color operator+(const Color &c) const;
+    BasicColor operator+(const BasicColor &c) const;
     /**
      * @brief binary multiplication operator
      * @param c target for multiplication
      * @return product of the operands
      */
-    Color operator*(const Color &c) const;
+    BasicColor operator*(const BasicColor &c) const;
     /**
      * @brief scalar multiplication operator
      * @param f target for multiplication
-     * @return a new Color multiplied by f
+     * @return a new BasicColor multiplied by f
      */
-    Color operator*(double f) const;
+    BasicColor operator*(T f) const;
     /**
      * @brief equality operator
      * @param c target for comparison
      * @return true if the colors have the same red, green and blue values
      */
-    bool operator==(const Color &c) const;
+    bool operator==(const BasicColor &c) const;
+
+  private:
+    /* Always zero; pads the channels to a full SIMD register */
+    T padding{};
+    [[nodiscard]] Lanes4<T> lanes() const { return Lanes4<T>::load(&this->red); }
+    static BasicColor fromLanes(const Lanes4<T> &lanes) {
+      BasicColor result;
+      lanes.store(&result.red);
+      return result;
+    }
   };
+  static_assert(sizeof(BasicColor<double>) == 32, "Color channels should fill one SIMD register");
+  static_assert(sizeof(BasicColor<float>) == 16, "Color channels should fill one SIMD register");
+  template <typename T>
+  BasicColor<T>::BasicColor(T red, T green, T blue) : red(red), green(green), blue(blue) {}
+  template <typename T> BasicColor<T> BasicColor<T>::operator-(const BasicColor &c) const {
+    return fromLanes(this->lanes() - c.lanes());
+  }
+  template <typename T> BasicColor<T> BasicColor<T>::operator+(const BasicColor &c) const {
+    return fromLanes(this->lanes() + c.lanes());
+  }
+  template <typename T> BasicColor<T> BasicColor<T>::operator*(const BasicColor &c) const {
+    return fromLanes(this->lanes() * c.lanes());
+  }
+  template <typename T> BasicColor<T> BasicColor<T>::operator*(T f) const {
+    // Scaling keeps the padding at zero unless f is infinite or NaN
+    auto result = fromLanes(this->lanes() * Lanes4<T>::broadcast(f));
+    result.padding = T(0);
+    return result;
+  }
+  /**
+   * @brief A Color in the precision the library is built with
+   */
+  using Color = BasicColor<Scalar>;
   static const Color BLACK = {0.0, 0.0, 0.0};
   static const Color WHITE = {1.0, 1.0, 1.0};
-}  // namespace raytracerchallenge
\ No newline at end of file
+}  // namespace raytracerchallenge
@@ -11,22 +11,22 @@ namespace raytracerchallenge {
    */
   class Computations {
   public:
-    double t{};
-    std::shared_ptr<Shape> object;
+    Scalar t{};
+    Shape *object = nullptr;
     Tuple point;
     Tuple overPoint;
     Tuple underPoint;
     Tuple eyeVector;
     Tuple normalVector;
     Tuple reflectionVector;
-    double n1;
-    double n2;
+    Scalar n1 = 1.0;
+    Scalar n2 = 1.0;
     bool inside{};
     /**
      * Calculate the Schlick approximation for these computations
      * @param computations
      * @return schlick approximation
      */
-    static double schlick(const Computations &computations);
+    static Scalar schlick(const Computations &computations);
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
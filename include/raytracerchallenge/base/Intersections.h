@@ -2,6 +2,8 @@
 
 #include <raytracerchallenge/base/Ray.h>
 
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -20,19 +22,32 @@ namespace raytracerchallenge {
     /**
      * @brief the point on the ray where it intersected with an object
      */
-    double t{};
-    double u{};
-    double v{};
+    Scalar t{};
+    Scalar u{};
+    Scalar v{};
     /**
-     * @brief the object that intersected with the ray
+     * @brief index of the primitive hit, for shapes such as a TriangleMesh
+     * which hold many
      */
-    std::shared_ptr<Shape> object;
+    std::uint32_t primitive = 0;
+    /**
+     * @brief the object that intersected with the ray. Intersections do not
+     * own their objects, which are kept alive by the World or Group holding
+     * them, so copying an intersection never touches a reference count.
+     */
+    Shape *object = nullptr;
     /**
      * @brief Construct a new Intersection
      * @param t the point where this intersection occurred on a ray
      * @param object the object which intersected with the ray
      */
-    Intersection(double t, std::shared_ptr<Shape> object);
+    Intersection(Scalar t, Shape *object);
+    /**
+     * @brief Construct a new Intersection with a shared object
+     * @param t the point where this intersection occurred on a ray
+     * @param object the object which intersected with the ray
+     */
+    Intersection(Scalar t, const std::shared_ptr<Shape> &object);
     /**
      * @brief Default constructor
      */
@@ -53,7 +68,8 @@ namespace raytracerchallenge {
     /**
      * @brief Equality operator
      * @param intersection intersection to compare with this one
-     * @return true if the intersections have the same properties
+     * @return true if the intersections are with the same primitive of the
+     * same object at the same t
      */
     bool operator==(const Intersection &intersection) const;
     /**
@@ -64,10 +80,16 @@ namespace raytracerchallenge {
     bool operator<(const Intersection &intersection) const;
   };
   /**
-   * @brief A collection of Intersection objects
+   * @brief A collection of Intersection objects, which shapes append to as a
+   * ray is traced. The first few are held inline so that the common case of a
+   * handful of hits needs no heap allocation. Longer collections spill into
+   * overflow storage which is kept when the collection is cleared, so a
+   * collection reused across rays stops allocating once it has grown to fit.
    */
   class Intersections {
   public:
+    /* Number of intersections held without allocating */
+    static constexpr size_t inlineCapacity = 8;
     /**
      * @brief Return the smallest non-negative intersection in the collection
      * @return the smallest non-negative intersection in the collection
@@ -75,9 +97,9 @@ namespace raytracerchallenge {
     [[nodiscard]] std::optional<Intersection> hit() const;
     /**
      * @brief Construct a new Intersections
-     * @param intersections to be wrapped by this container
+     * @param intersections to be held by this container
      */
-    explicit Intersections(std::vector<Intersection> intersections);
+    Intersections(std::initializer_list<Intersection> intersections);
     /**
      * @brief Default constructor
      */
@@ -87,22 +109,66 @@ namespace raytracerchallenge {
      * @param x index
      * @return intersection at index x
      */
-    Intersection operator[](unsigned int x) const;
+    const Intersection &operator[](size_t x) const { return this->data()[x]; }
+    /**
+     * @brief Append an intersection
+     * @param intersection intersection to append
+     */
+    void add(const Intersection &intersection) {
+      if (this->count < inlineCapacity) {
+        this->inlineIntersections[this->count++] = intersection;
+        return;
+      }
+      this->spill(intersection);
+    }
     /**
      * @brief Add the content of an Intersections to this one.
      * @param newIntersections Intersections to be added.
      */
-    void addAll(Intersections newIntersections);
+    void addAll(const Intersections &newIntersections);
+    /**
+     * @brief Remove every intersection, keeping any overflow storage for reuse
+     */
+    void clear();
+    /**
+     * @brief Drop the intersections from an index onwards
+     * @param size number of intersections to keep
+     */
+    void truncate(size_t size);
     /**
      * @brief Sort the intersections
      */
     void sort();
+    /**
+     * @brief Sort the intersections from an index onwards, such as those
+     * appended by one shape
+     * @param first index of the first intersection to sort
+     */
+    void sort(size_t first);
     /**
      * @brief Return the number of intersections in the collection
      * @return number of intersections in the collection
      */
-    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t size() const { return this->count; }
+    /**
+     * @brief Return true if the collection holds no intersections
+     */
+    [[nodiscard]] bool empty() const { return this->count == 0; }
+    [[nodiscard]] Intersection *begin() { return this->data(); }
+    [[nodiscard]] Intersection *end() { return this->data() + this->count; }
+    [[nodiscard]] const Intersection *begin() const { return this->data(); }
+    [[nodiscard]] const Intersection *end() const { return this->data() + this->count; }
 
-    std::vector<Intersection> intersections;
+  private:
+    Intersection inlineIntersections[inlineCapacity];
+    std::vector<Intersection> overflow;
+    size_t count = 0;
+    [[nodiscard]] Intersection *data() {
+      return this->count > inlineCapacity ? this->overflow.data() : this->inlineIntersections;
+    }
+    [[nodiscard]] const Intersection *data() const {
+      return this->count > inlineCapacity ? this->overflow.data() : this->inlineIntersections;
+    }
+    void spill(const Intersection &intersection);
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX__)
+#  define RAYTRACERCHALLENGE_AVX
+#  include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define RAYTRACERCHALLENGE_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace raytracerchallenge {
+  /**
+   * @brief Four scalars held in SIMD registers, used to implement Tuple and
+   * Color arithmetic
+   */
+  template <typename T> struct Lanes4;
+  /**
+   * @brief Four doubles held in one AVX register where the compiler targets
+   * AVX, two SSE2 registers otherwise, or plain doubles on other processors
+   */
+  template <> struct Lanes4<double> {
+#if defined(RAYTRACERCHALLENGE_AVX)
+    __m256d v;
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+    __m128d lo;
+    __m128d hi;
+#else
+    double v[4];
+#endif
+    /**
+     * @brief Load four consecutive doubles
+     * @param values pointer to the first double
+     * @return the loaded values
+     */
+    static Lanes4 load(const double *values) {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX)
+      result.v = _mm256_loadu_pd(values);
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      result.lo = _mm_loadu_pd(values);
+      result.hi = _mm_loadu_pd(values + 2);
+#else
+      for (auto i = 0; i < 4; i++) {
+        result.v[i] = values[i];
+      }
+#endif
+      return result;
+    }
+    /**
+     * @brief Return four copies of a value
+     * @param value value to broadcast
+     * @return the broadcast value
+     */
+    static Lanes4 broadcast(double value) {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX)
+      result.v = _mm256_set1_pd(value);
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      result.lo = _mm_set1_pd(value);
+      result.hi = result.lo;
+#else
+      for (auto &lane : result.v) {
+        lane = value;
+      }
+#endif
+      return result;
+    }
+    /**
+     * @brief Store the four values to consecutive doubles
+     * @param values pointer to the first double
+     */
+    void store(double *values) const {
+#if defined(RAYTRACERCHALLENGE_AVX)
+      _mm256_storeu_pd(values, this->v);
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      _mm_storeu_pd(values, this->lo);
+      _mm_storeu_pd(values + 2, this->hi);
+#else
+      for (auto i = 0; i < 4; i++) {
+        values[i] = this->v[i];
+      }
+#endif
+    }
+    Lanes4 operator+(const Lanes4 &d) const {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX)
+      result.v = _mm256_add_pd(this->v, d.v);
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      result.lo = _mm_add_pd(this->lo, d.lo);
+      result.hi = _mm_add_pd(this->hi, d.hi);
+#else
+      for (auto i = 0; i < 4; i++) {
+        result.v[i] = this->v[i] + d.v[i];
+      }
+#endif
+      return result;
+    }
+    Lanes4 operator-(const Lanes4 &d) const {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX)
+      result.v = _mm256_sub_pd(this->v, d.v);
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      result.lo = _mm_sub_pd(this->lo, d.lo);
+      result.hi = _mm_sub_pd(this->hi, d.hi);
+#else
+      for (auto i = 0; i < 4; i++) {
+        result.v[i] = this->v[i] - d.v[i];
+      }
+#endif
+      return result;
+    }
+    Lanes4 operator*(const Lanes4 &d) const {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX)
+      result.v = _mm256_mul_pd(this->v, d.v);
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      result.lo = _mm_mul_pd(this->lo, d.lo);
+      result.hi = _mm_mul_pd(this->hi, d.hi);
+#else
+      for (auto i = 0; i < 4; i++) {
+        result.v[i] = this->v[i] * d.v[i];
+      }
+#endif
+      return result;
+    }
+    Lanes4 operator/(const Lanes4 &d) const {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX)
+      result.v = _mm256_div_pd(this->v, d.v);
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      result.lo = _mm_div_pd(this->lo, d.lo);
+      result.hi = _mm_div_pd(this->hi, d.hi);
+#else
+      for (auto i = 0; i < 4; i++) {
+        result.v[i] = this->v[i] / d.v[i];
+      }
+#endif
+      return result;
+    }
+    /**
+     * @brief Return the sum of the four values
+     * @return horizontal sum
+     */
+    [[nodiscard]] double sum() const {
+#if defined(RAYTRACERCHALLENGE_AVX)
+      auto pairs = _mm_add_pd(_mm256_castpd256_pd128(this->v), _mm256_extractf128_pd(this->v, 1));
+      return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+#elif defined(RAYTRACERCHALLENGE_SSE2)
+      auto pairs = _mm_add_pd(this->lo, this->hi);
+      return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+#else
+      return (this->v[0] + this->v[2]) + (this->v[1] + this->v[3]);
+#endif
+    }
+  };
+  /**
+   * @brief Four floats held in one SSE register, or plain floats on other
+   * processors
+   */
+  template <> struct Lanes4<float> {
+#if defined(RAYTRACERCHALLENGE_AVX) || defined(RAYTRACERCHALLENGE_SSE2)
+    __m128 v;
+#else
+    float v[4];
+#endif
+    static Lanes4 load(const float *values) {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX) || defined(RAYTRACERCHALLENGE_SSE2)
+      result.v = _mm_loadu_ps(values);
+#else
+      for (auto i = 0; i < 4; i++) {
+        result.v[i] = values[i];
+      }
+#endif
+      return result;
+    }
+    static Lanes4 broadcast(float value) {
+      Lanes4 result{};
+#if defined(RAYTRACERCHALLENGE_AVX) || defined(RAYTRACERCHALLENGE_SSE2)
+      result.v = _mm_set1_ps(value);
+#else
+      for (auto &lane : result.v) {
+        lane = value;
+      }
+#endif
+      return result;
+    }
+    void store(float *values) const {
+#if defined(RAYTRACERCHALLENGE_AVX) || defined(RAYTRACERCHALLENGE_SSE2)
+      _mm_storeu_ps(values, this->v);
+#else
+      for (auto i = 0; i < 4; i++) {
+        values[i] = this->v[i];
+      }
+#endif
+    }
+#if defined(RAYTRACERCHALLENGE_AVX) || defined(RAYTRACERCHALLENGE_SSE2)
+    Lanes4 operator+(const Lanes4 &d) const { return {_mm_add_ps(this->v, d.v)}; }
+    Lanes4 operator-(const Lanes4 &d) const { return {_mm_sub_ps(this->v, d.v)}; }
+    Lanes4 operator*(const Lanes4 &d) const { return {_mm_mul_ps(this->v, d.v)}; }
+    Lanes4 operator/(const Lanes4 &d) const { return {_mm_div_ps(this->v, d.v)}; }
+    [[nodiscard]] float sum() const {
+      auto pairs = _mm_add_ps(this->v, _mm_movehl_ps(this->v, this->v));
+      return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    }
+#else
+    Lanes4 operator+(const Lanes4 &d) const {
+      return {{this->v[0] + d.v[0], this->v[1] + d.v[1], this->v[2] + d.v[2], this->v[3] + d.v[3]}};
+    }
+    Lanes4 operator-(const Lanes4 &d) const {
+      return {{this->v[0] - d.v[0], this->v[1] - d.v[1], this->v[2] - d.v[2], this->v[3] - d.v[3]}};
+    }
+    Lanes4 operator*(const Lanes4 &d) const {
+      return {{this->v[0] * d.v[0], this->v[1] * d.v[1], this->v[2] * d.v[2], this->v[3] * d.v[3]}};
+    }
+    Lanes4 operator/(const Lanes4 &d) const {
+      return {{this->v[0] / d.v[0], this->v[1] / d.v[1], this->v[2] / d.v[2], this->v[3] / d.v[3]}};
+    }
+    [[nodiscard]] float sum() const {
+      return (this->v[0] + this->v[2]) + (this->v[1] + this->v[3]);
+    }
+#endif
+  };
+  /**
+   * @brief Return 1 / sqrt(value), starting from the single-precision
+   * hardware estimate where there is one and refining it to double precision
+   * with Newton-Raphson steps
+   * @param value a positive value
+   * @return reciprocal square root of value
+   */
+  inline double reciprocalSqrt(double value) {
+#if defined(RAYTRACERCHALLENGE_AVX) || defined(RAYTRACERCHALLENGE_SSE2)
+    if (value >= double(FLT_MIN) && value <= double(FLT_MAX)) {
+      double estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(float(value))));
+      // Each step doubles the 12 or so correct bits of the estimate
+      auto half = 0.5 * value;
+      estimate *= 1.5 - half * estimate * estimate;
+      estimate *= 1.5 - half * estimate * estimate;
+      estimate *= 1.5 - half * estimate * estimate;
+      return estimate;
+    }
+#endif
+    return 1.0 / std::sqrt(value);
+  }
+  /**
+   * @brief Return 1 / sqrt(value) for a float. The refinement is done in
+   * double precision so that the result is almost always correctly rounded,
+   * keeping vectors which are already unit length unchanged by normalizing.
+   * @param value a positive value
+   * @return reciprocal square root of value
+   */
+  inline float reciprocalSqrt(float value) { return float(reciprocalSqrt(double(value))); }
+}  // namespace raytracerchallenge
@@ -33,6 +33,6 @@ namespace raytracerchallenge {
    * @param inShadow Whether or not the position is in shadow
    * @return The color for the target position
    */
-  Color lighting(const std::shared_ptr<Shape> &shape, PointLight light, Tuple position,
+  Color lighting(const Shape &shape, PointLight light, Tuple position,
                  Tuple eyeVector, Tuple normalVector, bool inShadow);
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -11,13 +11,13 @@ namespace raytracerchallenge {
   class Material {
   public:
     Pattern *pattern = nullptr;
-    double ambient = 0.1;
-    double diffuse = 0.9;
-    double specular = 0.9;
-    double shininess = 200.0;
-    double reflective = 0.0;
-    double transparency = 0.0;
-    double refractiveIndex = 1.0;
+    Scalar ambient = 0.1;
+    Scalar diffuse = 0.9;
+    Scalar specular = 0.9;
+    Scalar shininess = 200.0;
+    Scalar reflective = 0.0;
+    Scalar transparency = 0.0;
+    Scalar refractiveIndex = 1.0;
     bool castShadow = true;
     Color color = Color(1.0, 1.0, 1.0);
     bool operator==(const Material &material) const {
@@ -1,8 +1,7 @@
 #pragma once
 
 #include <Eigen/Dense>
-#include <memory>
-#include <mutex>
+#include <atomic>
 #include <optional>
 #include <vector>
 
@@ -23,9 +22,14 @@ namespace raytracerchallenge {
      */
     Matrix();
     /**
-     * @brief Copy constructor from a Matrix
+     * @brief Copy constructor from a Matrix, which also copies its cached
+     * inverse
      */
-    Matrix(Matrix &m);
+    Matrix(const Matrix &m);
+    /**
+     * @brief Destructor, which frees the cached inverse
+     */
+    ~Matrix();
     /**
      * Copy constructor from MatrixXd
      * @param m base MatrixXd
@@ -39,7 +43,8 @@ namespace raytracerchallenge {
      */
     Matrix(unsigned int x, unsigned int y, std::vector<std::vector<double>> m);
     /**
-     * @brief Copy assignment operator
+     * @brief Copy assignment operator, which also copies the cached inverse
+     * of the assigned Matrix
      * @param m object to assign
      * @return assignment
      */
@@ -90,10 +95,13 @@ namespace raytracerchallenge {
      */
     [[nodiscard]] bool invertible() const;
     /**
-     * @brief Return the inverse of this Matrix
+     * @brief Return the inverse of this Matrix. The first call after the
+     * Matrix is constructed or assigned caches the inverse; later calls from
+     * any thread only read it. If m has since been modified in place, the
+     * next call recomputes the inverse and publishes a new cache.
      * @return the inverse of this Matrix
      */
-    [[nodiscard]] Matrix inverse();
+    [[nodiscard]] Matrix inverse() const;
     /**
      * @brief Translate this matrix using the provided x, y, z values
      * @param x value for x
@@ -195,7 +203,19 @@ namespace raytracerchallenge {
     static Matrix view(Tuple from, Tuple to, Tuple up);
 
   private:
-    std::mutex mx;
-    std::shared_ptr<Matrix> inv = nullptr;
+    /**
+     * @brief An inverse and the value of m it was computed from. Once
+     * published a cache is never modified, and it is kept, along with the
+     * caches it replaced, until the Matrix is assigned or destroyed, so that
+     * readers never need to be counted.
+     */
+    struct InverseCache {
+      MatrixXd source;
+      MatrixXd inverse;
+      const InverseCache *previous;
+    };
+    mutable std::atomic<const InverseCache *> inverseCache{nullptr};
+    void copyInverse(const Matrix &matrix);
+    void releaseInverse();
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <raytracerchallenge/base/Matrix.h>
+#include <raytracerchallenge/base/Transform.h>
 #include <raytracerchallenge/base/Tuple.h>
 
 namespace raytracerchallenge {
@@ -17,6 +17,18 @@ namespace raytracerchallenge {
      * @brief Vector representing the ray's direction
      */
     Tuple direction;
+    /**
+     * @brief Reciprocal of each component of the direction, or infinity where
+     * that component is too close to zero to divide by. Computed when the ray
+     * is constructed so that slab tests against boxes multiply rather than
+     * divide.
+     */
+    Tuple inverseDirection;
+    /**
+     * @brief 1 on each axis where the inverse direction is negative, otherwise
+     * 0; indexes the near plane of a box's (min, max) pair on that axis
+     */
+    int sign[3]{};
     /**
      * @brief Construct a ray of light
      * @param origin origin of the ray
@@ -26,12 +38,12 @@ namespace raytracerchallenge {
     /**
      * @brief Return the position at point t along the ray
      */
-    [[nodiscard]] Tuple position(double t) const;
+    [[nodiscard]] Tuple position(Scalar t) const;
     /**
      * @brief Return the transformation of this ray using the provided transformation matrix
      * @param matrix transformation matrix
      * @return a new Ray with the transformation applied
      */
-    [[nodiscard]] Ray transform(const Matrix &matrix) const;
+    [[nodiscard]] Ray transform(const Transform &matrix) const;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
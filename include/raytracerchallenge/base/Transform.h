@@ -0,0 +1,185 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include "Matrix.h"
+#include "Tuple.h"
+
+namespace raytracerchallenge {
+  /**
+   * @brief The most specialised form of a transform, which decides how
+   * cheaply it can be applied, composed and inverted. Each kind includes
+   * those listed before it.
+   */
+  enum class TransformKind {
+    /* Moves points without rotating or scaling them */
+    Translation,
+    /* Scales equally on every axis, then translates */
+    UniformScale,
+    /* Bottom row is (0, 0, 0, 1) */
+    Affine,
+    /* Any other 4x4 matrix */
+    Projective
+  };
+  /**
+   * @brief A 4x4 transformation matrix held in fixed-size, aligned storage, so
+   * that transforms can be copied and multiplied without allocating. Affine
+   * transforms, whose bottom row is (0, 0, 0, 1), are applied as 3x4 matrices,
+   * and translations and uniform scales skip the product altogether. The kind
+   * is decided when a transform is built, so m should not be modified
+   * directly.
+   */
+  template <typename T> class alignas(16) BasicTransform {
+  public:
+    using Matrix4 = Eigen::Matrix<T, 4, 4>;
+    Matrix4 m;
+    /**
+     * @brief Construct an identity transform
+     */
+    BasicTransform();
+    /**
+     * @brief Construct a transform from a 4x4 Matrix
+     * @param matrix a 4x4 Matrix
+     */
+    BasicTransform(const Matrix &matrix);  // NOLINT(google-explicit-constructor)
+    /**
+     * @brief Construct a transform from a fixed-size Eigen matrix
+     * @param m base matrix
+     */
+    explicit BasicTransform(const Matrix4 &m);
+    /**
+     * @brief Transform equality operator
+     * @param transform Transform for comparison
+     * @return True if the elements of both transforms are approximately equal
+     */
+    bool operator==(const BasicTransform &transform) const;
+    /**
+     * @brief Transform inequality operator
+     * @param transform Transform for comparison
+     * @return True if the elements of both transforms are not approximately equal
+     */
+    bool operator!=(const BasicTransform &transform) const;
+    /**
+     * @brief Compose two transforms
+     * @param transform Transform to be applied before this one
+     * @return product of the two transforms
+     */
+    BasicTransform operator*(const BasicTransform &transform) const;
+    /**
+     * @brief Apply this transform to a Tuple
+     * @param tuple Tuple to transform
+     * @return the transformed Tuple
+     */
+    BasicTuple<T> operator*(const BasicTuple<T> &tuple) const;
+    /**
+     * @brief Return true if the bottom row of this transform is (0, 0, 0, 1)
+     * @return true if this transform is affine
+     */
+    [[nodiscard]] bool isAffine() const;
+    /**
+     * @brief Return the most specialised kind of this transform
+     * @return kind of this transform
+     */
+    [[nodiscard]] TransformKind kind() const;
+    /**
+     * @brief Return the transpose of this transform
+     * @return Transpose of this transform
+     */
+    [[nodiscard]] BasicTransform transposed() const;
+    /**
+     * @brief Return the determinant of this transform
+     * @return the determinant
+     */
+    [[nodiscard]] T determinant() const;
+    /**
+     * @brief Return true if the transform is invertible
+     * @return true if the transform is invertible
+     */
+    [[nodiscard]] bool invertible() const;
+    /**
+     * @brief Return the inverse of this transform
+     * @return the inverse of this transform
+     */
+    [[nodiscard]] BasicTransform inverse() const;
+    /**
+     * @brief Translate this transform using the provided x, y, z values
+     * @return translated transform
+     */
+    [[nodiscard]] BasicTransform translated(T x, T y, T z) const;
+    /**
+     * @brief Scale this transform using the provided x, y, z values
+     * @return scaled transform
+     */
+    [[nodiscard]] BasicTransform scaled(T x, T y, T z) const;
+    /**
+     * @brief Rotate this transform for the provided radians on the X axis
+     * @return X-rotated transform
+     */
+    [[nodiscard]] BasicTransform rotatedX(T radians) const;
+    /**
+     * @brief Rotate this transform for the provided radians on the Y axis
+     * @return Y-rotated transform
+     */
+    [[nodiscard]] BasicTransform rotatedY(T radians) const;
+    /**
+     * @brief Rotate this transform for the provided radians on the Z axis
+     * @return Z-rotated transform
+     */
+    [[nodiscard]] BasicTransform rotatedZ(T radians) const;
+    /**
+     * @brief Shear this transform using the provided params
+     * @return sheared transform
+     */
+    [[nodiscard]] BasicTransform sheared(T xy, T xz, T yx, T yz, T zx, T zy) const;
+    /**
+     * @brief Return the identity transform
+     * @return identity transform
+     */
+    static BasicTransform identity();
+    /**
+     * @brief Return a translation transform for the provided x, y, z values
+     * @return translation transform
+     */
+    static BasicTransform translation(T x, T y, T z);
+    /**
+     * @brief Return a scaling transform for the provided x, y, z values
+     * @return scaling transform
+     */
+    static BasicTransform scaling(T x, T y, T z);
+    /**
+     * @brief Return an X-rotation transform for the provided radians
+     * @return X-rotation transform
+     */
+    static BasicTransform rotationX(T radians);
+    /**
+     * @brief Return a Y-rotation transform for the provided radians
+     * @return Y-rotation transform
+     */
+    static BasicTransform rotationY(T radians);
+    /**
+     * @brief Return a Z-rotation transform for the provided radians
+     * @return Z-rotation transform
+     */
+    static BasicTransform rotationZ(T radians);
+    /**
+     * @brief Return a shearing transform for the provided params
+     * @return shearing transform
+     */
+    static BasicTransform shearing(T xy, T xz, T yx, T yz, T zx, T zy);
+    /**
+     * @brief Return the view transform
+     * @param from location of eye
+     * @param to point where eye is looking
+     * @param up vector representing up
+     * @return View transform
+     */
+    static BasicTransform view(BasicTuple<T> from, BasicTuple<T> to, BasicTuple<T> up);
+
+  private:
+    TransformKind transformKind = TransformKind::Translation;
+  };
+  /**
+   * @brief A Transform in the precision the library is built with
+   */
+  using Transform = BasicTransform<Scalar>;
+}  // namespace raytracerchallenge
@@ -1,21 +1,27 @@
 #pragma once
 
+#include <raytracerchallenge/Constants.h>
+
+#include "Lanes4.h"
+
 namespace raytracerchallenge {
   /**
-   * @brief A class representing a tuple (x, y, z, w)
+   * @brief A class representing a tuple (x, y, z, w) of floats or doubles.
+   * Arithmetic is defined inline with SIMD instructions so that it compiles to
+   * straight-line vector code in its callers.
    */
-  class Tuple {
+  template <typename T> class alignas(16) BasicTuple {
   public:
-    double x{};
-    double y{};
-    double z{};
-    double w{};
+    T x{};
+    T y{};
+    T z{};
+    T w{};
     [[nodiscard]] bool isVector() const;
-    [[nodiscard]] double magnitude() const;
+    [[nodiscard]] T magnitude() const;
     /**
      * @brief default constructor for Tuples
      */
-    Tuple();
+    BasicTuple() = default;
     /**
      * @brief create a new Tuple
      * @param x position on the x axis
@@ -23,77 +29,127 @@ namespace raytracerchallenge {
      * @param z position on the z axis
      * @param w 0 for a vector; 1 for a point
      */
-    Tuple(double x, double y, double z, double w);
+    constexpr BasicTuple(T x, T y, T z, T w);
     /**
      * @brief create a point
      * @param x position on the x axis
      * @param y position on the y axis
      * @param z position on the z axis
      */
-    static Tuple point(double x, double y, double z);
+    static constexpr BasicTuple point(T x, T y, T z);
     /**
      * @brief create a vector
      * @param x position on the x axis
      * @param y position on the y axis
      * @param z position on the z axis
      */
-    static Tuple vector(double x, double y, double z);
+    static constexpr BasicTuple vector(T x, T y, T z);
     /**
      * @brief equality operator
      * @param t target for comparison
      * @return true if the tuples have the same x, y and x values
      */
-    bool operator==(const Tuple &t) const;
+    bool operator==(const BasicTuple &t) const;
     /**
      * @brief addition operator
      * @param t target for addition
      * @return sum of the operands
      */
-    Tuple operator+(const Tuple &t) const;
+    BasicTuple operator+(const BasicTuple &t) const;
     /**
      * @brief binary subtraction operator
      * @param t target for subtraction
      * @return difference of the operands
      */
-    Tuple operator-(const Tuple &t) const;
+    BasicTuple operator-(const BasicTuple &t) const;
     /**
      * @brief unary subtraction operator
      * @return inverse of the operand
      */
-    Tuple operator-() const;
+    BasicTuple operator-() const;
     /**
      * @brief scalar multiplication operator
-     * @return a new Tuple multiplied by f
+     * @return a new BasicTuple multiplied by f
      */
-    Tuple operator*(double f) const;
+    BasicTuple operator*(T f) const;
     /**
      * @brief scalar division operator
      * @param f divisor
-     * @return a new Tuple divided by f
+     * @return a new BasicTuple divided by f
      */
-    Tuple operator/(double) const;
+    BasicTuple operator/(T) const;
     /**
      * @brief normalize the Tuple
      * @return normalized Tuple
      */
-    [[nodiscard]] Tuple normalize() const;
+    [[nodiscard]] BasicTuple normalize() const;
     /**
-     * @brief the dot product of this Tuple and another
-     * @param t Tuple to compute dot product with
+     * @brief the dot product of this BasicTuple and another
+     * @param t BasicTuple to compute dot product with
      * @return scalar value representing the dot product of the two tuples
      */
-    [[nodiscard]] double dot(const Tuple &t) const;
+    [[nodiscard]] T dot(const BasicTuple &t) const;
     /**
-     * @brief the cross product of this Tuple and another
-     * @param t Tuple to compute cross product with
-     * @return new Tuple representing the cross product of this tuple and another
+     * @brief the cross product of this BasicTuple and another
+     * @param t BasicTuple to compute cross product with
+     * @return new BasicTuple representing the cross product of this tuple and another
      */
-    [[nodiscard]] Tuple cross(const Tuple &t) const;
+    [[nodiscard]] BasicTuple cross(const BasicTuple &t) const;
     /**
      * @brief return the reflection of this tuple around another
-     * @param t Tuple to reflect this one around
+     * @param t BasicTuple to reflect this one around
      * @return reflected Tuple
      */
-    [[nodiscard]] Tuple reflect(const Tuple &t) const;
+    [[nodiscard]] BasicTuple reflect(const BasicTuple &t) const;
+
+  private:
+    [[nodiscard]] Lanes4<T> lanes() const { return Lanes4<T>::load(&this->x); }
+    static BasicTuple fromLanes(const Lanes4<T> &lanes) {
+      BasicTuple result;
+      lanes.store(&result.x);
+      return result;
+    }
   };
-}  // namespace raytracerchallenge
\ No newline at end of file
+  template <typename T>
+  constexpr BasicTuple<T>::BasicTuple(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+  template <typename T> bool BasicTuple<T>::isVector() const { return this->w == 0; }
+  template <typename T> T BasicTuple<T>::magnitude() const { return std::sqrt(this->dot(*this)); }
+  template <typename T> constexpr BasicTuple<T> BasicTuple<T>::point(T x, T y, T z) {
+    return {x, y, z, T(1)};
+  }
+  template <typename T> constexpr BasicTuple<T> BasicTuple<T>::vector(T x, T y, T z) {
+    return {x, y, z, T(0)};
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::operator+(const BasicTuple &t) const {
+    return fromLanes(this->lanes() + t.lanes());
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::operator-(const BasicTuple &t) const {
+    return fromLanes(this->lanes() - t.lanes());
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::operator-() const {
+    return fromLanes(this->lanes() * Lanes4<T>::broadcast(T(-1)));
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::operator*(T f) const {
+    return fromLanes(this->lanes() * Lanes4<T>::broadcast(f));
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::operator/(T f) const {
+    return fromLanes(this->lanes() / Lanes4<T>::broadcast(f));
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::normalize() const {
+    return fromLanes(this->lanes() * Lanes4<T>::broadcast(reciprocalSqrt(this->dot(*this))));
+  }
+  template <typename T> T BasicTuple<T>::dot(const BasicTuple &t) const {
+    return (this->lanes() * t.lanes()).sum();
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::cross(const BasicTuple &t) const {
+    return vector(this->y * t.z - this->z * t.y, this->z * t.x - this->x * t.z,
+                  this->x * t.y - this->y * t.x);
+  }
+  template <typename T> BasicTuple<T> BasicTuple<T>::reflect(const BasicTuple &t) const {
+    return *this - t * (T(2) * this->dot(t));
+  }
+  /**
+   * @brief A Tuple in the precision the library is built with
+   */
+  using Tuple = BasicTuple<Scalar>;
+}  // namespace raytracerchallenge
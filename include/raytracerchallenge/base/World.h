@@ -4,6 +4,7 @@
 #include <raytracerchallenge/base/Light.h>
 #include <raytracerchallenge/shapes/Shape.h>
 
+#include <cmath>
 #include <optional>
 
 namespace raytracerchallenge {
@@ -32,6 +33,58 @@ namespace raytracerchallenge {
      * and objects in this world
      */
     Intersections intersect(Ray ray);
+    /**
+     * Intersect this world with a ray, appending to a collection which the
+     * caller may reuse across rays
+     * @param ray to pass through the world
+     * @param xs collection to append to, sorted afterwards
+     */
+    void intersect(const Ray &ray, Intersections &xs);
+    /**
+     * @brief Find the nearest intersection between a ray and this world,
+     * skipping any part of the hierarchy beyond the nearest hit found so far
+     * @param ray to pass through the world
+     * @param tMin smallest t to accept
+     * @param tMax intersections at or beyond this t are ignored
+     * @return the nearest intersection, if there is one
+     */
+    std::optional<Intersection> intersectClosest(Ray ray, Scalar tMin = 0.0,
+                                                 Scalar tMax = INFINITY);
+    /**
+     * @brief Find the nearest intersection along each of several rays. Where
+     * the hierarchy is a LinearBVH (BVHOptions::width 2) the rays are traced
+     * through it together, in packets of up to 16 sharing one traversal,
+     * which pays off when the rays are coherent, such as those through
+     * neighbouring pixels. A WideBVH traces them one at a time, as each ray
+     * already tests all of a node's children at once.
+     * @param rays rays to pass through the world
+     * @param count number of rays
+     * @param hits set to the nearest intersection along each ray, if any
+     */
+    void intersectClosest(const Ray *rays, unsigned int count, std::optional<Intersection> *hits);
+    /**
+     * @brief Build the bounding volume hierarchy used to intersect this world.
+     * Objects with finite bounds are placed in the hierarchy and unbounded
+     * objects, such as planes, are tested against every ray. The hierarchy is
+     * rebuilt lazily after objects are added, but this must be called
+     * explicitly if objects are moved after being added, or before the world is
+     * shared between threads. Every object is frozen, composing the world
+     * transforms of shapes nested in groups.
+     * @param options build parameters
+     */
+    void build(const BVHOptions &options);
+    /**
+     * @brief Rebuild the bounding volume hierarchy with the options of the
+     * last build, or the default options if it has not been built
+     */
+    void build();
+    /**
+     * @brief Update the bounding volume hierarchy after objects have moved,
+     * refitting the bounds of every object and of the top-level hierarchy
+     * rather than rebuilding them. A hierarchy is still rebuilt once its SAH
+     * cost grows past BVHOptions::rebuildThreshold.
+     */
+    void refit();
     /**
      * @brief Return the default World
      * @return Default World
@@ -51,6 +104,16 @@ namespace raytracerchallenge {
      * @return Color at the resulting intersection
      */
     Color colorAt(Ray ray, int remaining);
+    /**
+     * @brief Return the color seen along each of several rays. The rays and
+     * the shadow rays from their hits towards the light are traced in
+     * packets; reflected and refracted rays are traced one at a time.
+     * @param rays Rays to intersect with this World
+     * @param count number of rays
+     * @param remaining recursion limit
+     * @param colors set to the color along each ray
+     */
+    void colorAt(const Ray *rays, unsigned int count, int remaining, Color *colors);
     /**
      * Calculate the reflected color for a set of Computations
      * @param computations
@@ -65,11 +128,39 @@ namespace raytracerchallenge {
      * @return refracted Color
      */
     Color refractedColorAt(const Computations &computations, int remaining);
+    /**
+     * @brief Return true if any object which casts shadows lies on the
+     * segment between two points. This stops at the first such object
+     * rather than finding the nearest.
+     * @param point start of the segment
+     * @param target end of the segment
+     * @return true if the segment is blocked
+     */
+    bool occluded(Tuple point, Tuple target);
+    /**
+     * @brief Test the segments from several points to one target for
+     * shadow-casting objects, tracing them in packets as intersectClosest does
+     * @param points starts of the segments
+     * @param count number of points
+     * @param target end of every segment
+     * @param blocked set to true for each segment which is blocked
+     */
+    void occluded(const Tuple *points, unsigned int count, Tuple target, bool *blocked);
     /**
      * Return True if this point is in shadow
      * @param point to check for shadow
      * @return True if this point is in shadow
      */
     bool isShadowed(Tuple point);
+
+  private:
+    void buildIfStale();
+    Color shadeHit(const Computations &computations, int remaining, bool shadowed);
+    Color colorAtHit(const Ray &ray, const Intersection &hit, int remaining);
+    std::shared_ptr<Shape> accelerator;
+    BVHOptions buildOptions;
+    std::vector<std::shared_ptr<Shape>> unbounded;
+    size_t builtCount = 0;
+    bool built = false;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -8,6 +8,18 @@
 #include <unordered_map>
 
 namespace raytracerchallenge {
+  /**
+   * @brief Options controlling the shapes an ObjParser creates
+   */
+  struct ObjParserOptions {
+    /* Collect the faces of each group into TriangleMeshes which share the
+       file's vertices, instead of creating a Triangle for every face */
+    bool triangleMeshes = false;
+    /* Parameters for the hierarchy built inside each TriangleMesh */
+    BVHOptions meshOptions;
+    /* Intersect the triangles or meshes created with the watertight test */
+    bool watertight = false;
+  };
   /**
    * @brief A parser for OBJ files
    */
@@ -21,9 +33,11 @@ namespace raytracerchallenge {
     /**
      * Create an ObjParser from an input stream
      * @param input stream
+     * @param options choice of shapes to create
      * @return ObjParser instance
      */
-    static ObjParser parse(std::stringstream &stream);
+    static ObjParser parse(std::stringstream &stream,
+                           const ObjParserOptions &options = ObjParserOptions());
     /**
      * Get the objects found by this parser
      * @return Objects from the input file parsed by this parser
@@ -1,28 +1,36 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <thread>
 #include <vector>
 
 namespace raytracerchallenge {
+  /**
+   * @brief Number of threads which parallel work is divided between
+   * @return the number of hardware threads, or 8 if that is unknown
+   */
+  inline int parallelThreads() {
+    int nbThreadsHint = (int)std::thread::hardware_concurrency();
+    return nbThreadsHint == 0 ? 8 : nbThreadsHint;
+  }
   /**
    * @brief Execute the provided function in parallel
    * @param nElements Number of elements which will be iterated over
    * @param functor Function <int start, int end> which will process a given chunk of the loop
    */
-  void parallelFor(int nElements, std::function<void(int start, int end)> functor) {
-    int nbThreadsHint = (int)std::thread::hardware_concurrency();
-    int nbThreads = nbThreadsHint == 0 ? 8 : (nbThreadsHint);
+  inline void parallelFor(int nElements, std::function<void(int start, int end)> functor) {
+    int nbThreads = parallelThreads();
     int batchSize = nElements / nbThreads;
     int batchRemainder = nElements % nbThreads;
-    std::vector<std::thread> threads(nbThreads);
-    for (int i = 0; i < nbThreads; ++i) {
-      int start = i * batchSize;
-      threads[i] = std::thread(functor, start, start + batchSize);
+    // The first batchRemainder batches take one more element each, and the calling thread
+    // processes the last batch
+    auto batchStart = [=](int i) { return i * batchSize + std::min(i, batchRemainder); };
+    std::vector<std::thread> threads(nbThreads - 1);
+    for (int i = 0; i < nbThreads - 1; ++i) {
+      threads[i] = std::thread(functor, batchStart(i), batchStart(i + 1));
     }
-    int start = (int)(nbThreads * batchSize);
-    int end = (int)start + batchRemainder;
-    functor(start, end);
+    functor(batchStart(nbThreads - 1), nElements);
     std::for_each(threads.begin(), threads.end(), std::mem_fn(&std::thread::join));
   }
 }  // namespace raytracerchallenge
\ No newline at end of file
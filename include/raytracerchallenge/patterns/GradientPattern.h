@@ -13,6 +13,6 @@ namespace raytracerchallenge {
 
   public:
     GradientPattern(Color a, Color b);
-    [[nodiscard]] Color colorAt(std::shared_ptr<Shape> shape, Tuple point) override;
+    [[nodiscard]] Color colorAt(const Shape &shape, Tuple point) override;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
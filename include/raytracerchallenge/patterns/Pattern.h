@@ -1,5 +1,6 @@
 #pragma once
 
+#include <raytracerchallenge/base/CachedTransform.h>
 #include <raytracerchallenge/shapes/Shape.h>
 
 namespace raytracerchallenge {
@@ -9,13 +10,13 @@ namespace raytracerchallenge {
    */
   class Pattern {
   public:
-    Matrix transform = Matrix::identity(4);
+    CachedTransform transform;
     /**
      * Get the color at this point on this shape
      * @param shape
      * @param point
      * @return Color
      */
-    [[nodiscard]] virtual Color colorAt(std::shared_ptr<Shape> shape, Tuple point) = 0;
+    [[nodiscard]] virtual Color colorAt(const Shape &shape, Tuple point) = 0;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -18,6 +18,8 @@ namespace raytracerchallenge {
       this->right = shape2;
       shape1->parent = this->sharedPtr;
       shape2->parent = this->sharedPtr;
+      shape1->thaw();
+      shape2->thaw();
       this->operation = operation;
     }
     static std::shared_ptr<Shape> create(std::shared_ptr<Shape> &shape1,
@@ -26,11 +28,15 @@ namespace raytracerchallenge {
       return (new CSG(shape1, shape2, operation))->sharedPtr;
     }
     Tuple localNormalAt(Tuple point, class Intersection hit) override;
-    Intersections localIntersect(Ray ray) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
     BoundingBox bounds() override;
     [[nodiscard]] Intersections filterIntersections(const Intersections &intersections) const;
     [[nodiscard]] bool includes(const Shape &object) const override;
     static bool intersectionAllowed(Operation op, bool leftHit, bool inLeft, bool inRight);
     void divide(unsigned int threshold) override;
+    void divide(const BVHOptions &options) override;
+    void freeze() override;
+    void thaw() override;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -8,7 +8,7 @@ namespace raytracerchallenge {
    */
   class Cone : public Cylinder {
   public:
-    static std::shared_ptr<Shape> create(double min = double(-INFINITY), double max = INFINITY,
+    static std::shared_ptr<Shape> create(Scalar min = Scalar(-INFINITY), Scalar max = INFINITY,
                                          bool closed = false) {
       auto shape = new Cone();
       shape->maximum = max;
@@ -17,7 +17,8 @@ namespace raytracerchallenge {
       return shape->sharedPtr;
     }
     Tuple localNormalAt(Tuple point, Intersection hit) override;
-    Intersections localIntersect(Ray ray) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
     BoundingBox bounds() override;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -9,7 +9,7 @@ namespace raytracerchallenge {
   class Cylinder : public Shape {
   public:
     Cylinder() = default;
-    static std::shared_ptr<Shape> create(double min = double(-INFINITY), double max = INFINITY,
+    static std::shared_ptr<Shape> create(Scalar min = Scalar(-INFINITY), Scalar max = INFINITY,
                                          bool closed = false) {
       auto shape = new Cylinder();
       shape->maximum = max;
@@ -18,10 +18,11 @@ namespace raytracerchallenge {
       return shape->sharedPtr;
     }
     Tuple localNormalAt(Tuple point, Intersection hit) override;
-    Intersections localIntersect(Ray ray) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
     BoundingBox bounds() override;
-    double minimum = double(-INFINITY);
-    double maximum = double(INFINITY);
+    Scalar minimum = Scalar(-INFINITY);
+    Scalar maximum = Scalar(INFINITY);
     bool closed = false;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
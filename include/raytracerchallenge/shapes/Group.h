@@ -10,6 +10,9 @@ namespace raytracerchallenge {
   public:
     /* Objects contained in this group */
     std::vector<std::shared_ptr<Shape>> objects;
+    /* Statistics from the last surface area heuristic build of this group;
+       the build time includes dividing its children */
+    BVHBuildStats buildStats;
     /**
      * @brief Factory method
      * @return a pointer to a new Group
@@ -26,14 +29,52 @@ namespace raytracerchallenge {
     void remove(std::shared_ptr<Shape> object);
     BoundingBox bounds() override;
     Tuple localNormalAt(Tuple point, Intersection hit) override;
-    Intersections localIntersect(Ray ray) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray& ray, Intersections& xs) override;
+    bool localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection& closest) override;
+    bool localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) override;
     [[nodiscard]] bool includes(const Shape& object) const override;
     std::vector<std::vector<std::shared_ptr<Shape>>> partitionChildren();
     void makeSubgroup(const std::vector<std::shared_ptr<Shape>>& shapes);
     void divide(unsigned int threshold) override;
+    /**
+     * @brief Replace the children of this group with a bounding volume hierarchy
+     * built with the surface area heuristic. Children with unbounded extent,
+     * such as planes, are left in this group.
+     * @param options build parameters
+     */
+    void divide(const BVHOptions& options) override;
+    /**
+     * @brief Recompute this group's bounds from its children after they have
+     * moved. A hierarchy built by divide(const BVHOptions&) keeps its shape
+     * unless its SAH cost has grown past the rebuild threshold, in which case
+     * it is rebuilt from its primitives.
+     */
+    void refit() override;
+    /**
+     * @brief Estimate the cost of tracing a ray through this group with the
+     * surface area heuristic. Subgroups created by divide(const BVHOptions&)
+     * are counted as nodes; every other child is counted as a primitive.
+     * @param options costs of traversal and intersection
+     * @return estimated cost; lower is better
+     */
+    double sahCost(const BVHOptions& options = BVHOptions());
+    void freeze() override;
+    void thaw() override;
     void setMaterial(std::shared_ptr<Material>& newMaterial) override;
 
   private:
     BoundingBox currentBounds;
+    bool hierarchyNode = false;
+    bool built = false;
+    BVHOptions buildOptions;
+    double builtCost = 0.0;
+    void build(const BVHOptions& options);
+    void collect(std::vector<std::shared_ptr<Shape>>& shapes) const;
+    double nodeCost(double rootArea, const BVHOptions& options);
+    void adopt(const std::shared_ptr<Shape>& object, const BoundingBox& box);
+    std::shared_ptr<Shape> makeNode(const BVHBuildNode& node,
+                                    const std::vector<std::shared_ptr<Shape>>& shapes,
+                                    const std::vector<size_t>& order);
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
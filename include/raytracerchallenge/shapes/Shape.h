@@ -1,11 +1,16 @@
 #pragma once
 
+#include <raytracerchallenge/acceleration/BVHBuilder.h>
 #include <raytracerchallenge/base/BoundingBox.h>
+#include <raytracerchallenge/base/CachedTransform.h>
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/base/Material.h>
-#include <raytracerchallenge/base/Matrix.h>
 #include <raytracerchallenge/base/Ray.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <utility>
 
 namespace raytracerchallenge {
@@ -17,14 +22,12 @@ namespace raytracerchallenge {
     /**
      * @brief Default constructor
      */
-    Shape() {
-      this->transform = Matrix::identity(4);
-      this->sharedPtr = std::shared_ptr<Shape>(this);
-    }
+    Shape() { this->sharedPtr = std::shared_ptr<Shape>(this); }
     /**
-     * @brief Transformation matrix of this object
+     * @brief Transformation matrix of this object. Its inverse and normal
+     * matrix are recomputed whenever it is assigned.
      */
-    Matrix transform;
+    CachedTransform transform;
     /**
      * @brief Material for this object
      */
@@ -41,17 +44,103 @@ namespace raytracerchallenge {
      * the ray passed through this object
      */
     Intersections intersect(Ray ray) {
+      auto xs = Intersections();
+      this->intersect(ray, xs);
+      return xs;
+    }
+    /**
+     * @brief Append all intersections between this object and the provided
+     * ray to a collection, so that tracing through nested shapes fills one
+     * collection instead of building and merging one per shape
+     * @param ray
+     * @param xs collection to append to
+     */
+    void intersect(const Ray &ray, Intersections &xs) {
       Ray transformed = ray.transform(this->transform.inverse());
-      return localIntersect(transformed);
+      this->localIntersect(transformed, xs);
     }
     /**
-     * @brief Implementation-specific logic for returning all intersections
-     * between a shape and a ray. Defaults to Sphere behavior.
+     * @brief Return all intersections between this object and a ray which
+     * is already in object space
      * @param ray
      * @return collection of Intersections representing positions where
      * the ray passed through this object
      */
-    virtual Intersections localIntersect(Ray ray) = 0;
+    Intersections localIntersect(const Ray &ray) {
+      auto xs = Intersections();
+      this->localIntersect(ray, xs);
+      return xs;
+    }
+    /**
+     * @brief Implementation-specific logic for appending all intersections
+     * between a shape and a ray in object space
+     * @param ray
+     * @param xs collection to append to
+     */
+    virtual void localIntersect(const Ray &ray, Intersections &xs) = 0;
+    /**
+     * @brief Find the nearest intersection between this object and the
+     * provided ray with t in [tMin, tMax)
+     * @param ray
+     * @param tMin smallest t to accept
+     * @param tMax intersections at or beyond this t are ignored
+     * @param closest set to the nearest intersection, if one is found
+     * @return true if an intersection was found
+     */
+    bool intersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection &closest) {
+      Ray transformed = ray.transform(this->transform.inverse());
+      return localIntersectClosest(transformed, tMin, tMax, closest);
+    }
+    /**
+     * @brief Implementation-specific logic for finding the nearest intersection.
+     * Defaults to choosing from the intersections returned by localIntersect;
+     * shapes with children override this to skip those beyond the nearest hit.
+     * @param ray
+     * @param tMin smallest t to accept
+     * @param tMax intersections at or beyond this t are ignored
+     * @param closest set to the nearest intersection, if one is found
+     * @return true if an intersection was found
+     */
+    virtual bool localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection &closest) {
+      auto found = false;
+      for (const auto &intersection : this->localIntersect(ray)) {
+        if (intersection.t >= tMin && intersection.t < tMax) {
+          tMax = intersection.t;
+          closest = intersection;
+          found = true;
+        }
+      }
+      return found;
+    }
+    /**
+     * @brief Return true if any part of this object which casts shadows
+     * intersects the provided ray with t in [tMin, tMax)
+     * @param ray
+     * @param tMin smallest t to accept
+     * @param tMax intersections at or beyond this t are ignored
+     * @return true if a shadow-casting intersection was found
+     */
+    bool intersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+      Ray transformed = ray.transform(this->transform.inverse());
+      return localIntersectsAny(transformed, tMin, tMax);
+    }
+    /**
+     * @brief Implementation-specific logic for intersectsAny. Defaults to
+     * searching the intersections returned by localIntersect; primitives
+     * override this to avoid building a list, and shapes with children to
+     * stop at the first child which is hit.
+     * @param ray
+     * @param tMin smallest t to accept
+     * @param tMax intersections at or beyond this t are ignored
+     * @return true if a shadow-casting intersection was found
+     */
+    virtual bool localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+      auto xs = this->localIntersect(ray);
+      return std::any_of(xs.begin(), xs.end(), [tMin, tMax](const Intersection &intersection) {
+        return intersection.t >= tMin && intersection.t < tMax
+               && intersection.object->material->castShadow;
+      });
+    }
     /**
      * @brief Return the normal vector at the specified point on an object
      * @param point
@@ -79,12 +168,25 @@ namespace raytracerchallenge {
      * @return The bounding box of this object
      */
     BoundingBox parentSpaceBounds() { return this->bounds().transform(this->transform); }
+    /**
+     * @brief Return the bounds, in parent space, of the part of this object
+     * inside a box. Defaults to clipping the parent space bounds; shapes with
+     * simple geometry may return something tighter.
+     * @param clip box in parent space
+     * @return bounds of the clipped object, which may be empty
+     */
+    virtual BoundingBox clippedBounds(const BoundingBox &clip) {
+      return this->parentSpaceBounds().clipped(clip);
+    }
     /**
      * Helper for converting from world space to object space
      * @param point Point in world space
      * @return point in object space
      */
-    [[nodiscard]] Tuple worldToObject(Tuple point) {
+    [[nodiscard]] Tuple worldToObject(Tuple point) const {
+      if (this->isCurrent()) {
+        return this->worldInverse * point;
+      }
       Tuple p = point;
       if (this->parent != nullptr) {
         p = this->parent->worldToObject(p);
@@ -97,8 +199,13 @@ namespace raytracerchallenge {
      * @param normal Normal vector in object space
      * @return Normal vector in world space
      */
-    [[nodiscard]] Tuple normalToWorld(Tuple normal) {
-      normal = this->transform.inverse().transposed() * normal;
+    [[nodiscard]] Tuple normalToWorld(Tuple normal) const {
+      if (this->isCurrent()) {
+        normal = this->worldNormal * normal;
+        normal.w = 0.0;
+        return normal.normalize();
+      }
+      normal = this->transform.normalMatrix() * normal;
       normal.w = 0.0;
       normal = normal.normalize();
       if (this->parent != nullptr) {
@@ -135,10 +242,103 @@ namespace raytracerchallenge {
      */
     [[nodiscard]] virtual bool includes(const Shape &object) const { return this->is(object); }
     virtual void divide(unsigned int threshold) { (void)threshold; }
+    /**
+     * @brief Restructure this shape's children into a bounding volume
+     * hierarchy chosen by the surface area heuristic. Shapes without
+     * children ignore this.
+     * @param options build parameters
+     */
+    virtual void divide(const BVHOptions &options) { (void)options; }
+    /**
+     * @brief Recompute any cached bounds after this shape's children have
+     * moved, keeping the structure of the hierarchy where possible. Shapes
+     * without children ignore this.
+     */
+    virtual void refit() {}
+    /**
+     * @brief Compose the transforms between world space and this shape's
+     * object space, and those of its children, so that worldToObject and
+     * normalToWorld take a single multiply rather than walking up through
+     * every parent. Only shapes whose transform, or a parent's, has changed
+     * since they were last frozen are recomposed. Moving anything inside the
+     * hierarchy thaws all of it until its root is frozen again.
+     */
+    virtual void freeze() { this->freezeTransform(); }
+    /**
+     * @brief Discard the composed transforms of this shape and its children,
+     * so that they walk up through their parents again until refrozen
+     */
+    virtual void thaw() { this->frozen = false; }
     virtual void setMaterial(std::shared_ptr<Material> &newMaterial) {
       this->material = newMaterial;
     }
     virtual ~Shape() = default;
     std::shared_ptr<Shape> sharedPtr;
+
+  protected:
+    /**
+     * @brief Compose this shape's world transforms from its parent's, which
+     * is frozen first if it is not current, unless neither has changed since
+     * the last call
+     */
+    void freezeTransform() {
+      if (this->parent != nullptr && !this->parent->isCurrent()) {
+        this->parent->freezeTransform();
+      }
+      auto parentStamp = this->parent != nullptr ? this->parent->frozenStamp : 0;
+      auto changes = this->parent != nullptr ? this->parent->hierarchyChanges
+                                             : this->hierarchyChanges;
+      if (changes == nullptr) {
+        changes = std::make_shared<std::atomic<std::uint64_t>>(0);
+      }
+      if (this->frozen && this->frozenVersion == this->transform.version()
+          && this->frozenParentStamp == parentStamp && this->hierarchyChanges == changes) {
+        // Only another shape in the hierarchy moved, so the composed transforms still hold
+        this->frozenChanges = changes->load(std::memory_order_relaxed);
+        return;
+      }
+      if (this->parent != nullptr) {
+        this->worldInverse = this->transform.inverse() * this->parent->worldInverse;
+        this->worldNormal = this->parent->worldNormal * this->transform.normalMatrix();
+      } else {
+        this->worldInverse = this->transform.inverse();
+        this->worldNormal = this->transform.normalMatrix();
+      }
+      if (this->hierarchyChanges != changes) {
+        this->hierarchyChanges = changes;
+        this->transform.reportChangesTo(changes);
+      }
+      this->frozen = true;
+      this->frozenVersion = this->transform.version();
+      this->frozenChanges = changes->load(std::memory_order_relaxed);
+      this->frozenParentStamp = parentStamp;
+      this->frozenStamp = ++freezeCount;
+    }
+
+  private:
+    static inline std::atomic<std::uint64_t> freezeCount{0};
+    Transform worldInverse;
+    Transform worldNormal;
+    bool frozen = false;
+    /* Version of the transform when this shape was frozen */
+    std::uint64_t frozenVersion = 0;
+    /* Counts changes to every transform in the hierarchy this shape was frozen in */
+    std::shared_ptr<std::atomic<std::uint64_t>> hierarchyChanges;
+    /* Value of hierarchyChanges when this shape was frozen */
+    std::uint64_t frozenChanges = 0;
+    /* Stamp of the parent when this shape was frozen */
+    std::uint64_t frozenParentStamp = 0;
+    /* Changes each time this shape's world transforms are recomposed */
+    std::uint64_t frozenStamp = 0;
+    /**
+     * @brief Return true if the composed transforms are current: this shape
+     * has not been thawed, and no transform in its hierarchy has changed
+     * since they were composed. Thawing a shape thaws its children, so no
+     * parent needs to be visited.
+     */
+    [[nodiscard]] bool isCurrent() const {
+      return this->frozen && this->frozenVersion == this->transform.version()
+             && this->frozenChanges == this->hierarchyChanges->load(std::memory_order_relaxed);
+    }
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
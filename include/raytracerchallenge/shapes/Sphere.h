@@ -15,7 +15,9 @@ namespace raytracerchallenge {
       return shape->sharedPtr;
     }
     Tuple localNormalAt(Tuple point, Intersection hit) override;
-    Intersections localIntersect(Ray ray) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
+    bool localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) override;
     BoundingBox bounds() override;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -3,6 +3,21 @@
 #include <raytracerchallenge/shapes/Shape.h>
 
 namespace raytracerchallenge {
+  /**
+   * @brief A ray prepared for the watertight triangle test: the axes are
+   * permuted so that z is the direction's largest component, and shear
+   * factors map the direction onto (0, 0, 1)
+   */
+  struct WatertightRay {
+    Tuple origin;
+    int kx;
+    int ky;
+    int kz;
+    Scalar sx;
+    Scalar sy;
+    Scalar sz;
+    explicit WatertightRay(const Ray &ray);
+  };
   /**
    * @brief Represents a triangle
    */
@@ -14,6 +29,12 @@ namespace raytracerchallenge {
     Tuple e1;
     Tuple e2;
     Tuple normal;
+    /**
+     * @brief Use the watertight test of Woop, Benthin and Wald, which never
+     * lets a ray slip between triangles that share an edge or vertex, instead
+     * of Möller–Trumbore
+     */
+    bool watertight = false;
     Triangle() = default;
     Triangle(Tuple p1, Tuple p2, Tuple p3) {
       this->p1 = p1;
@@ -27,7 +48,27 @@ namespace raytracerchallenge {
       return (new Triangle(p1, p2, p3))->sharedPtr;
     }
     Tuple localNormalAt(Tuple point, Intersection hit) override;
-    Intersections localIntersect(Ray ray) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
+    bool localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) override;
     BoundingBox bounds() override;
+    BoundingBox clippedBounds(const BoundingBox &clip) override;
+    /**
+     * @brief Intersect a ray with a triangle by shearing and scaling it into
+     * the ray's space, where the edge tests agree exactly along shared edges
+     * @param ray ray prepared for the test
+     * @param p1 first vertex
+     * @param p2 second vertex
+     * @param p3 third vertex
+     * @param t set to the distance along the ray
+     * @param u set to the barycentric weight of p2
+     * @param v set to the barycentric weight of p3
+     * @return true if the ray passes through the triangle or its boundary
+     */
+    static bool intersectWatertight(const WatertightRay &ray, const Tuple &p1, const Tuple &p2,
+                                    const Tuple &p3, Scalar &t, Scalar &u, Scalar &v);
+
+  private:
+    bool intersectTriangle(const Ray &ray, Scalar &t, Scalar &u, Scalar &v) const;
   };
 }  // namespace raytracerchallenge
\ No newline at end of file
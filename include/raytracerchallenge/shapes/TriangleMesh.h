@@ -0,0 +1,145 @@
+#pragma once
+
+#include <raytracerchallenge/acceleration/LinearBVH.h>
+#include <raytracerchallenge/acceleration/TrianglePacket.h>
+#include <raytracerchallenge/shapes/Shape.h>
+#include <raytracerchallenge/shapes/Triangle.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace raytracerchallenge {
+  /**
+   * @brief Points or vectors held as a structure of arrays, one array per
+   * component, so that they can be shared between meshes without the padding
+   * and w component of a Tuple
+   */
+  struct TupleArrays {
+    std::vector<Scalar> x;
+    std::vector<Scalar> y;
+    std::vector<Scalar> z;
+    /**
+     * @brief Append the x, y and z components of a tuple
+     * @param tuple tuple to append
+     */
+    void add(const Tuple &tuple) {
+      this->x.push_back(tuple.x);
+      this->y.push_back(tuple.y);
+      this->z.push_back(tuple.z);
+    }
+    /**
+     * @brief Return the number of tuples held
+     */
+    [[nodiscard]] size_t size() const { return this->x.size(); }
+    /**
+     * @brief Return the tuple at an index as a point
+     */
+    [[nodiscard]] Tuple point(std::uint32_t index) const {
+      return Tuple::point(this->x[index], this->y[index], this->z[index]);
+    }
+    /**
+     * @brief Return the tuple at an index as a vector
+     */
+    [[nodiscard]] Tuple vector(std::uint32_t index) const {
+      return Tuple::vector(this->x[index], this->y[index], this->z[index]);
+    }
+  };
+  /**
+   * @brief A mesh of triangles which index into shared vertex and normal
+   * arrays. Triangles are not shapes of their own: the mesh keeps three
+   * vertex indices per triangle, and three normal indices for smooth meshes,
+   * and intersects them through its own bounding volume hierarchy. The
+   * triangles of each leaf are also packed into groups of four or eight, eight
+   * where the processor supports AVX2, and tested together with SIMD. An
+   * Intersection with a mesh records the index of the triangle hit in
+   * Intersection::primitive.
+   */
+  class TriangleMesh : public Shape {
+  public:
+    /* Vertex positions, which may be shared with other meshes */
+    std::shared_ptr<const TupleArrays> vertices;
+    /* Vertex normals of a smooth mesh, which may be shared; null for a flat mesh */
+    std::shared_ptr<const TupleArrays> normals;
+    /* Three vertex indices per triangle, in the order the leaves of nodes reference them */
+    std::vector<std::uint32_t> indices;
+    /* Three normal indices per triangle for a smooth mesh; empty for a flat mesh */
+    std::vector<std::uint32_t> normalIndices;
+    /* Nodes of the mesh's hierarchy in depth-first order; a leaf references
+       its first packet and the number of triangles it holds */
+    std::vector<LinearBVHNode> nodes;
+    /* Triangles of each leaf packed four at a time, unless packets8 is used */
+    std::vector<TrianglePacket<4>> packets4;
+    /* Triangles of each leaf packed eight at a time, where AVX2 is supported */
+    std::vector<TrianglePacket<8>> packets8;
+    /* Use the watertight triangle test, so that rays through shared edges and
+       vertices cannot slip through the mesh; see Triangle::watertight */
+    bool watertight = false;
+    /**
+     * @brief Build a flat-shaded mesh
+     * @param vertices vertex positions
+     * @param indices three vertex indices per triangle
+     * @param options parameters for building the mesh's hierarchy
+     * @return a pointer to a new TriangleMesh
+     */
+    static std::shared_ptr<Shape> create(std::shared_ptr<const TupleArrays> vertices,
+                                         std::vector<std::uint32_t> indices,
+                                         const BVHOptions &options = BVHOptions());
+    /**
+     * @brief Build a smooth-shaded mesh, whose normals are interpolated
+     * across each triangle from its vertex normals
+     * @param vertices vertex positions
+     * @param indices three vertex indices per triangle
+     * @param normals vertex normals
+     * @param normalIndices three normal indices per triangle
+     * @param options parameters for building the mesh's hierarchy
+     * @return a pointer to a new TriangleMesh
+     */
+    static std::shared_ptr<Shape> create(std::shared_ptr<const TupleArrays> vertices,
+                                         std::vector<std::uint32_t> indices,
+                                         std::shared_ptr<const TupleArrays> normals,
+                                         std::vector<std::uint32_t> normalIndices,
+                                         const BVHOptions &options = BVHOptions());
+    /**
+     * @brief Return the number of triangles in this mesh
+     */
+    [[nodiscard]] size_t triangleCount() const;
+    /**
+     * @brief Return true if this mesh interpolates vertex normals
+     */
+    [[nodiscard]] bool isSmooth() const;
+    /**
+     * @brief Return the number of triangles held by each packet
+     * @return 4 or 8
+     */
+    [[nodiscard]] unsigned int packetWidth() const;
+    Tuple localNormalAt(Tuple point, Intersection hit) override;
+    using Shape::localIntersect;
+    void localIntersect(const Ray &ray, Intersections &xs) override;
+    bool localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection &closest) override;
+    bool localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) override;
+    BoundingBox bounds() override;
+
+  private:
+    BoundingBox meshBounds;
+    unsigned int depth = 0;
+    void build(const BVHOptions &options);
+    std::uint32_t emit(const BVHBuildNode &node, unsigned int width, unsigned int level);
+    template <unsigned int Width>
+    std::uint32_t pack(std::vector<TrianglePacket<Width>> &packets, size_t first, size_t count);
+    template <unsigned int Width, typename Candidate>
+    bool forEachCandidate(const std::vector<TrianglePacket<Width>> &packets, std::uint32_t first,
+                          std::uint32_t count, const PacketRay &ray, float tMin, float tMax,
+                          Candidate candidate) const;
+    template <typename Candidate>
+    bool forEachCandidate(std::uint32_t first, std::uint32_t count, const PacketRay &ray,
+                          float tMin, float tMax, Candidate candidate) const;
+    bool intersectTriangle(std::uint32_t triangle, const Ray &ray,
+                           const std::optional<WatertightRay> &sheared, Scalar &t, Scalar &u,
+                           Scalar &v) const;
+    [[nodiscard]] std::optional<WatertightRay> shear(const Ray &ray) const;
+    template <typename Visit> void traverse(const Ray &ray, Scalar tMin, Scalar &tMax,
+                                            Visit visit) const;
+  };
+}  // namespace raytracerchallenge
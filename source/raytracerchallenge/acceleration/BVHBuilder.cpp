@@ -0,0 +1,538 @@
+#include <raytracerchallenge/acceleration/BVHBuilder.h>
+#include <raytracerchallenge/parallel/Parallel.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <numeric>
+
+namespace raytracerchallenge {
+  double axisValue(const Tuple &tuple, int axis) {
+    switch (axis) {
+      case 0:
+        return tuple.x;
+      case 1:
+        return tuple.y;
+      default:
+        return tuple.z;
+    }
+  }
+  int binFor(double value, double min, double max, unsigned int bins) {
+    auto bin = int(double(bins) * (value - min) / (max - min));
+    return std::clamp(bin, 0, int(bins) - 1);
+  }
+  void forChunks(size_t first, size_t last, bool parallel,
+                 const std::function<void(size_t start, size_t end)> &body) {
+    if (!parallel) {
+      body(first, last);
+      return;
+    }
+    parallelFor(int(last - first), [&body, first](int start, int end) {
+      if (start < end) {
+        body(first + size_t(start), first + size_t(end));
+      }
+    });
+  }
+  void measure(const BVHBuildNode &node, double rootArea, const BVHOptions &options,
+               BVHBuildStats &stats) {
+    auto probability = rootArea > 0.0 ? node.bounds.surfaceArea() / rootArea : 1.0;
+    stats.nodes++;
+    if (node.isLeaf()) {
+      stats.leaves++;
+      stats.sahCost += probability * options.intersectionCost * double(node.count);
+      return;
+    }
+    stats.sahCost += probability * options.traversalCost;
+    measure(*node.left, rootArea, options, stats);
+    measure(*node.right, rootArea, options, stats);
+  }
+  std::uint64_t spreadBits(std::uint64_t value, unsigned int bits) {
+    std::uint64_t result = 0;
+    for (auto i = 0U; i < bits; i++) {
+      result |= ((value >> i) & 1U) << (3 * i);
+    }
+    return result;
+  }
+  void radixSort(std::vector<std::uint64_t> &codes, std::vector<size_t> &indices,
+                 unsigned int bits) {
+    std::vector<std::uint64_t> sortedCodes(codes.size());
+    std::vector<size_t> sortedIndices(indices.size());
+    for (auto shift = 0U; shift < bits; shift += 8) {
+      std::array<size_t, 257> offsets{};
+      for (auto code : codes) {
+        offsets[((code >> shift) & 0xFFU) + 1]++;
+      }
+      std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+      for (size_t i = 0; i < codes.size(); i++) {
+        auto to = offsets[(codes[i] >> shift) & 0xFFU]++;
+        sortedCodes[to] = codes[i];
+        sortedIndices[to] = indices[i];
+      }
+      codes.swap(sortedCodes);
+      indices.swap(sortedIndices);
+    }
+  }
+  void setAxisValue(Tuple &tuple, int axis, double value) {
+    switch (axis) {
+      case 0:
+        tuple.x = value;
+        break;
+      case 1:
+        tuple.y = value;
+        break;
+      default:
+        tuple.z = value;
+    }
+  }
+  /**
+   * @brief The cheapest split of a node found so far
+   */
+  struct Split {
+    double cost = INFINITY;
+    int axis = -1;
+    unsigned int bin = 0;
+    BoundingBox left;
+    BoundingBox right;
+  };
+  /**
+   * @brief Cost every split between a row of bins and record the best in
+   * split. A primitive is counted on the left of a split if it enters before
+   * it, and on the right if it leaves after it; for object splits these are
+   * the same count.
+   */
+  void sweep(const BoundingBox *binBounds, const size_t *entries, const size_t *exits,
+             unsigned int bins, int axis, double nodeArea, const BVHOptions &options,
+             Split &split) {
+    // Sweep from the right so each split plane can be costed in one pass;
+    // empty bins are skipped because adding an empty box would make it infinite
+    std::vector<BoundingBox> rightBoxes(bins);
+    std::vector<size_t> rightCounts(bins);
+    auto rightBox = BoundingBox();
+    size_t rightCount = 0;
+    for (auto bin = bins - 1; bin > 0; bin--) {
+      if (!binBounds[bin].isEmpty()) {
+        rightBox.add(binBounds[bin]);
+      }
+      rightCount += exits[bin];
+      rightBoxes[bin] = rightBox;
+      rightCounts[bin] = rightCount;
+    }
+    auto leftBox = BoundingBox();
+    size_t leftCount = 0;
+    for (auto bin = 1U; bin < bins; bin++) {
+      if (!binBounds[bin - 1].isEmpty()) {
+        leftBox.add(binBounds[bin - 1]);
+      }
+      leftCount += entries[bin - 1];
+      if (leftCount == 0 || rightCounts[bin] == 0) {
+        continue;
+      }
+      auto cost = options.traversalCost
+                  + options.intersectionCost
+                        * (leftBox.surfaceArea() * double(leftCount)
+                           + rightBoxes[bin].surfaceArea() * double(rightCounts[bin]))
+                        / nodeArea;
+      if (cost < split.cost) {
+        split.cost = cost;
+        split.axis = axis;
+        split.bin = bin;
+        split.left = leftBox;
+        split.right = rightBoxes[bin];
+      }
+    }
+  }
+  /**
+   * @brief Primitive counts and bounds for the centroid bins of all three axes
+   */
+  struct BVHBuilder::BinGrid {
+    std::vector<BoundingBox> bounds;
+    std::vector<size_t> counts;
+    explicit BinGrid(unsigned int bins) : bounds(3 * bins), counts(3 * bins, 0) {}
+    void merge(const BinGrid &other) {
+      for (size_t i = 0; i < this->counts.size(); i++) {
+        // Adding an empty box would make the bin infinite
+        if (other.counts[i] > 0) {
+          this->bounds[i].add(other.bounds[i]);
+          this->counts[i] += other.counts[i];
+        }
+      }
+    }
+  };
+  BVHBuilder::BVHBuilder(BVHOptions options) {
+    this->options = options;
+    this->options.maxLeafSize = std::max(this->options.maxLeafSize, 1U);
+    this->options.bins = std::max(this->options.bins, 2U);
+    this->options.parallelThreshold = std::max(this->options.parallelThreshold, size_t(2));
+  }
+  const std::vector<size_t> &BVHBuilder::order() const { return this->indices; }
+  const BVHBuildStats &BVHBuilder::stats() const { return this->buildStats; }
+  std::unique_ptr<BVHBuildNode> BVHBuilder::build(const std::vector<BoundingBox> &bounds,
+                                                  const BVHClipFunction &clip) {
+    auto start = std::chrono::steady_clock::now();
+    this->buildStats = BVHBuildStats();
+    this->primitiveBounds = bounds;
+    this->centroids.resize(bounds.size());
+    forChunks(0, bounds.size(), bounds.size() >= this->options.parallelThreshold,
+              [this](size_t first, size_t last) {
+                for (auto i = first; i < last; i++) {
+                  this->centroids[i] = this->primitiveBounds[i].centroid();
+                }
+              });
+    this->indices.resize(bounds.size());
+    std::iota(this->indices.begin(), this->indices.end(), 0);
+    if (bounds.empty()) {
+      return nullptr;
+    }
+    std::unique_ptr<BVHBuildNode> root;
+    if (this->options.method == BVHMethod::Morton) {
+      root = this->buildMorton();
+    } else if (this->options.spatialSplits) {
+      this->clipper = clip;
+      this->referenceBudget = size_t(double(bounds.size()) * this->options.spatialSplitBudget);
+      this->referenceCount = bounds.size();
+      std::vector<Reference> references;
+      references.reserve(bounds.size());
+      for (size_t i = 0; i < bounds.size(); i++) {
+        references.push_back({i, bounds[i]});
+      }
+      auto rootBox = BoundingBox();
+      for (const auto &box : bounds) {
+        rootBox.add(box);
+      }
+      this->rootArea = rootBox.surfaceArea();
+      this->indices.clear();
+      root = this->buildSpatial(references, 0);
+    } else {
+      this->threads = this->options.buildThreads > 0 ? this->options.buildThreads
+                                                     : unsigned(parallelThreads());
+      root = this->buildRange(0, bounds.size(), this->threads);
+    }
+    measure(*root, root->bounds.surfaceArea(), this->options, this->buildStats);
+    this->buildStats.references = this->indices.size();
+    this->buildStats.buildSeconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return root;
+  }
+  void BVHBuilder::binRange(size_t first, size_t last, const BoundingBox &centroidBounds,
+                            BinGrid &grid) const {
+    auto bins = this->options.bins;
+    for (auto axis = 0; axis < 3; axis++) {
+      auto min = axisValue(centroidBounds.min, axis);
+      auto max = axisValue(centroidBounds.max, axis);
+      if (max <= min) {
+        continue;
+      }
+      for (auto i = first; i < last; i++) {
+        auto index = this->indices[i];
+        auto bin = axis * bins + binFor(axisValue(this->centroids[index], axis), min, max, bins);
+        grid.bounds[bin].add(this->primitiveBounds[index]);
+        grid.counts[bin]++;
+      }
+    }
+  }
+  std::unique_ptr<BVHBuildNode> BVHBuilder::buildRange(size_t first, size_t last,
+                                                       unsigned int tasks) {
+    auto node = std::make_unique<BVHBuildNode>();
+    node->first = first;
+    node->count = last - first;
+    auto large = node->count >= this->options.parallelThreshold;
+    // Binning is spread over every core only while no other subtree is being built
+    auto parallel = large && this->threads > 1 && tasks >= this->threads;
+    auto centroidBounds = BoundingBox();
+    std::mutex mutex;
+    forChunks(first, last, parallel, [&](size_t start, size_t end) {
+      auto box = BoundingBox();
+      auto centroidBox = BoundingBox();
+      for (auto i = start; i < end; i++) {
+        box.add(this->primitiveBounds[this->indices[i]]);
+        centroidBox.add(this->centroids[this->indices[i]]);
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      node->bounds.add(box);
+      centroidBounds.add(centroidBox);
+    });
+    if (node->count == 1) {
+      return node;
+    }
+    auto bins = this->options.bins;
+    auto grid = BinGrid(bins);
+    if (parallel) {
+      // Bounds and counts merge exactly in any order, so the bins match a sequential pass
+      forChunks(first, last, true, [&](size_t start, size_t end) {
+        auto chunk = BinGrid(bins);
+        this->binRange(start, end, centroidBounds, chunk);
+        std::lock_guard<std::mutex> lock(mutex);
+        grid.merge(chunk);
+      });
+    } else {
+      this->binRange(first, last, centroidBounds, grid);
+    }
+    auto leafCost = this->options.intersectionCost * double(node->count);
+    auto best = Split();
+    for (auto axis = 0; axis < 3; axis++) {
+      if (axisValue(centroidBounds.max, axis) <= axisValue(centroidBounds.min, axis)) {
+        continue;
+      }
+      auto first = grid.bounds.data() + axis * bins;
+      auto counts = grid.counts.data() + axis * bins;
+      sweep(first, counts, counts, bins, axis, node->bounds.surfaceArea(), this->options, best);
+    }
+    if (node->count <= this->options.maxLeafSize && (best.axis < 0 || best.cost >= leafCost)) {
+      return node;
+    }
+    auto bestAxis = best.axis;
+    auto bestSplit = best.bin;
+    auto begin = this->indices.begin();
+    auto middle = begin + long(first + node->count / 2);
+    if (bestAxis >= 0) {
+      auto min = axisValue(centroidBounds.min, bestAxis);
+      auto max = axisValue(centroidBounds.max, bestAxis);
+      middle = std::partition(begin + long(first), begin + long(last), [&](size_t index) {
+        return binFor(axisValue(this->centroids[index], bestAxis), min, max, bins)
+               < int(bestSplit);
+      });
+      node->axis = bestAxis;
+    }
+    auto mid = size_t(middle - begin);
+    if (mid == first || mid == last) {
+      mid = first + node->count / 2;
+    }
+    if (large && tasks > 1) {
+      // The subtrees cover disjoint ranges of indices, so they can be built
+      // concurrently, each on its share of the threads left to this one
+      auto leftTasks = tasks / 2;
+      auto left = std::async(std::launch::async, [this, first, mid, leftTasks]() {
+        return this->buildRange(first, mid, leftTasks);
+      });
+      node->right = this->buildRange(mid, last, tasks - leftTasks);
+      node->left = left.get();
+    } else {
+      node->left = this->buildRange(first, mid, tasks);
+      node->right = this->buildRange(mid, last, tasks);
+    }
+    return node;
+  }
+  std::unique_ptr<BVHBuildNode> BVHBuilder::buildMorton() {
+    auto bitsPerAxis = this->options.mortonBits > 30 ? 21U : 10U;
+    auto scale = double((1U << bitsPerAxis) - 1U);
+    auto centroidBounds = BoundingBox();
+    for (const auto &centroid : this->centroids) {
+      centroidBounds.add(centroid);
+    }
+    auto extent = centroidBounds.max - centroidBounds.min;
+    std::vector<std::uint64_t> codes(this->centroids.size());
+    forChunks(0, codes.size(), codes.size() >= this->options.parallelThreshold,
+              [&](size_t first, size_t last) {
+                for (auto i = first; i < last; i++) {
+                  std::uint64_t code = 0;
+                  for (auto axis = 0; axis < 3; axis++) {
+                    auto size = axisValue(extent, axis);
+                    auto offset = axisValue(this->centroids[i], axis)
+                                  - axisValue(centroidBounds.min, axis);
+                    auto cell = size > 0.0 ? std::uint64_t(offset / size * scale) : 0U;
+                    code |= spreadBits(cell, bitsPerAxis) << (2 - axis);
+                  }
+                  codes[i] = code;
+                }
+              });
+    radixSort(codes, this->indices, 3 * bitsPerAxis);
+    return this->emitMorton(codes, 0, codes.size(), int(3 * bitsPerAxis) - 1);
+  }
+  std::unique_ptr<BVHBuildNode> BVHBuilder::emitMorton(const std::vector<std::uint64_t> &codes,
+                                                       size_t first, size_t last, int bit) const {
+    auto node = std::make_unique<BVHBuildNode>();
+    node->first = first;
+    node->count = last - first;
+    if (node->count <= this->options.maxLeafSize) {
+      for (auto i = first; i < last; i++) {
+        node->bounds.add(this->primitiveBounds[this->indices[i]]);
+      }
+      return node;
+    }
+    // The codes are sorted, so the highest bit at which the range differs is
+    // the highest bit at which its first and last codes differ
+    auto differing = codes[first] ^ codes[last - 1];
+    while (bit >= 0 && ((differing >> bit) & 1U) == 0) {
+      bit--;
+    }
+    auto mid = first + node->count / 2;
+    if (bit >= 0) {
+      auto mask = std::uint64_t(1) << bit;
+      auto begin = codes.begin();
+      mid = size_t(std::partition_point(begin + long(first), begin + long(last),
+                                        [mask](std::uint64_t code) { return (code & mask) == 0; })
+                   - begin);
+      node->axis = 2 - bit % 3;
+    }
+    node->left = this->emitMorton(codes, first, mid, bit - 1);
+    node->right = this->emitMorton(codes, mid, last, bit - 1);
+    node->bounds = node->left->bounds;
+    node->bounds.add(node->right->bounds);
+    return node;
+  }
+  BoundingBox BVHBuilder::clip(const Reference &reference, const BoundingBox &box) const {
+    if (this->clipper == nullptr) {
+      return reference.box.clipped(box);
+    }
+    return this->clipper(reference.primitive, box).clipped(box);
+  }
+  std::unique_ptr<BVHBuildNode> BVHBuilder::buildSpatial(std::vector<Reference> &references,
+                                                         unsigned int depth) {
+    auto node = std::make_unique<BVHBuildNode>();
+    node->first = this->indices.size();
+    node->count = references.size();
+    auto centroidBounds = BoundingBox();
+    for (const auto &reference : references) {
+      node->bounds.add(reference.box);
+      centroidBounds.add(reference.box.centroid());
+    }
+    auto makeLeaf = [this, &references, &node]() {
+      for (const auto &reference : references) {
+        this->indices.push_back(reference.primitive);
+      }
+      return std::move(node);
+    };
+    if (node->count == 1) {
+      return makeLeaf();
+    }
+    auto bins = this->options.bins;
+    auto nodeArea = node->bounds.surfaceArea();
+    auto leafCost = this->options.intersectionCost * double(node->count);
+    auto objectSplit = Split();
+    auto grid = BinGrid(bins);
+    for (auto axis = 0; axis < 3; axis++) {
+      auto min = axisValue(centroidBounds.min, axis);
+      auto max = axisValue(centroidBounds.max, axis);
+      if (max <= min) {
+        continue;
+      }
+      for (const auto &reference : references) {
+        auto bin = axis * bins + binFor(axisValue(reference.box.centroid(), axis), min, max, bins);
+        grid.bounds[bin].add(reference.box);
+        grid.counts[bin]++;
+      }
+      auto counts = grid.counts.data() + axis * bins;
+      sweep(grid.bounds.data() + axis * bins, counts, counts, bins, axis, nodeArea,
+            this->options, objectSplit);
+    }
+    // Spatial splits only pay off where the best object split leaves children
+    // which overlap, and are capped by depth and by the reference budget
+    auto overlap = objectSplit.left.clipped(objectSplit.right);
+    auto spatialSplit = Split();
+    if (depth < 64 && this->referenceCount < this->referenceBudget
+        && (objectSplit.axis < 0
+            || (!overlap.isEmpty()
+                && overlap.surfaceArea() > this->options.spatialSplitOverlap * this->rootArea))) {
+      for (auto axis = 0; axis < 3; axis++) {
+        auto min = axisValue(node->bounds.min, axis);
+        auto max = axisValue(node->bounds.max, axis);
+        if (max <= min) {
+          continue;
+        }
+        auto width = (max - min) / double(bins);
+        std::vector<BoundingBox> binBounds(bins);
+        std::vector<size_t> entries(bins, 0);
+        std::vector<size_t> exits(bins, 0);
+        for (const auto &reference : references) {
+          auto firstBin = binFor(axisValue(reference.box.min, axis), min, max, bins);
+          auto lastBin = binFor(axisValue(reference.box.max, axis), min, max, bins);
+          entries[firstBin]++;
+          exits[lastBin]++;
+          if (firstBin == lastBin) {
+            binBounds[firstBin].add(reference.box);
+            continue;
+          }
+          for (auto bin = firstBin; bin <= lastBin; bin++) {
+            auto slab = reference.box;
+            setAxisValue(slab.min, axis, std::max(axisValue(slab.min, axis), min + width * bin));
+            setAxisValue(slab.max, axis,
+                         std::min(axisValue(slab.max, axis), min + width * (bin + 1)));
+            auto part = this->clip(reference, slab);
+            if (!part.isEmpty()) {
+              binBounds[bin].add(part);
+            }
+          }
+        }
+        sweep(binBounds.data(), entries.data(), exits.data(), bins, axis, nodeArea,
+              this->options, spatialSplit);
+      }
+    }
+    auto bestCost = std::min(objectSplit.cost, spatialSplit.cost);
+    if (node->count <= this->options.maxLeafSize
+        && ((objectSplit.axis < 0 && spatialSplit.axis < 0) || bestCost >= leafCost)) {
+      return makeLeaf();
+    }
+    std::vector<Reference> left;
+    std::vector<Reference> right;
+    if (spatialSplit.axis >= 0 && spatialSplit.cost < objectSplit.cost) {
+      auto axis = spatialSplit.axis;
+      auto min = axisValue(node->bounds.min, axis);
+      auto max = axisValue(node->bounds.max, axis);
+      auto position = min + (max - min) / double(bins) * spatialSplit.bin;
+      size_t duplicates = 0;
+      for (const auto &reference : references) {
+        auto firstBin = binFor(axisValue(reference.box.min, axis), min, max, bins);
+        auto lastBin = binFor(axisValue(reference.box.max, axis), min, max, bins);
+        if (lastBin < int(spatialSplit.bin)) {
+          left.push_back(reference);
+        } else if (firstBin >= int(spatialSplit.bin)) {
+          right.push_back(reference);
+        } else {
+          auto leftSlab = reference.box;
+          auto rightSlab = reference.box;
+          setAxisValue(leftSlab.max, axis, position);
+          setAxisValue(rightSlab.min, axis, position);
+          auto leftPart = this->clip(reference, leftSlab);
+          auto rightPart = this->clip(reference, rightSlab);
+          if (!leftPart.isEmpty()) {
+            left.push_back({reference.primitive, leftPart});
+          }
+          if (!rightPart.isEmpty()) {
+            right.push_back({reference.primitive, rightPart});
+          }
+          if (leftPart.isEmpty() && rightPart.isEmpty()) {
+            left.push_back(reference);
+          }
+          duplicates += !leftPart.isEmpty() && !rightPart.isEmpty() ? 1 : 0;
+        }
+      }
+      // Fall back to an object split if the clipped references would exceed
+      // the budget or the split fails to separate them
+      if (left.empty() || right.empty() || left.size() == references.size()
+          || right.size() == references.size()
+          || this->referenceCount + duplicates > this->referenceBudget) {
+        left.clear();
+        right.clear();
+      } else {
+        this->referenceCount += duplicates;
+        node->axis = axis;
+      }
+    }
+    if (left.empty() && right.empty()) {
+      auto middle = references.begin() + long(references.size() / 2);
+      if (objectSplit.axis >= 0) {
+        auto axis = objectSplit.axis;
+        auto min = axisValue(centroidBounds.min, axis);
+        auto max = axisValue(centroidBounds.max, axis);
+        middle = std::partition(references.begin(), references.end(), [&](const Reference &r) {
+          return binFor(axisValue(r.box.centroid(), axis), min, max, bins) < int(objectSplit.bin);
+        });
+        node->axis = axis;
+        if (middle == references.begin() || middle == references.end()) {
+          middle = references.begin() + long(references.size() / 2);
+        }
+      }
+      left.assign(references.begin(), middle);
+      right.assign(middle, references.end());
+    }
+    references.clear();
+    references.shrink_to_fit();
+    node->left = this->buildSpatial(left, depth + 1);
+    node->right = this->buildSpatial(right, depth + 1);
+    node->count = this->indices.size() - node->first;
+    return node;
+  }
+}  // namespace raytracerchallenge
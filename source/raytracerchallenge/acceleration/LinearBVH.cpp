@@ -0,0 +1,634 @@
+#include <raytracerchallenge/Constants.h>
+#include <raytracerchallenge/acceleration/LinearBVH.h>
+#include <raytracerchallenge/shapes/Group.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace raytracerchallenge {
+  bool isFlattenable(const std::shared_ptr<Shape> &shape) {
+    return std::dynamic_pointer_cast<Group>(shape) != nullptr
+           && shape->transform.m == Transform::Matrix4::Identity();
+  }
+  bool containsPrimitives(const std::shared_ptr<Shape> &shape) {
+    if (!isFlattenable(shape)) {
+      return true;
+    }
+    const auto &children = std::dynamic_pointer_cast<Group>(shape)->objects;
+    return std::any_of(children.cbegin(), children.cend(), containsPrimitives);
+  }
+  /**
+   * @brief A node waiting on the stack of a packet traversal, with the lanes
+   * whose rays reached it
+   */
+  struct PacketEntry {
+    std::uint32_t node;
+    unsigned int lanes;
+  };
+  unsigned int firstLane(unsigned int mask) {
+    auto lane = 0U;
+    while ((mask & (1U << lane)) == 0) {
+      lane++;
+    }
+    return lane;
+  }
+  unsigned int laneCount(unsigned int mask) {
+    auto count = 0U;
+    for (; mask != 0; mask &= mask - 1) {
+      count++;
+    }
+    return count;
+  }
+  /**
+   * @brief Return true once so few lanes of a packet reach a node that
+   * tracing them one at a time costs less than testing the whole packet
+   */
+  template <unsigned int Width> bool packetDiverged(unsigned int lanes) {
+    return laneCount(lanes) <= std::max(1U, Width / 4);
+  }
+  /**
+   * @brief The split primitives already intersected along one ray, held in
+   * an open-addressed hash set. Entries only count while they carry the
+   * stamp of the current ray, so starting the next ray clears nothing.
+   */
+  class VisitedPrimitives {
+  public:
+    /**
+     * @brief Forget every primitive, ready for a new ray
+     */
+    void start() {
+      this->stamp++;
+      this->count = 0;
+    }
+    /**
+     * @brief Add a primitive to the set
+     * @param primitive primitive to add
+     * @return false if the primitive was already in the set
+     */
+    bool insert(const Shape *primitive) {
+      if ((this->count + 1) * 2 > this->slots.size()) {
+        this->grow();
+      }
+      auto mask = this->slots.size() - 1;
+      auto index = size_t((std::uint64_t(std::uintptr_t(primitive)) * 0x9E3779B97F4A7C15ULL)
+                          >> this->shift);
+      for (;; index = (index + 1) & mask) {
+        auto &slot = this->slots[index];
+        if (slot.stamp != this->stamp) {
+          slot = {primitive, this->stamp};
+          this->count++;
+          return true;
+        }
+        if (slot.primitive == primitive) {
+          return false;
+        }
+      }
+    }
+
+  private:
+    struct Slot {
+      const Shape *primitive;
+      std::uint64_t stamp;
+    };
+    std::vector<Slot> slots;
+    /* Shift taking a hash to an index, 64 less the log2 of the number of slots */
+    unsigned int shift = 64;
+    std::uint64_t stamp = 0;
+    size_t count = 0;
+    void grow() {
+      auto old = std::move(this->slots);
+      this->slots.assign(std::max(size_t(64), old.size() * 2), Slot{nullptr, 0});
+      this->shift = 64;
+      for (auto size = this->slots.size(); size > 1; size /= 2) {
+        this->shift--;
+      }
+      this->count = 0;
+      for (const auto &slot : old) {
+        if (slot.stamp == this->stamp) {
+          this->insert(slot.primitive);
+        }
+      }
+    }
+  };
+  std::shared_ptr<Shape> LinearBVH::create(const std::shared_ptr<Shape> &root) {
+    auto bvh = new LinearBVH();
+    bvh->root = root;
+    bvh->material = root->material;
+    if (std::dynamic_pointer_cast<Group>(root) != nullptr) {
+      bvh->transform = root->transform;
+    }
+    bvh->build();
+    return bvh->sharedPtr;
+  }
+  std::shared_ptr<Shape> LinearBVH::create(const std::vector<std::shared_ptr<Shape>> &shapes,
+                                           const BVHOptions &options) {
+    auto bvh = new LinearBVH();
+    bvh->options = options;
+    bvh->build(shapes);
+    return bvh->sharedPtr;
+  }
+  void LinearBVH::clear() {
+    this->nodes.clear();
+    this->primitives.clear();
+    this->rootBounds = BoundingBox();
+    this->depth = 0;
+    this->duplicates = false;
+    this->split.clear();
+  }
+  void LinearBVH::build() {
+    this->clear();
+    std::vector<Item> items;
+    if (std::dynamic_pointer_cast<Group>(this->root) != nullptr) {
+      this->rootBounds = this->root->bounds();
+      items = itemsOf(this->root);
+    } else {
+      this->rootBounds = this->root->parentSpaceBounds();
+      items.push_back({this->root, this->rootBounds, false});
+    }
+    if (!items.empty()) {
+      this->flatten(items, 1);
+    }
+    this->builtCost = this->sahCost();
+  }
+  void LinearBVH::build(const std::vector<std::shared_ptr<Shape>> &shapes) {
+    this->clear();
+    std::vector<BoundingBox> bounds;
+    for (const auto &shape : shapes) {
+      bounds.push_back(shape->parentSpaceBounds());
+      this->rootBounds.add(bounds.back());
+    }
+    auto leafOptions = this->options;
+    leafOptions.maxLeafSize
+        = std::min(this->options.maxLeafSize, unsigned(std::numeric_limits<std::uint16_t>::max()));
+    auto builder = BVHBuilder(leafOptions);
+    auto root = builder.build(bounds, [&shapes](size_t primitive, const BoundingBox &box) {
+      return shapes[primitive]->clippedBounds(box);
+    });
+    std::vector<unsigned int> references(shapes.size());
+    for (auto primitive : builder.order()) {
+      references[primitive]++;
+    }
+    if (root != nullptr) {
+      this->emit(*root, shapes, builder.order(), references, 1);
+    }
+    this->duplicates = builder.order().size() > shapes.size();
+    this->builtCost = this->sahCost();
+  }
+  void LinearBVH::refit() {
+    if (this->root != nullptr) {
+      this->root->refit();
+      this->rootBounds = std::dynamic_pointer_cast<Group>(this->root) != nullptr
+                             ? this->root->bounds()
+                             : this->root->parentSpaceBounds();
+    } else {
+      this->rootBounds = BoundingBox();
+      for (const auto &primitive : this->primitives) {
+        primitive->refit();
+        this->rootBounds.add(primitive->parentSpaceBounds());
+      }
+    }
+    // Children are stored after their parents, so a reverse pass visits them first
+    for (auto index = this->nodes.size(); index-- > 0;) {
+      auto &node = this->nodes[index];
+      auto box = BoundingBox();
+      if (node.count > 0) {
+        auto finite = true;
+        for (auto i = node.offset; i < node.offset + node.count; i++) {
+          auto primitiveBox = this->primitives[i]->parentSpaceBounds();
+          finite = finite && primitiveBox.isFinite();
+          box.add(primitiveBox);
+        }
+        if (!finite) {
+          box = BoundingBox(
+              Tuple::point(NEGATIVE_INFINITY, NEGATIVE_INFINITY, NEGATIVE_INFINITY),
+              Tuple::point(INFINITY, INFINITY, INFINITY));
+        }
+      } else {
+        for (auto child : {std::uint32_t(index + 1), node.offset}) {
+          const auto &childNode = this->nodes[child];
+          box.add(Tuple::point(childNode.min[0], childNode.min[1], childNode.min[2]));
+          box.add(Tuple::point(childNode.max[0], childNode.max[1], childNode.max[2]));
+        }
+      }
+      auto packed = packNode(box);
+      std::copy(packed.min, packed.min + 3, node.min);
+      std::copy(packed.max, packed.max + 3, node.max);
+    }
+    auto cost = this->sahCost();
+    if (!std::isfinite(cost) || cost <= this->options.rebuildThreshold * this->builtCost) {
+      return;
+    }
+    auto shapes = this->primitives;
+    if (this->duplicates) {
+      std::sort(shapes.begin(), shapes.end());
+      shapes.erase(std::unique(shapes.begin(), shapes.end()), shapes.end());
+    }
+    if (this->root != nullptr) {
+      this->build();
+    } else {
+      this->build(shapes);
+    }
+  }
+  double LinearBVH::sahCost() const {
+    auto area = [](const LinearBVHNode &node) {
+      auto x = double(node.max[0]) - double(node.min[0]);
+      auto y = double(node.max[1]) - double(node.min[1]);
+      auto z = double(node.max[2]) - double(node.min[2]);
+      return 2.0 * (x * y + y * z + z * x);
+    };
+    if (this->nodes.empty()) {
+      return 0.0;
+    }
+    auto rootArea = area(this->nodes[0]);
+    auto cost = 0.0;
+    for (const auto &node : this->nodes) {
+      auto probability = rootArea > 0.0 ? area(node) / rootArea : 1.0;
+      cost += probability
+              * (node.count > 0 ? this->options.intersectionCost * double(node.count)
+                                : this->options.traversalCost);
+    }
+    return cost;
+  }
+  std::vector<LinearBVH::Item> LinearBVH::itemsOf(const std::shared_ptr<Shape> &group) {
+    std::vector<Item> items;
+    for (const auto &child : std::dynamic_pointer_cast<Group>(group)->objects) {
+      if (containsPrimitives(child)) {
+        items.push_back({child, child->parentSpaceBounds(), isFlattenable(child)});
+      }
+    }
+    return items;
+  }
+  std::uint32_t LinearBVH::flatten(const std::vector<Item> &items, unsigned int level) {
+    if (items.size() == 1 && items[0].expand) {
+      return this->flatten(itemsOf(items[0].shape), level);
+    }
+    this->depth = std::max(this->depth, level);
+    auto box = BoundingBox();
+    auto finite = true;
+    std::vector<Item> primitiveItems;
+    std::vector<Item> groupItems;
+    for (const auto &item : items) {
+      finite = finite && item.box.isFinite();
+      box.add(item.box);
+      (item.expand ? groupItems : primitiveItems).push_back(item);
+    }
+    if (!finite) {
+      box = BoundingBox(Tuple::point(NEGATIVE_INFINITY, NEGATIVE_INFINITY, NEGATIVE_INFINITY),
+                        Tuple::point(INFINITY, INFINITY, INFINITY));
+    }
+    auto index = std::uint32_t(this->nodes.size());
+    auto node = packNode(box);
+    if (groupItems.empty() && items.size() <= std::numeric_limits<std::uint16_t>::max()) {
+      node.offset = std::uint32_t(this->primitives.size());
+      node.count = std::uint16_t(items.size());
+      for (const auto &item : items) {
+        this->primitives.push_back(item.shape);
+      }
+      this->nodes.push_back(node);
+      return index;
+    }
+    this->nodes.push_back(node);
+    std::vector<Item> left;
+    std::vector<Item> right;
+    if (!primitiveItems.empty() && !groupItems.empty()) {
+      left = primitiveItems;
+      right = groupItems;
+    } else {
+      auto middle = items.begin() + long(items.size() / 2);
+      left.assign(items.begin(), middle);
+      right.assign(middle, items.end());
+    }
+    this->flatten(left, level + 1);
+    auto second = this->flatten(right, level + 1);
+    this->nodes[index].offset = second;
+    return index;
+  }
+  std::uint32_t LinearBVH::emit(const BVHBuildNode &node,
+                                const std::vector<std::shared_ptr<Shape>> &shapes,
+                                const std::vector<size_t> &order,
+                                const std::vector<unsigned int> &references, unsigned int level) {
+    this->depth = std::max(this->depth, level);
+    auto index = std::uint32_t(this->nodes.size());
+    auto packed = packNode(node.bounds);
+    packed.axis = std::uint8_t(node.axis);
+    if (node.isLeaf()) {
+      packed.offset = std::uint32_t(this->primitives.size());
+      packed.count = std::uint16_t(node.count);
+      for (auto i = node.first; i < node.first + node.count; i++) {
+        this->primitives.push_back(shapes[order[i]]);
+        this->split.push_back(references[order[i]] > 1);
+      }
+      this->nodes.push_back(packed);
+      return index;
+    }
+    this->nodes.push_back(packed);
+    this->emit(*node.left, shapes, order, references, level + 1);
+    this->nodes[index].offset = this->emit(*node.right, shapes, order, references, level + 1);
+    return index;
+  }
+  void LinearBVH::localIntersect(const Ray &ray, Intersections &xs) {
+    if (this->nodes.empty()) {
+      return;
+    }
+    auto first = xs.size();
+    auto nodeRay = NodeRay(ray);
+    std::uint32_t inlineStack[64];
+    std::vector<std::uint32_t> heapStack;
+    auto stack = inlineStack;
+    if (this->depth > 64) {
+      heapStack.resize(this->depth);
+      stack = heapStack.data();
+    }
+    // A primitive split between leaves is intersected only at the first of them that the ray
+    // reaches. Hierarchies nested inside a primitive use the sets past their parent's.
+    thread_local std::vector<VisitedPrimitives> visitedSets;
+    thread_local size_t nesting = 0;
+    auto level = nesting;
+    if (this->duplicates) {
+      if (visitedSets.size() <= level) {
+        visitedSets.resize(level + 1);
+      }
+      visitedSets[level].start();
+      nesting++;
+    }
+    auto top = 0U;
+    std::uint32_t current = 0;
+    while (true) {
+      const auto &node = this->nodes[current];
+      if (intersectsNode(node, nodeRay, 0.0, INFINITY)) {
+        if (node.count > 0) {
+          for (auto i = node.offset; i < node.offset + node.count; i++) {
+            if (this->duplicates && this->split[i]) {
+              if (!visitedSets[level].insert(this->primitives[i].get())) {
+                continue;
+              }
+            }
+            this->primitives[i]->intersect(ray, xs);
+          }
+        } else if (nodeRay.sign[node.axis] != 0) {
+          stack[top++] = current + 1;
+          current = node.offset;
+          continue;
+        } else {
+          stack[top++] = node.offset;
+          current = current + 1;
+          continue;
+        }
+      }
+      if (top == 0) {
+        break;
+      }
+      current = stack[--top];
+    }
+    nesting = level;
+    xs.sort(first);
+  }
+  bool LinearBVH::localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection &closest) {
+    if (this->nodes.empty()) {
+      return false;
+    }
+    return this->closestFrom(0, ray, tMin, tMax, closest);
+  }
+  bool LinearBVH::closestFrom(std::uint32_t start, const Ray &ray, Scalar tMin, Scalar tMax,
+                              Intersection &closest) {
+    auto nodeRay = NodeRay(ray);
+    std::uint32_t inlineStack[64];
+    std::vector<std::uint32_t> heapStack;
+    auto stack = inlineStack;
+    if (this->depth > 64) {
+      heapStack.resize(this->depth);
+      stack = heapStack.data();
+    }
+    auto found = false;
+    auto top = 0U;
+    std::uint32_t current = start;
+    while (true) {
+      const auto &node = this->nodes[current];
+      if (intersectsNode(node, nodeRay, tMin, tMax)) {
+        if (node.count > 0) {
+          for (auto i = node.offset; i < node.offset + node.count; i++) {
+            if (this->primitives[i]->intersectClosest(ray, tMin, tMax, closest)) {
+              tMax = closest.t;
+              found = true;
+            }
+          }
+        } else if (nodeRay.sign[node.axis] != 0) {
+          stack[top++] = current + 1;
+          current = node.offset;
+          continue;
+        } else {
+          stack[top++] = node.offset;
+          current = current + 1;
+          continue;
+        }
+      }
+      if (top == 0) {
+        break;
+      }
+      current = stack[--top];
+    }
+    return found;
+  }
+  bool LinearBVH::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    if (this->nodes.empty()) {
+      return false;
+    }
+    return this->anyFrom(0, ray, tMin, tMax);
+  }
+  bool LinearBVH::anyFrom(std::uint32_t start, const Ray &ray, Scalar tMin, Scalar tMax) {
+    auto nodeRay = NodeRay(ray);
+    std::uint32_t inlineStack[64];
+    std::vector<std::uint32_t> heapStack;
+    auto stack = inlineStack;
+    if (this->depth > 64) {
+      heapStack.resize(this->depth);
+      stack = heapStack.data();
+    }
+    auto top = 0U;
+    std::uint32_t current = start;
+    while (true) {
+      const auto &node = this->nodes[current];
+      if (intersectsNode(node, nodeRay, tMin, tMax)) {
+        if (node.count > 0) {
+          for (auto i = node.offset; i < node.offset + node.count; i++) {
+            if (this->primitives[i]->intersectsAny(ray, tMin, tMax)) {
+              return true;
+            }
+          }
+        } else {
+          stack[top++] = node.offset;
+          current = current + 1;
+          continue;
+        }
+      }
+      if (top == 0) {
+        break;
+      }
+      current = stack[--top];
+    }
+    return false;
+  }
+  template <unsigned int Width>
+  unsigned int LinearBVH::localIntersectClosest(RayPacket<Width> &packet, const Ray *rays,
+                                                Intersection *closest) {
+    if (this->nodes.empty()) {
+      return 0;
+    }
+    PacketEntry inlineStack[64];
+    std::vector<PacketEntry> heapStack;
+    auto stack = inlineStack;
+    if (this->depth > 64) {
+      heapStack.resize(this->depth);
+      stack = heapStack.data();
+    }
+    auto found = 0U;
+    auto top = 0U;
+    auto current = PacketEntry{0, packet.active};
+    while (true) {
+      const auto &node = this->nodes[current.node];
+      auto lanes = intersectBounds(packet, node.min, node.max, current.lanes);
+      if (lanes != 0 && packetDiverged<Width>(lanes)) {
+        for (; lanes != 0; lanes &= lanes - 1) {
+          auto lane = firstLane(lanes);
+          if (this->closestFrom(current.node, rays[lane], packet.tMin[lane], packet.tMax[lane],
+                                closest[lane])) {
+            packet.tMax[lane] = closest[lane].t;
+            found |= 1U << lane;
+          }
+        }
+      } else if (lanes != 0 && node.count > 0) {
+        for (auto i = node.offset; i < node.offset + node.count; i++) {
+          for (auto remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+            auto lane = firstLane(remaining);
+            if (this->primitives[i]->intersectClosest(rays[lane], packet.tMin[lane],
+                                                      packet.tMax[lane], closest[lane])) {
+              packet.tMax[lane] = closest[lane].t;
+              found |= 1U << lane;
+            }
+          }
+        }
+      } else if (lanes != 0) {
+        // The packet visits children in the order which suits its first ray
+        auto near = std::uint32_t(current.node + 1);
+        auto far = node.offset;
+        if (packet.inverse[node.axis][firstLane(lanes)] < 0) {
+          std::swap(near, far);
+        }
+        stack[top++] = {far, lanes};
+        current = {near, lanes};
+        continue;
+      }
+      if (top == 0) {
+        break;
+      }
+      current = stack[--top];
+    }
+    return found;
+  }
+  template <unsigned int Width>
+  unsigned int LinearBVH::localIntersectsAny(const RayPacket<Width> &packet, const Ray *rays) {
+    if (this->nodes.empty()) {
+      return 0;
+    }
+    PacketEntry inlineStack[64];
+    std::vector<PacketEntry> heapStack;
+    auto stack = inlineStack;
+    if (this->depth > 64) {
+      heapStack.resize(this->depth);
+      stack = heapStack.data();
+    }
+    auto blocked = 0U;
+    auto top = 0U;
+    auto current = PacketEntry{0, packet.active};
+    while (true) {
+      const auto &node = this->nodes[current.node];
+      auto lanes = intersectBounds(packet, node.min, node.max, current.lanes & ~blocked);
+      if (lanes != 0 && packetDiverged<Width>(lanes)) {
+        for (; lanes != 0; lanes &= lanes - 1) {
+          auto lane = firstLane(lanes);
+          if (this->anyFrom(current.node, rays[lane], packet.tMin[lane], packet.tMax[lane])) {
+            blocked |= 1U << lane;
+          }
+        }
+      } else if (lanes != 0 && node.count > 0) {
+        for (auto i = node.offset; i < node.offset + node.count && lanes != 0; i++) {
+          for (auto remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+            auto lane = firstLane(remaining);
+            if (this->primitives[i]->intersectsAny(rays[lane], packet.tMin[lane],
+                                                   packet.tMax[lane])) {
+              blocked |= 1U << lane;
+              lanes &= ~(1U << lane);
+            }
+          }
+        }
+      } else if (lanes != 0) {
+        stack[top++] = {node.offset, lanes};
+        current = {current.node + 1, lanes};
+        continue;
+      }
+      if (top == 0 || blocked == packet.active) {
+        break;
+      }
+      current = stack[--top];
+    }
+    return blocked;
+  }
+  template unsigned int LinearBVH::localIntersectClosest(RayPacket<4> &packet, const Ray *rays,
+                                                         Intersection *closest);
+  template unsigned int LinearBVH::localIntersectClosest(RayPacket<8> &packet, const Ray *rays,
+                                                         Intersection *closest);
+  template unsigned int LinearBVH::localIntersectClosest(RayPacket<16> &packet, const Ray *rays,
+                                                         Intersection *closest);
+  template unsigned int LinearBVH::localIntersectsAny(const RayPacket<4> &packet, const Ray *rays);
+  template unsigned int LinearBVH::localIntersectsAny(const RayPacket<8> &packet, const Ray *rays);
+  template unsigned int LinearBVH::localIntersectsAny(const RayPacket<16> &packet, const Ray *rays);
+  Tuple LinearBVH::localNormalAt(Tuple point, Intersection hit) {
+    (void)point;
+    (void)hit;
+    return {};
+  }
+  BoundingBox LinearBVH::bounds() { return this->rootBounds; }
+  bool LinearBVH::includes(const Shape &object) const {
+    if (this->is(object)) {
+      return true;
+    }
+    if (this->root != nullptr) {
+      return this->root->includes(object);
+    }
+    return std::any_of(this->primitives.cbegin(), this->primitives.cend(),
+                       [&object](const auto &primitive) { return primitive->includes(object); });
+  }
+  void LinearBVH::freeze() {
+    this->freezeTransform();
+    if (this->root != nullptr) {
+      this->root->freeze();
+      return;
+    }
+    for (const auto &primitive : this->primitives) {
+      primitive->freeze();
+    }
+  }
+  void LinearBVH::thaw() {
+    Shape::thaw();
+    if (this->root != nullptr) {
+      this->root->thaw();
+      return;
+    }
+    for (const auto &primitive : this->primitives) {
+      primitive->thaw();
+    }
+  }
+  void LinearBVH::setMaterial(std::shared_ptr<Material> &newMaterial) {
+    this->material = newMaterial;
+    if (this->root != nullptr) {
+      this->root->setMaterial(newMaterial);
+      return;
+    }
+    for (const auto &primitive : this->primitives) {
+      primitive->setMaterial(newMaterial);
+    }
+  }
+}  // namespace raytracerchallenge
@@ -0,0 +1,36 @@
+#include <raytracerchallenge/acceleration/LinearBVHNode.h>
+
+#include <cmath>
+#include <limits>
+
+namespace raytracerchallenge {
+  float roundDown(double value) {
+    auto result = float(value);
+    if (double(result) > value) {
+      result = std::nextafter(result, -std::numeric_limits<float>::infinity());
+    }
+    return result;
+  }
+  float roundUp(double value) {
+    auto result = float(value);
+    if (double(result) < value) {
+      result = std::nextafter(result, std::numeric_limits<float>::infinity());
+    }
+    return result;
+  }
+  LinearBVHNode packNode(const BoundingBox &box) {
+    auto node = LinearBVHNode();
+    node.min[0] = roundDown(box.min.x);
+    node.min[1] = roundDown(box.min.y);
+    node.min[2] = roundDown(box.min.z);
+    node.max[0] = roundUp(box.max.x);
+    node.max[1] = roundUp(box.max.y);
+    node.max[2] = roundUp(box.max.z);
+    node.offset = 0;
+    node.count = 0;
+    node.pad = 0;
+    auto extent = box.max - box.min;
+    node.axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    return node;
+  }
+}  // namespace raytracerchallenge
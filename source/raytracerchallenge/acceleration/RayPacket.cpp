@@ -0,0 +1,112 @@
+#include <raytracerchallenge/acceleration/RayPacket.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  define RAY_PACKET_SSE
+#  include <emmintrin.h>
+#endif
+
+namespace raytracerchallenge {
+  template <unsigned int Width>
+  unsigned int intersectBoundsScalar(const RayPacket<Width> &packet, const float *min,
+                                     const float *max, unsigned int mask) {
+    auto result = 0U;
+    for (auto lane = 0U; lane < Width; lane++) {
+      if ((mask & (1U << lane)) == 0) {
+        continue;
+      }
+      auto tMin = packet.tMin[lane];
+      auto tMax = packet.tMax[lane];
+      for (auto axis = 0; axis < 3; axis++) {
+        auto inverse = packet.inverse[axis][lane];
+        auto nearPlane = Scalar(inverse < 0 ? max[axis] : min[axis]);
+        auto farPlane = Scalar(inverse < 0 ? min[axis] : max[axis]);
+        auto t0 = (nearPlane - packet.origin[axis][lane]) * inverse;
+        auto t1 = (farPlane - packet.origin[axis][lane]) * inverse;
+        // Written so that a NaN, from a ray starting on a plane it runs along, is ignored
+        tMin = t0 > tMin ? t0 : tMin;
+        tMax = t1 < tMax ? t1 : tMax;
+      }
+      if (tMin <= tMax) {
+        result |= 1U << lane;
+      }
+    }
+    return result;
+  }
+#ifdef RAY_PACKET_SSE
+  /* Two doubles a step; max and min return their second operand for a NaN, as the scalar test */
+  template <unsigned int Width>
+  unsigned int intersectBoundsSse(const RayPacket<Width> &packet, const double *min,
+                                  const double *max, unsigned int mask) {
+    auto result = 0U;
+    auto zero = _mm_setzero_pd();
+    for (auto lane = 0U; lane < Width; lane += 2) {
+      if ((mask & (3U << lane)) == 0) {
+        continue;
+      }
+      auto tMin = _mm_load_pd(packet.tMin + lane);
+      auto tMax = _mm_load_pd(packet.tMax + lane);
+      for (auto axis = 0; axis < 3; axis++) {
+        auto origin = _mm_load_pd(packet.origin[axis] + lane);
+        auto inverse = _mm_load_pd(packet.inverse[axis] + lane);
+        auto negative = _mm_cmplt_pd(inverse, zero);
+        auto low = _mm_set1_pd(min[axis]);
+        auto high = _mm_set1_pd(max[axis]);
+        auto nearPlane = _mm_or_pd(_mm_and_pd(negative, high), _mm_andnot_pd(negative, low));
+        auto farPlane = _mm_or_pd(_mm_and_pd(negative, low), _mm_andnot_pd(negative, high));
+        auto t0 = _mm_mul_pd(_mm_sub_pd(nearPlane, origin), inverse);
+        auto t1 = _mm_mul_pd(_mm_sub_pd(farPlane, origin), inverse);
+        tMin = _mm_max_pd(t0, tMin);
+        tMax = _mm_min_pd(t1, tMax);
+      }
+      result |= unsigned(_mm_movemask_pd(_mm_cmple_pd(tMin, tMax))) << lane;
+    }
+    return result & mask;
+  }
+  /* Four floats a step, for single-precision builds */
+  template <unsigned int Width>
+  unsigned int intersectBoundsSse(const RayPacket<Width> &packet, const float *min,
+                                  const float *max, unsigned int mask) {
+    auto result = 0U;
+    auto zero = _mm_setzero_ps();
+    for (auto lane = 0U; lane < Width; lane += 4) {
+      if ((mask & (15U << lane)) == 0) {
+        continue;
+      }
+      auto tMin = _mm_load_ps(packet.tMin + lane);
+      auto tMax = _mm_load_ps(packet.tMax + lane);
+      for (auto axis = 0; axis < 3; axis++) {
+        auto origin = _mm_load_ps(packet.origin[axis] + lane);
+        auto inverse = _mm_load_ps(packet.inverse[axis] + lane);
+        auto negative = _mm_cmplt_ps(inverse, zero);
+        auto low = _mm_set1_ps(min[axis]);
+        auto high = _mm_set1_ps(max[axis]);
+        auto nearPlane = _mm_or_ps(_mm_and_ps(negative, high), _mm_andnot_ps(negative, low));
+        auto farPlane = _mm_or_ps(_mm_and_ps(negative, low), _mm_andnot_ps(negative, high));
+        auto t0 = _mm_mul_ps(_mm_sub_ps(nearPlane, origin), inverse);
+        auto t1 = _mm_mul_ps(_mm_sub_ps(farPlane, origin), inverse);
+        tMin = _mm_max_ps(t0, tMin);
+        tMax = _mm_min_ps(t1, tMax);
+      }
+      result |= unsigned(_mm_movemask_ps(_mm_cmple_ps(tMin, tMax))) << lane;
+    }
+    return result & mask;
+  }
+#endif
+  template <unsigned int Width>
+  unsigned int intersectBounds(const RayPacket<Width> &packet, const float *min, const float *max,
+                               unsigned int mask) {
+#ifdef RAY_PACKET_SSE
+    const Scalar low[3] = {Scalar(min[0]), Scalar(min[1]), Scalar(min[2])};
+    const Scalar high[3] = {Scalar(max[0]), Scalar(max[1]), Scalar(max[2])};
+    return intersectBoundsSse(packet, low, high, mask);
+#else
+    return intersectBoundsScalar(packet, min, max, mask);
+#endif
+  }
+  template unsigned int intersectBounds(const RayPacket<4> &packet, const float *min,
+                                        const float *max, unsigned int mask);
+  template unsigned int intersectBounds(const RayPacket<8> &packet, const float *min,
+                                        const float *max, unsigned int mask);
+  template unsigned int intersectBounds(const RayPacket<16> &packet, const float *min,
+                                        const float *max, unsigned int mask);
+}  // namespace raytracerchallenge
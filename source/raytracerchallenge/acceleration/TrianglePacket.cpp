@@ -0,0 +1,220 @@
+#include <raytracerchallenge/acceleration/TrianglePacket.h>
+#include <raytracerchallenge/acceleration/WideBVH.h>
+
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  define TRIANGLE_PACKET_SSE
+#  include <immintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define TRIANGLE_PACKET_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#  define TRIANGLE_PACKET_AVX2
+#endif
+
+namespace raytracerchallenge {
+  /**
+   * Bound on the rounding error of the float test, relative to the largest
+   * magnitudes of its inputs. Each of the products compared below multiplies
+   * at most three coordinates of the origin offset, direction and edges, and
+   * rounding those inputs to floats and then combining them loses at most
+   * about 60 units of float rounding of the product of their scales; this
+   * allows twice that.
+   */
+  constexpr float PACKET_ERROR = 128.0F * (FLT_EPSILON / 2.0F);
+  /**
+   * @brief Tests a ray against every lane of a packet, returning a mask of
+   * the lanes which may be hit
+   */
+  template <unsigned int Width> using PacketTest
+      = unsigned int (*)(const TrianglePacket<Width> &packet, const PacketRay &ray, float tMin,
+                         float tMax);
+  template <unsigned int Width>
+  unsigned int intersectPacketScalar(const TrianglePacket<Width> &packet, const PacketRay &ray,
+                                     float tMin, float tMax) {
+    const auto *o = ray.origin;
+    const auto *d = ray.direction;
+    auto directionError = PACKET_ERROR * ray.directionScale;
+    auto mask = 0U;
+    for (auto lane = 0U; lane < Width; lane++) {
+      auto px = d[1] * packet.e2Z[lane] - d[2] * packet.e2Y[lane];
+      auto py = d[2] * packet.e2X[lane] - d[0] * packet.e2Z[lane];
+      auto pz = d[0] * packet.e2Y[lane] - d[1] * packet.e2X[lane];
+      auto det = packet.e1X[lane] * px + packet.e1Y[lane] * py + packet.e1Z[lane] * pz;
+      auto sx = o[0] - packet.p1X[lane];
+      auto sy = o[1] - packet.p1Y[lane];
+      auto sz = o[2] - packet.p1Z[lane];
+      auto qx = sy * packet.e1Z[lane] - sz * packet.e1Y[lane];
+      auto qy = sz * packet.e1X[lane] - sx * packet.e1Z[lane];
+      auto qz = sx * packet.e1Y[lane] - sy * packet.e1X[lane];
+      // Barycentric coordinates and distance, each scaled by |det|
+      auto sign = det < 0.0F ? -1.0F : 1.0F;
+      auto u = sign * (sx * px + sy * py + sz * pz);
+      auto v = sign * (d[0] * qx + d[1] * qy + d[2] * qz);
+      auto t = sign * (packet.e2X[lane] * qx + packet.e2Y[lane] * qy + packet.e2Z[lane] * qz);
+      auto absDet = std::abs(det);
+      auto scale = ray.originScale + packet.p1Scale[lane];
+      auto edges = packet.e1Scale[lane] * packet.e2Scale[lane];
+      auto errorU = directionError * packet.e2Scale[lane] * scale;
+      auto errorV = directionError * packet.e1Scale[lane] * scale;
+      auto errorDet = directionError * edges;
+      auto errorT = PACKET_ERROR * edges * scale;
+      t /= absDet;
+      auto slack = (errorT + std::abs(t) * errorDet) / (absDet - errorDet);
+      // A ray so nearly parallel that the sign of det is in doubt is always reported.
+      // Every comparison fails for the NaNs held by unused lanes.
+      if (absDet <= errorDet
+          || (u >= -errorU && v >= -errorV && u + v <= absDet + errorU + errorV + errorDet
+              && t + slack >= tMin && t - slack <= tMax)) {
+        mask |= 1U << lane;
+      }
+    }
+    return mask;
+  }
+#ifdef TRIANGLE_PACKET_SSE
+  unsigned int intersectPacketSse(const TrianglePacket<4> &packet, const PacketRay &ray,
+                                  float tMin, float tMax) {
+    auto dx = _mm_set1_ps(ray.direction[0]);
+    auto dy = _mm_set1_ps(ray.direction[1]);
+    auto dz = _mm_set1_ps(ray.direction[2]);
+    auto e1x = _mm_load_ps(packet.e1X);
+    auto e1y = _mm_load_ps(packet.e1Y);
+    auto e1z = _mm_load_ps(packet.e1Z);
+    auto e2x = _mm_load_ps(packet.e2X);
+    auto e2y = _mm_load_ps(packet.e2Y);
+    auto e2z = _mm_load_ps(packet.e2Z);
+    auto px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    auto py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    auto pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    auto det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)),
+                          _mm_mul_ps(e1z, pz));
+    auto sx = _mm_sub_ps(_mm_set1_ps(ray.origin[0]), _mm_load_ps(packet.p1X));
+    auto sy = _mm_sub_ps(_mm_set1_ps(ray.origin[1]), _mm_load_ps(packet.p1Y));
+    auto sz = _mm_sub_ps(_mm_set1_ps(ray.origin[2]), _mm_load_ps(packet.p1Z));
+    auto qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    auto qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    auto qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    // Barycentric coordinates and distance, each scaled by |det|
+    auto signBit = _mm_set1_ps(-0.0F);
+    auto sign = _mm_and_ps(det, signBit);
+    auto absDet = _mm_andnot_ps(signBit, det);
+    auto u = _mm_xor_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)),
+        sign);
+    auto v = _mm_xor_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)),
+        sign);
+    auto t = _mm_xor_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)),
+        sign);
+    auto directionError = _mm_set1_ps(PACKET_ERROR * ray.directionScale);
+    auto scale = _mm_add_ps(_mm_set1_ps(ray.originScale), _mm_load_ps(packet.p1Scale));
+    auto e1Scale = _mm_load_ps(packet.e1Scale);
+    auto e2Scale = _mm_load_ps(packet.e2Scale);
+    auto edges = _mm_mul_ps(e1Scale, e2Scale);
+    auto errorU = _mm_mul_ps(_mm_mul_ps(directionError, e2Scale), scale);
+    auto errorV = _mm_mul_ps(_mm_mul_ps(directionError, e1Scale), scale);
+    auto errorDet = _mm_mul_ps(directionError, edges);
+    auto errorT = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(PACKET_ERROR), edges), scale);
+    t = _mm_div_ps(t, absDet);
+    auto slack = _mm_div_ps(_mm_add_ps(errorT, _mm_mul_ps(_mm_andnot_ps(signBit, t), errorDet)),
+                            _mm_sub_ps(absDet, errorDet));
+    // Ordered comparisons fail for the NaNs held by unused lanes
+    auto hit = _mm_cmpge_ps(u, _mm_xor_ps(errorU, signBit));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(v, _mm_xor_ps(errorV, signBit)));
+    auto limit = _mm_add_ps(_mm_add_ps(absDet, errorU), _mm_add_ps(errorV, errorDet));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), limit));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(_mm_add_ps(t, slack), _mm_set1_ps(tMin)));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_sub_ps(t, slack), _mm_set1_ps(tMax)));
+    // A ray so nearly parallel that the sign of det is in doubt is always reported
+    hit = _mm_or_ps(hit, _mm_cmple_ps(absDet, errorDet));
+    return unsigned(_mm_movemask_ps(hit));
+  }
+#endif
+#ifdef TRIANGLE_PACKET_AVX2
+  TRIANGLE_PACKET_AVX2 unsigned int intersectPacketAvx2(const TrianglePacket<8> &packet,
+                                                        const PacketRay &ray, float tMin,
+                                                        float tMax) {
+    auto dx = _mm256_set1_ps(ray.direction[0]);
+    auto dy = _mm256_set1_ps(ray.direction[1]);
+    auto dz = _mm256_set1_ps(ray.direction[2]);
+    auto e1x = _mm256_load_ps(packet.e1X);
+    auto e1y = _mm256_load_ps(packet.e1Y);
+    auto e1z = _mm256_load_ps(packet.e1Z);
+    auto e2x = _mm256_load_ps(packet.e2X);
+    auto e2y = _mm256_load_ps(packet.e2Y);
+    auto e2z = _mm256_load_ps(packet.e2Z);
+    auto px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+    auto py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+    auto pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+    auto det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)),
+                             _mm256_mul_ps(e1z, pz));
+    auto sx = _mm256_sub_ps(_mm256_set1_ps(ray.origin[0]), _mm256_load_ps(packet.p1X));
+    auto sy = _mm256_sub_ps(_mm256_set1_ps(ray.origin[1]), _mm256_load_ps(packet.p1Y));
+    auto sz = _mm256_sub_ps(_mm256_set1_ps(ray.origin[2]), _mm256_load_ps(packet.p1Z));
+    auto qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+    auto qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+    auto qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+    auto signBit = _mm256_set1_ps(-0.0F);
+    auto sign = _mm256_and_ps(det, signBit);
+    auto absDet = _mm256_andnot_ps(signBit, det);
+    auto u = _mm256_xor_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px),
+                                                       _mm256_mul_ps(sy, py)),
+                                         _mm256_mul_ps(sz, pz)),
+                           sign);
+    auto v = _mm256_xor_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx),
+                                                       _mm256_mul_ps(dy, qy)),
+                                         _mm256_mul_ps(dz, qz)),
+                           sign);
+    auto t = _mm256_xor_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx),
+                                                       _mm256_mul_ps(e2y, qy)),
+                                         _mm256_mul_ps(e2z, qz)),
+                           sign);
+    auto directionError = _mm256_set1_ps(PACKET_ERROR * ray.directionScale);
+    auto scale = _mm256_add_ps(_mm256_set1_ps(ray.originScale), _mm256_load_ps(packet.p1Scale));
+    auto e1Scale = _mm256_load_ps(packet.e1Scale);
+    auto e2Scale = _mm256_load_ps(packet.e2Scale);
+    auto edges = _mm256_mul_ps(e1Scale, e2Scale);
+    auto errorU = _mm256_mul_ps(_mm256_mul_ps(directionError, e2Scale), scale);
+    auto errorV = _mm256_mul_ps(_mm256_mul_ps(directionError, e1Scale), scale);
+    auto errorDet = _mm256_mul_ps(directionError, edges);
+    auto errorT = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(PACKET_ERROR), edges), scale);
+    t = _mm256_div_ps(t, absDet);
+    auto slack = _mm256_div_ps(
+        _mm256_add_ps(errorT, _mm256_mul_ps(_mm256_andnot_ps(signBit, t), errorDet)),
+        _mm256_sub_ps(absDet, errorDet));
+    auto hit = _mm256_cmp_ps(u, _mm256_xor_ps(errorU, signBit), _CMP_GE_OQ);
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, _mm256_xor_ps(errorV, signBit), _CMP_GE_OQ));
+    auto limit
+        = _mm256_add_ps(_mm256_add_ps(absDet, errorU), _mm256_add_ps(errorV, errorDet));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), limit, _CMP_LE_OQ));
+    hit = _mm256_and_ps(
+        hit, _mm256_cmp_ps(_mm256_add_ps(t, slack), _mm256_set1_ps(tMin), _CMP_GE_OQ));
+    hit = _mm256_and_ps(
+        hit, _mm256_cmp_ps(_mm256_sub_ps(t, slack), _mm256_set1_ps(tMax), _CMP_LE_OQ));
+    hit = _mm256_or_ps(hit, _mm256_cmp_ps(absDet, errorDet, _CMP_LE_OQ));
+    return unsigned(_mm256_movemask_ps(hit));
+  }
+#endif
+  unsigned int intersectPacket(const TrianglePacket<4> &packet, const PacketRay &ray, float tMin,
+                               float tMax) {
+#ifdef TRIANGLE_PACKET_SSE
+    return intersectPacketSse(packet, ray, tMin, tMax);
+#else
+    return intersectPacketScalar(packet, ray, tMin, tMax);
+#endif
+  }
+  unsigned int intersectPacket(const TrianglePacket<8> &packet, const PacketRay &ray, float tMin,
+                               float tMax) {
+#ifdef TRIANGLE_PACKET_AVX2
+    // Chosen at runtime, so that one build runs on processors with and without AVX2
+    static const PacketTest<8> test
+        = WideBVH::supportsWidth(8) ? intersectPacketAvx2 : intersectPacketScalar<8>;
+    return test(packet, ray, tMin, tMax);
+#else
+    return intersectPacketScalar(packet, ray, tMin, tMax);
+#endif
+  }
+}  // namespace raytracerchallenge
@@ -0,0 +1,475 @@
+#include <raytracerchallenge/Constants.h>
+#include <raytracerchallenge/acceleration/LinearBVHNode.h>
+#include <raytracerchallenge/acceleration/WideBVH.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  define WIDE_BVH_SSE
+#  include <immintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define WIDE_BVH_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#  define WIDE_BVH_AVX2
+#endif
+
+namespace raytracerchallenge {
+  /* Widens the far distance of each slab test to absorb float rounding error */
+  constexpr float WIDE_BVH_FAR_SCALE = 1.0F + 4.0F * std::numeric_limits<float>::epsilon();
+  /**
+   * @brief Round a bound down to a float, leaving one extra ulp of padding
+   * for the rounding of the ray origin
+   */
+  float lowerFloat(double value) {
+    auto result = roundDown(value);
+    if (!std::isfinite(result)) {
+      return result;
+    }
+    return std::nextafter(result, -std::numeric_limits<float>::infinity());
+  }
+  /**
+   * @brief Round a bound up to a float, leaving one extra ulp of padding
+   */
+  float upperFloat(double value) {
+    auto result = roundUp(value);
+    if (!std::isfinite(result)) {
+      return result;
+    }
+    return std::nextafter(result, std::numeric_limits<float>::infinity());
+  }
+  template <unsigned int Width>
+  void setLane(WideBVHNode<Width> &node, unsigned int lane, const BoundingBox &box) {
+    node.minX[lane] = lowerFloat(box.min.x);
+    node.minY[lane] = lowerFloat(box.min.y);
+    node.minZ[lane] = lowerFloat(box.min.z);
+    node.maxX[lane] = upperFloat(box.max.x);
+    node.maxY[lane] = upperFloat(box.max.y);
+    node.maxZ[lane] = upperFloat(box.max.z);
+  }
+  template <unsigned int Width>
+  BoundingBox laneBounds(const WideBVHNode<Width> &node, unsigned int lane) {
+    return {Tuple::point(node.minX[lane], node.minY[lane], node.minZ[lane]),
+            Tuple::point(node.maxX[lane], node.maxY[lane], node.maxZ[lane])};
+  }
+  /**
+   * @brief A ray prepared for testing against the children of wide nodes
+   */
+  struct WideRay {
+    float origin[3];
+    float inverse[3];
+    bool negative[3];
+    explicit WideRay(const Ray &ray)
+        : origin{float(ray.origin.x), float(ray.origin.y), float(ray.origin.z)},
+          inverse{float(ray.inverseDirection.x), float(ray.inverseDirection.y),
+                  float(ray.inverseDirection.z)},
+          negative{ray.sign[0] != 0, ray.sign[1] != 0, ray.sign[2] != 0} {}
+  };
+  /**
+   * @brief Tests a ray against every child of a node, writing the distance
+   * at which the ray enters each child to entry and returning a mask of the
+   * children which it hits
+   */
+  template <unsigned int Width> using LaneTest
+      = unsigned int (*)(const WideBVHNode<Width> &node, const WideRay &ray, float tMin, float tMax,
+                         float *entry);
+  template <unsigned int Width>
+  unsigned int hitLanesScalar(const WideBVHNode<Width> &node, const WideRay &ray, float tMin,
+                              float tMax, float *entry) {
+    const float *mins[3] = {node.minX, node.minY, node.minZ};
+    const float *maxs[3] = {node.maxX, node.maxY, node.maxZ};
+    auto mask = 0U;
+    for (auto lane = 0U; lane < Width; lane++) {
+      auto tNear = tMin;
+      auto tFar = tMax;
+      for (auto axis = 0; axis < 3; axis++) {
+        const auto *nearPlanes = ray.negative[axis] ? maxs[axis] : mins[axis];
+        const auto *farPlanes = ray.negative[axis] ? mins[axis] : maxs[axis];
+        auto t0 = (nearPlanes[lane] - ray.origin[axis]) * ray.inverse[axis];
+        auto t1 = (farPlanes[lane] - ray.origin[axis]) * ray.inverse[axis];
+        // Written so that a NaN, from a ray starting on a plane it runs along, is ignored
+        tNear = t0 > tNear ? t0 : tNear;
+        tFar = t1 < tFar ? t1 : tFar;
+      }
+      entry[lane] = tNear;
+      if (tNear <= tFar * WIDE_BVH_FAR_SCALE) {
+        mask |= 1U << lane;
+      }
+    }
+    return mask;
+  }
+#ifdef WIDE_BVH_SSE
+  unsigned int hitLanesSse(const WideBVHNode<4> &node, const WideRay &ray, float tMin, float tMax,
+                           float *entry) {
+    const float *mins[3] = {node.minX, node.minY, node.minZ};
+    const float *maxs[3] = {node.maxX, node.maxY, node.maxZ};
+    auto tNear = _mm_set1_ps(tMin);
+    auto tFar = _mm_set1_ps(tMax);
+    for (auto axis = 0; axis < 3; axis++) {
+      auto origin = _mm_set1_ps(ray.origin[axis]);
+      auto inverse = _mm_set1_ps(ray.inverse[axis]);
+      auto nearPlanes = _mm_load_ps(ray.negative[axis] ? maxs[axis] : mins[axis]);
+      auto farPlanes = _mm_load_ps(ray.negative[axis] ? mins[axis] : maxs[axis]);
+      // max and min return their second operand when the first is NaN
+      tNear = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(nearPlanes, origin), inverse), tNear);
+      tFar = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(farPlanes, origin), inverse), tFar);
+    }
+    _mm_store_ps(entry, tNear);
+    tFar = _mm_mul_ps(tFar, _mm_set1_ps(WIDE_BVH_FAR_SCALE));
+    return unsigned(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+  }
+#endif
+#ifdef WIDE_BVH_AVX2
+  WIDE_BVH_AVX2 unsigned int hitLanesAvx2(const WideBVHNode<8> &node, const WideRay &ray,
+                                          float tMin, float tMax, float *entry) {
+    const float *mins[3] = {node.minX, node.minY, node.minZ};
+    const float *maxs[3] = {node.maxX, node.maxY, node.maxZ};
+    auto tNear = _mm256_set1_ps(tMin);
+    auto tFar = _mm256_set1_ps(tMax);
+    for (auto axis = 0; axis < 3; axis++) {
+      auto origin = _mm256_set1_ps(ray.origin[axis]);
+      auto inverse = _mm256_set1_ps(ray.inverse[axis]);
+      auto nearPlanes = _mm256_load_ps(ray.negative[axis] ? maxs[axis] : mins[axis]);
+      auto farPlanes = _mm256_load_ps(ray.negative[axis] ? mins[axis] : maxs[axis]);
+      tNear = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(nearPlanes, origin), inverse), tNear);
+      tFar = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(farPlanes, origin), inverse), tFar);
+    }
+    _mm256_store_ps(entry, tNear);
+    tFar = _mm256_mul_ps(tFar, _mm256_set1_ps(WIDE_BVH_FAR_SCALE));
+    return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ)));
+  }
+#endif
+  bool supportsAvx2() {
+#if defined(WIDE_BVH_AVX2) && defined(__GNUC__)
+    return __builtin_cpu_supports("avx2");
+#elif defined(WIDE_BVH_AVX2)
+    return true;
+#else
+    return false;
+#endif
+  }
+  template <unsigned int Width> LaneTest<Width> laneTest();
+  template <> LaneTest<4> laneTest<4>() {
+#ifdef WIDE_BVH_SSE
+    return hitLanesSse;
+#else
+    return hitLanesScalar<4>;
+#endif
+  }
+  template <> LaneTest<8> laneTest<8>() {
+#ifdef WIDE_BVH_AVX2
+    static const auto test = supportsAvx2() ? hitLanesAvx2 : hitLanesScalar<8>;
+    return test;
+#else
+    return hitLanesScalar<8>;
+#endif
+  }
+  /**
+   * @brief A child waiting to be visited, with the distance at which the ray
+   * enters it
+   */
+  struct WideStackEntry {
+    std::uint32_t child;
+    std::uint32_t count;
+    float t;
+  };
+  std::shared_ptr<Shape> WideBVH::create(const std::vector<std::shared_ptr<Shape>> &shapes,
+                                         const BVHOptions &options) {
+    auto bvh = new WideBVH();
+    bvh->options = options;
+    bvh->build(shapes);
+    return bvh->sharedPtr;
+  }
+  void WideBVH::build(const std::vector<std::shared_ptr<Shape>> &shapes) {
+    this->nodes4.clear();
+    this->nodes8.clear();
+    this->primitives.clear();
+    this->rootBounds = BoundingBox();
+    this->depth = 0;
+    std::vector<BoundingBox> bounds;
+    for (const auto &shape : shapes) {
+      bounds.push_back(shape->parentSpaceBounds());
+      this->rootBounds.add(bounds.back());
+    }
+    auto binaryOptions = this->options;
+    binaryOptions.spatialSplits = false;
+    auto builder = BVHBuilder(binaryOptions);
+    auto root = builder.build(bounds);
+    if (root != nullptr) {
+      if (this->options.width >= 8 && supportsWidth(8)) {
+        this->collapse(*root, this->nodes8, shapes, builder.order(), 1);
+      } else {
+        this->collapse(*root, this->nodes4, shapes, builder.order(), 1);
+      }
+    }
+    this->builtCost = this->sahCost();
+  }
+  bool WideBVH::supportsWidth(unsigned int width) {
+#ifdef WIDE_BVH_SSE
+    if (width == 4) {
+      return true;
+    }
+#endif
+    return width == 8 && supportsAvx2();
+  }
+  unsigned int WideBVH::width() const { return this->nodes8.empty() ? 4 : 8; }
+  template <unsigned int Width>
+  std::uint32_t WideBVH::collapse(const BVHBuildNode &node, std::vector<WideBVHNode<Width>> &nodes,
+                                  const std::vector<std::shared_ptr<Shape>> &shapes,
+                                  const std::vector<size_t> &order, unsigned int level) {
+    this->depth = std::max(this->depth, level);
+    auto index = std::uint32_t(nodes.size());
+    nodes.emplace_back();
+    std::vector<const BVHBuildNode *> lanes;
+    if (node.isLeaf()) {
+      lanes.push_back(&node);
+    } else {
+      lanes.push_back(node.left.get());
+      lanes.push_back(node.right.get());
+    }
+    // Pull up the grandchildren of the largest interior child until every lane is used
+    while (lanes.size() < Width) {
+      auto largest = lanes.end();
+      for (auto lane = lanes.begin(); lane != lanes.end(); ++lane) {
+        if (!(*lane)->isLeaf()
+            && (largest == lanes.end()
+                || (*lane)->bounds.surfaceArea() > (*largest)->bounds.surfaceArea())) {
+          largest = lane;
+        }
+      }
+      if (largest == lanes.end()) {
+        break;
+      }
+      auto opened = *largest;
+      *largest = opened->left.get();
+      lanes.push_back(opened->right.get());
+    }
+    for (auto lane = 0U; lane < Width; lane++) {
+      setLane(nodes[index], lane, lane < lanes.size() ? lanes[lane]->bounds : BoundingBox());
+      nodes[index].child[lane] = 0;
+      nodes[index].count[lane] = 0;
+    }
+    for (auto lane = 0U; lane < lanes.size(); lane++) {
+      const auto &child = *lanes[lane];
+      if (child.isLeaf()) {
+        nodes[index].child[lane] = std::uint32_t(this->primitives.size());
+        nodes[index].count[lane] = std::uint32_t(child.count);
+        for (auto i = child.first; i < child.first + child.count; i++) {
+          this->primitives.push_back(shapes[order[i]]);
+        }
+      } else {
+        // Collapsing the child may reallocate nodes, so index it again afterwards
+        auto childIndex = this->collapse(child, nodes, shapes, order, level + 1);
+        nodes[index].child[lane] = childIndex;
+      }
+    }
+    return index;
+  }
+  template <unsigned int Width, typename Visit>
+  void WideBVH::traverse(const std::vector<WideBVHNode<Width>> &nodes, const Ray &ray, Scalar tMin,
+                         Scalar &tMax, Visit visit) const {
+    if (nodes.empty()) {
+      return;
+    }
+    auto test = laneTest<Width>();
+    auto wideRay = WideRay(ray);
+    WideStackEntry inlineStack[256];
+    std::vector<WideStackEntry> heapStack;
+    auto stack = inlineStack;
+    auto capacity = size_t(this->depth) * (Width - 1) + 1;
+    if (capacity > 256) {
+      heapStack.resize(capacity);
+      stack = heapStack.data();
+    }
+    alignas(32) float entry[Width];
+    size_t top = 0;
+    stack[top++] = {0, 0, lowerFloat(tMin)};
+    while (top > 0) {
+      auto current = stack[--top];
+      auto far = upperFloat(tMax);
+      if (current.t > far * WIDE_BVH_FAR_SCALE) {
+        continue;
+      }
+      if (current.count > 0) {
+        if (visit(current.child, current.count, tMax)) {
+          return;
+        }
+        continue;
+      }
+      const auto &node = nodes[current.child];
+      auto mask = test(node, wideRay, lowerFloat(tMin), far, entry);
+      // Push the children furthest first, so the nearest is visited next
+      auto first = top;
+      for (auto lane = 0U; lane < Width; lane++) {
+        if ((mask & (1U << lane)) == 0) {
+          continue;
+        }
+        auto hit = WideStackEntry{node.child[lane], node.count[lane], entry[lane]};
+        auto i = top++;
+        while (i > first && stack[i - 1].t < hit.t) {
+          stack[i] = stack[i - 1];
+          i--;
+        }
+        stack[i] = hit;
+      }
+    }
+  }
+  template <typename Visit>
+  void WideBVH::traverse(const Ray &ray, Scalar tMin, Scalar &tMax, Visit visit) const {
+    if (this->width() == 8) {
+      this->traverse(this->nodes8, ray, tMin, tMax, visit);
+    } else {
+      this->traverse(this->nodes4, ray, tMin, tMax, visit);
+    }
+  }
+  void WideBVH::localIntersect(const Ray &ray, Intersections &xs) {
+    auto first = xs.size();
+    auto tMax = Scalar(INFINITY);
+    this->traverse(ray, 0.0, tMax, [this, &ray, &xs](std::uint32_t first, std::uint32_t count,
+                                                      Scalar &) {
+      for (auto i = first; i < first + count; i++) {
+        this->primitives[i]->intersect(ray, xs);
+      }
+      return false;
+    });
+    xs.sort(first);
+  }
+  bool WideBVH::localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection &closest) {
+    auto found = false;
+    this->traverse(ray, tMin, tMax, [this, &ray, tMin, &closest, &found](
+                                        std::uint32_t first, std::uint32_t count, Scalar &tFar) {
+      for (auto i = first; i < first + count; i++) {
+        if (this->primitives[i]->intersectClosest(ray, tMin, tFar, closest)) {
+          tFar = closest.t;
+          found = true;
+        }
+      }
+      return false;
+    });
+    return found;
+  }
+  bool WideBVH::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    auto found = false;
+    this->traverse(ray, tMin, tMax, [this, &ray, tMin, &found](std::uint32_t first,
+                                                                std::uint32_t count, Scalar &tFar) {
+      for (auto i = first; i < first + count; i++) {
+        if (this->primitives[i]->intersectsAny(ray, tMin, tFar)) {
+          found = true;
+          return true;
+        }
+      }
+      return false;
+    });
+    return found;
+  }
+  template <unsigned int Width> void WideBVH::refitNodes(std::vector<WideBVHNode<Width>> &nodes) {
+    // Children are stored after their parents, so a reverse pass visits them first
+    for (auto index = nodes.size(); index-- > 0;) {
+      auto &node = nodes[index];
+      for (auto lane = 0U; lane < Width; lane++) {
+        auto box = BoundingBox();
+        if (node.count[lane] > 0) {
+          for (auto i = node.child[lane]; i < node.child[lane] + node.count[lane]; i++) {
+            box.add(this->primitives[i]->parentSpaceBounds());
+          }
+        } else if (node.child[lane] > 0) {
+          const auto &child = nodes[node.child[lane]];
+          for (auto childLane = 0U; childLane < Width; childLane++) {
+            if (child.count[childLane] > 0 || child.child[childLane] > 0) {
+              box.add(laneBounds(child, childLane));
+            }
+          }
+        } else {
+          continue;
+        }
+        setLane(node, lane, box);
+      }
+    }
+  }
+  void WideBVH::refit() {
+    this->rootBounds = BoundingBox();
+    for (const auto &primitive : this->primitives) {
+      primitive->refit();
+      this->rootBounds.add(primitive->parentSpaceBounds());
+    }
+    if (this->width() == 8) {
+      this->refitNodes(this->nodes8);
+    } else {
+      this->refitNodes(this->nodes4);
+    }
+    auto cost = this->sahCost();
+    if (!std::isfinite(cost) || cost <= this->options.rebuildThreshold * this->builtCost) {
+      return;
+    }
+    auto shapes = this->primitives;
+    this->build(shapes);
+  }
+  template <unsigned int Width>
+  double WideBVH::sahCost(const std::vector<WideBVHNode<Width>> &nodes) const {
+    auto area = [](const BoundingBox &box) {
+      auto extent = box.max - box.min;
+      return 2.0 * (double(extent.x) * double(extent.y) + double(extent.y) * double(extent.z)
+                    + double(extent.z) * double(extent.x));
+    };
+    if (nodes.empty()) {
+      return 0.0;
+    }
+    auto root = BoundingBox();
+    for (auto lane = 0U; lane < Width; lane++) {
+      if (nodes[0].count[lane] > 0 || nodes[0].child[lane] > 0) {
+        root.add(laneBounds(nodes[0], lane));
+      }
+    }
+    auto rootArea = area(root);
+    // Every node is entered through its parent's lane, apart from the root
+    auto cost = this->options.traversalCost;
+    for (const auto &node : nodes) {
+      for (auto lane = 0U; lane < Width; lane++) {
+        if (node.count[lane] == 0 && node.child[lane] == 0) {
+          continue;
+        }
+        auto probability = rootArea > 0.0 ? area(laneBounds(node, lane)) / rootArea : 1.0;
+        cost += probability
+                * (node.count[lane] > 0 ? this->options.intersectionCost * double(node.count[lane])
+                                        : this->options.traversalCost);
+      }
+    }
+    return cost;
+  }
+  double WideBVH::sahCost() const {
+    return this->width() == 8 ? this->sahCost(this->nodes8) : this->sahCost(this->nodes4);
+  }
+  Tuple WideBVH::localNormalAt(Tuple point, Intersection hit) {
+    (void)point;
+    (void)hit;
+    return {};
+  }
+  BoundingBox WideBVH::bounds() { return this->rootBounds; }
+  bool WideBVH::includes(const Shape &object) const {
+    if (this->is(object)) {
+      return true;
+    }
+    return std::any_of(this->primitives.cbegin(), this->primitives.cend(),
+                       [&object](const auto &primitive) { return primitive->includes(object); });
+  }
+  void WideBVH::freeze() {
+    this->freezeTransform();
+    for (const auto &primitive : this->primitives) {
+      primitive->freeze();
+    }
+  }
+  void WideBVH::thaw() {
+    Shape::thaw();
+    for (const auto &primitive : this->primitives) {
+      primitive->thaw();
+    }
+  }
+  void WideBVH::setMaterial(std::shared_ptr<Material> &newMaterial) {
+    this->material = newMaterial;
+    for (const auto &primitive : this->primitives) {
+      primitive->setMaterial(newMaterial);
+    }
+  }
+}  // namespace raytracerchallenge
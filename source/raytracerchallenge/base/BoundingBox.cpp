@@ -1,6 +1,8 @@
 #include <raytracerchallenge/Constants.h>
 #include <raytracerchallenge/base/BoundingBox.h>
 
+#include <cmath>
+
 namespace raytracerchallenge {
   void BoundingBox::add(Tuple point) {
     if (point.x < this->min.x) {
@@ -33,32 +35,26 @@ namespace raytracerchallenge {
   bool BoundingBox::contains(BoundingBox box) const {
     return this->contains(box.max) && this->contains(box.min);
   }
-  std::array<double, 2> checkBoxAxis(double origin, double direction, double min = -1.0,
-                                     double max = 1.0) {
-    auto tminNumerator = (min - origin);
-    auto tmaxNumerator = (max - origin);
-    double tmin;
-    double tmax;
-    if (abs(direction) >= EPS) {
-      tmin = tminNumerator / direction;
-      tmax = tmaxNumerator / direction;
-    } else {
-      tmin = tminNumerator * INFINITY;
-      tmax = tmaxNumerator * INFINITY;
-    }
-    if (tmin > tmax) {
-      std::swap(tmin, tmax);
-    }
-    return {tmin, tmax};
+  /**
+   * @brief Return the distances at which a ray enters and leaves the slab
+   * between two planes on one axis. A ray starting on a plane it runs along
+   * gives NaN, which callers ignore.
+   */
+  std::array<Scalar, 2> checkBoxAxis(const Ray &ray, int axis, Scalar min, Scalar max) {
+    Scalar origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    Scalar inverse[3] = {ray.inverseDirection.x, ray.inverseDirection.y, ray.inverseDirection.z};
+    Scalar planes[2] = {min, max};
+    return {(planes[ray.sign[axis]] - origin[axis]) * inverse[axis],
+            (planes[1 - ray.sign[axis]] - origin[axis]) * inverse[axis]};
   }
-  BoundingBox BoundingBox::transform(const Matrix &matrix) const {
+  BoundingBox BoundingBox::transform(const Transform &matrix) const {
     auto p1 = this->min;
     auto p2 = Tuple(this->min.x, this->min.y, this->max.z, 1.0);
     auto p3 = Tuple(this->min.x, this->max.y, this->min.z, 1.0);
     auto p4 = Tuple(this->min.x, this->max.y, this->max.z, 1.0);
     auto p5 = Tuple(this->max.x, this->min.y, this->min.z, 1.0);
     auto p6 = Tuple(this->max.x, this->min.y, this->max.z, 1.0);
-    auto p7 = Tuple(this->min.x, this->min.y, this->max.z, 1.0);
+    auto p7 = this->max;
     auto p8 = Tuple(this->max.x, this->max.y, this->min.z, 1.0);
     auto newBox = BoundingBox();
     for (Tuple p : {p1, p2, p3, p4, p5, p6, p7, p8}) {
@@ -67,18 +63,26 @@ namespace raytracerchallenge {
     return newBox;
   }
   bool BoundingBox::intersects(Ray ray) const {
-    auto xMinMax = checkBoxAxis(ray.origin.x, ray.direction.x, this->min.x, this->max.x);
-    auto yMinMax = checkBoxAxis(ray.origin.y, ray.direction.y, this->min.y, this->max.y);
-    auto zMinMax = checkBoxAxis(ray.origin.z, ray.direction.z, this->min.z, this->max.z);
-    auto tMin = std::max({xMinMax[0], yMinMax[0], zMinMax[0]});
-    auto tMax = std::min({xMinMax[1], yMinMax[1], zMinMax[1]});
-    if (tMin > tMax) {
+    auto tMin = Scalar(-INFINITY);
+    auto tMax = Scalar(INFINITY);
+    if (!this->clip(ray, tMin, tMax)) {
       return false;
     }
-    if (tMin > 0 || tMax > 0) {
-      return true;
+    return tMin > 0 || tMax > 0;
+  }
+  bool BoundingBox::intersects(Ray ray, Scalar tMin, Scalar tMax) const {
+    return this->clip(ray, tMin, tMax);
+  }
+  bool BoundingBox::clip(const Ray &ray, Scalar &tMin, Scalar &tMax) const {
+    Scalar mins[3] = {this->min.x, this->min.y, this->min.z};
+    Scalar maxs[3] = {this->max.x, this->max.y, this->max.z};
+    for (auto axis = 0; axis < 3; axis++) {
+      auto slab = checkBoxAxis(ray, axis, mins[axis], maxs[axis]);
+      // Written so that NaN distances leave the range unchanged
+      tMin = slab[0] > tMin ? slab[0] : tMin;
+      tMax = slab[1] < tMax ? slab[1] : tMax;
     }
-    return false;
+    return tMin <= tMax;
   }
   std::vector<BoundingBox> BoundingBox::split() {
     auto dx = abs(this->max.x - this->min.x);
@@ -107,4 +111,28 @@ namespace raytracerchallenge {
     auto right = BoundingBox(midMin, this->max);
     return {left, right};
   }
+  Tuple BoundingBox::centroid() const { return (this->min + this->max) * 0.5; }
+  Scalar BoundingBox::surfaceArea() const {
+    auto dx = this->max.x - this->min.x;
+    auto dy = this->max.y - this->min.y;
+    auto dz = this->max.z - this->min.z;
+    if (dx < 0.0 || dy < 0.0 || dz < 0.0) {
+      return 0.0;
+    }
+    return 2.0 * (dx * dy + dy * dz + dz * dx);
+  }
+  bool BoundingBox::isFinite() const {
+    return std::isfinite(this->min.x) && std::isfinite(this->min.y) && std::isfinite(this->min.z)
+           && std::isfinite(this->max.x) && std::isfinite(this->max.y)
+           && std::isfinite(this->max.z);
+  }
+  bool BoundingBox::isEmpty() const {
+    return this->min.x > this->max.x || this->min.y > this->max.y || this->min.z > this->max.z;
+  }
+  BoundingBox BoundingBox::clipped(const BoundingBox &box) const {
+    return {Tuple::point(std::max(this->min.x, box.min.x), std::max(this->min.y, box.min.y),
+                         std::max(this->min.z, box.min.z)),
+            Tuple::point(std::min(this->max.x, box.max.x), std::min(this->max.y, box.max.y),
+                         std::min(this->max.z, box.max.z))};
+  }
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <raytracerchallenge/base/CachedTransform.h>
+
+#include <atomic>
+#include <utility>
+
+namespace raytracerchallenge {
+  std::atomic<std::uint64_t> cachedTransformVersions{0};
+  CachedTransform::CachedTransform() = default;
+  CachedTransform::CachedTransform(const Transform &transform) : Transform(transform) {
+    this->update();
+  }
+  CachedTransform::CachedTransform(const CachedTransform &transform)
+      : Transform(transform),
+        inverseTransform(transform.inverseTransform),
+        normalTransform(transform.normalTransform),
+        currentVersion(transform.currentVersion) {}
+  CachedTransform &CachedTransform::operator=(const Transform &transform) {
+    Transform::operator=(transform);
+    this->update();
+    return *this;
+  }
+  CachedTransform &CachedTransform::operator=(const CachedTransform &transform) {
+    if (this == &transform) {
+      return *this;
+    }
+    Transform::operator=(transform);
+    this->inverseTransform = transform.inverseTransform;
+    this->normalTransform = transform.normalTransform;
+    this->currentVersion = transform.currentVersion;
+    if (this->changes != nullptr) {
+      this->changes->fetch_add(1, std::memory_order_relaxed);
+    }
+    return *this;
+  }
+  const Transform &CachedTransform::inverse() const { return this->inverseTransform; }
+  const Transform &CachedTransform::normalMatrix() const { return this->normalTransform; }
+  std::uint64_t CachedTransform::version() const { return this->currentVersion; }
+  void CachedTransform::reportChangesTo(std::shared_ptr<std::atomic<std::uint64_t>> counter) {
+    this->changes = std::move(counter);
+  }
+  void CachedTransform::update() {
+    this->currentVersion = ++cachedTransformVersions;
+    if (this->changes != nullptr) {
+      this->changes->fetch_add(1, std::memory_order_relaxed);
+    }
+    this->inverseTransform = Transform::inverse();
+    if (this->kind() <= TransformKind::UniformScale) {
+      // The normal matrix of a uniform scale is the inverse scale; of a translation, the identity
+      Scalar scale = this->inverseTransform.m(0, 0);
+      this->normalTransform = Transform::scaling(scale, scale, scale);
+      return;
+    }
+    // Normals are vectors, so only the linear part of the inverse is needed
+    Matrix4 normal = Matrix4::Identity();
+    normal.topLeftCorner<3, 3>() = this->inverseTransform.m.topLeftCorner<3, 3>().transpose();
+    this->normalTransform = Transform(normal);
+  }
+}  // namespace raytracerchallenge
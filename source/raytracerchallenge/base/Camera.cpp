@@ -4,14 +4,16 @@
 #include <raytracerchallenge/base/World.h>
 #include <raytracerchallenge/parallel/Parallel.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace raytracerchallenge {
-  Camera::Camera(int hSize, int vSize, double fieldOfView) {
+  Camera::Camera(int hSize, int vSize, Scalar fieldOfView) {
     this->hSize = hSize;
     this->vSize = vSize;
     this->fieldOfView = fieldOfView;
-    this->transform = Matrix::identity(4);
     auto halfView = tan(this->fieldOfView / 2.0);
-    auto aspect = double(this->hSize) / double(this->vSize);
+    auto aspect = Scalar(this->hSize) / Scalar(this->vSize);
     if (aspect >= 1) {
       halfWidth = halfView;
       halfHeight = halfView / aspect;
@@ -19,26 +21,47 @@ namespace raytracerchallenge {
       halfWidth = halfView * aspect;
       halfHeight = halfView;
     }
-    pixelSize = (halfWidth * 2.0) / double(hSize);
+    pixelSize = (halfWidth * 2.0) / Scalar(hSize);
   }
   Ray Camera::rayForPixel(int x, int y) {
     auto xOffset = (x + 0.5) * pixelSize;
     auto yOffset = (y + 0.5) * pixelSize;
-    auto worldX = double(halfWidth - xOffset);
-    auto worldY = double(halfHeight - yOffset);
-    auto pixel = transform.inverse() * Tuple::point(worldX, worldY, -1.0);
-    auto origin = transform.inverse() * Tuple::point(0.0, 0.0, 0.0);
+    auto worldX = Scalar(halfWidth - xOffset);
+    auto worldY = Scalar(halfHeight - yOffset);
+    const auto &inverse = transform.inverse();
+    auto pixel = inverse * Tuple::point(worldX, worldY, -1.0);
+    auto origin = inverse * Tuple::point(0.0, 0.0, 0.0);
     auto direction = (pixel - origin).normalize();
     return {origin, direction};
   }
   Canvas Camera::render(World world) {
+    // Pixels are traced in square tiles, whose rays are coherent enough to share a traversal
+    constexpr int tileSize = 4;
     auto image = Canvas(hSize, vSize);
-    parallelFor(vSize, [this, &world, &image](int s, int e) {
-      for (int y = s; y < e; y++) {
-        for (int x = 0; x < hSize; x++) {
-          auto ray = rayForPixel(x, y);
-          auto color = world.colorAt(ray, 4);
-          image.writePixel(x, y, color);
+    world.build();
+    auto columns = (hSize + tileSize - 1) / tileSize;
+    auto tiles = columns * ((vSize + tileSize - 1) / tileSize);
+    parallelFor(tiles, [this, &world, &image, columns](int s, int e) {
+      std::vector<Ray> rays;
+      rays.reserve(tileSize * tileSize);
+      Color colors[tileSize * tileSize];
+      for (int tile = s; tile < e; tile++) {
+        auto tileX = tile % columns * tileSize;
+        auto tileY = tile / columns * tileSize;
+        auto endX = std::min(tileX + tileSize, hSize);
+        auto endY = std::min(tileY + tileSize, vSize);
+        rays.clear();
+        for (int y = tileY; y < endY; y++) {
+          for (int x = tileX; x < endX; x++) {
+            rays.push_back(rayForPixel(x, y));
+          }
+        }
+        world.colorAt(rays.data(), unsigned(rays.size()), 4, colors);
+        auto *color = colors;
+        for (int y = tileY; y < endY; y++) {
+          for (int x = tileX; x < endX; x++) {
+            image.writePixel(x, y, *color++);
+          }
         }
       }
     });
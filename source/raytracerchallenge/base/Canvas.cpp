@@ -24,8 +24,8 @@ namespace raytracerchallenge {
       std::string line;
       for (int x = 0; x < this->width; x++) {
         Color c = this->pixels[x][y];
-        std::vector<double> colorVals{c.red, c.green, c.blue};
-        std::for_each(colorVals.begin(), colorVals.end(), [&line, &header](double f) {
+        std::vector<Scalar> colorVals{c.red, c.green, c.blue};
+        std::for_each(colorVals.begin(), colorVals.end(), [&line, &header](Scalar f) {
           std::string val
               = fmt::to_string(std::ceil(std::clamp(float(f * 255.0), float(0.0), float(255.0))));
           if (line.size() + val.size() > 70) {
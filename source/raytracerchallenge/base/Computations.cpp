@@ -2,7 +2,7 @@
 #include <raytracerchallenge/base/Computations.h>
 
 namespace raytracerchallenge {
-  double Computations::schlick(const Computations &computations) {
+  Scalar Computations::schlick(const Computations &computations) {
     auto cos = computations.eyeVector.dot(computations.normalVector);
     if (computations.n1 > computations.n2) {
       auto n = computations.n1 / computations.n2;
@@ -4,14 +4,19 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Shape.h>
 
+#include <algorithm>
+
 namespace raytracerchallenge {
-  Intersection::Intersection(double t, std::shared_ptr<Shape> object) {
+  Intersection::Intersection(Scalar t, Shape *object) {
     this->t = t;
-    this->object = std::move(object);
+    this->object = object;
   }
+  Intersection::Intersection(Scalar t, const std::shared_ptr<Shape> &object)
+      : Intersection(t, object.get()) {}
   Intersection::Intersection() = default;
   bool Intersection::operator==(const Intersection &intersection) const {
-    return this->object->is(*intersection.object) && this->t == intersection.t;
+    return this->object == intersection.object && this->t == intersection.t
+           && this->primitive == intersection.primitive;
   }
   bool Intersection::operator<(const Intersection &intersection) const {
     return this->t < intersection.t;
@@ -35,8 +40,8 @@ namespace raytracerchallenge {
   Computations Intersection::prepareComputations(Ray ray,
                                                  const Intersections &intersections) const {
     auto computations = prepareComputations(ray);
-    std::vector<std::shared_ptr<Shape>> containers;
-    for (const Intersection &i : intersections.intersections) {
+    std::vector<Shape *> containers;
+    for (const Intersection &i : intersections) {
       if (i == *this) {
         if (containers.empty()) {
           computations.n1 = 1.0;
@@ -62,23 +67,52 @@ namespace raytracerchallenge {
     return computations;
   }
   std::optional<Intersection> Intersections::hit() const {
-    std::vector<Intersection> nonNegative;
-    std::copy_if(intersections.cbegin(), intersections.cend(), std::back_inserter(nonNegative),
-                 [](const Intersection &i) { return i.t >= 0.0; });
-    if (nonNegative.empty()) {
+    const Intersection *closest = nullptr;
+    for (const auto &i : *this) {
+      if (i.t >= 0.0 && (closest == nullptr || i < *closest)) {
+        closest = &i;
+      }
+    }
+    if (closest == nullptr) {
       return {};
     }
-    return *std::min_element(nonNegative.begin(), nonNegative.end());
+    return *closest;
   }
   Intersections::Intersections() = default;
-  void Intersections::Intersections::addAll(Intersections newIntersections) {
-    this->intersections.insert(this->intersections.end(), newIntersections.intersections.begin(),
-                               newIntersections.intersections.end());
+  Intersections::Intersections(std::initializer_list<Intersection> intersections) {
+    for (const auto &intersection : intersections) {
+      this->add(intersection);
+    }
+  }
+  void Intersections::addAll(const Intersections &newIntersections) {
+    for (const auto &intersection : newIntersections) {
+      this->add(intersection);
+    }
+  }
+  void Intersections::spill(const Intersection &intersection) {
+    // Once the inline buffer is full every intersection moves to overflow, so
+    // that the collection always occupies one contiguous range
+    if (this->count == inlineCapacity) {
+      this->overflow.assign(this->inlineIntersections, this->inlineIntersections + inlineCapacity);
+    }
+    this->overflow.push_back(intersection);
+    this->count++;
+  }
+  void Intersections::truncate(size_t size) {
+    if (size >= this->count) {
+      return;
+    }
+    if (this->count > inlineCapacity && size <= inlineCapacity) {
+      std::copy(this->overflow.begin(), this->overflow.begin() + long(size),
+                this->inlineIntersections);
+    }
+    this->overflow.resize(size > inlineCapacity ? size : 0);
+    this->count = size;
   }
-  Intersections::Intersections(std::vector<Intersection> intersections) {
-    this->intersections = std::move(intersections);
+  void Intersections::clear() {
+    this->overflow.clear();
+    this->count = 0;
   }
-  Intersection Intersections::operator[](unsigned int x) const { return this->intersections[x]; }
-  size_t Intersections::size() const { return this->intersections.size(); }
-  void Intersections::sort() { std::sort(this->intersections.begin(), this->intersections.end()); }
+  void Intersections::sort() { std::sort(this->begin(), this->end()); }
+  void Intersections::sort(size_t first) { std::sort(this->begin() + first, this->end()); }
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -34,13 +34,21 @@ namespace raytracerchallenge {
 
   double Matrix::determinant() const { return this->m.determinant(); }
   bool Matrix::invertible() const { return determinant() != 0.0; }
-  Matrix Matrix::inverse() {
-    if (this->inv != nullptr) {
-      return *this->inv;
+  Matrix Matrix::inverse() const {
+    const auto *cache = this->inverseCache.load(std::memory_order_acquire);
+    if (cache != nullptr && cache->source.rows() == this->m.rows()
+        && cache->source.cols() == this->m.cols() && cache->source == this->m) {
+      return Matrix(cache->inverse);
     }
-    std::lock_guard<std::mutex> lock(this->mx);
-    this->inv = std::shared_ptr<Matrix>(new Matrix(this->m.inverse()));
-    return *this->inv;
+    MatrixXd inverse = this->m.inverse();
+    // A stale cache is kept behind the new one, as other threads may still be reading it
+    const auto *fresh = new InverseCache{this->m, inverse, cache};
+    if (!this->inverseCache.compare_exchange_strong(cache, fresh, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+      // Another thread published first; its cache is as good as this one
+      delete fresh;
+    }
+    return Matrix(inverse);
   }
   Matrix Matrix::translation(double x, double y, double z) {
     Matrix res = Matrix::identity(4);
@@ -127,10 +135,29 @@ namespace raytracerchallenge {
                         {0.0, 0.0, 0.0, 1.0}});
     return orientation * translation(-from.x, -from.y, -from.z);
   }
-  Matrix::Matrix(Matrix &m) { this->m = m.m; }
+  Matrix::Matrix(const Matrix &m) : m(m.m) { this->copyInverse(m); }
+  Matrix::~Matrix() { this->releaseInverse(); }
   Matrix &Matrix::operator=(const Matrix &mat) {
     if (this == &mat) return *this;
     this->m = mat.m;
+    this->releaseInverse();
+    this->copyInverse(mat);
     return *this;
   }
+  void Matrix::copyInverse(const Matrix &matrix) {
+    const auto *cache = matrix.inverseCache.load(std::memory_order_acquire);
+    if (cache == nullptr) {
+      return;
+    }
+    this->inverseCache.store(new InverseCache{cache->source, cache->inverse, nullptr},
+                             std::memory_order_release);
+  }
+  void Matrix::releaseInverse() {
+    const auto *cache = this->inverseCache.exchange(nullptr, std::memory_order_acquire);
+    while (cache != nullptr) {
+      const auto *previous = cache->previous;
+      delete cache;
+      cache = previous;
+    }
+  }
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -1,15 +1,32 @@
 
-#include <raytracerchallenge/base/Matrix.h>
+#include <raytracerchallenge/Constants.h>
 #include <raytracerchallenge/base/Ray.h>
 #include <raytracerchallenge/base/Tuple.h>
 
+#include <cmath>
+
 namespace raytracerchallenge {
+  Scalar inverseComponent(Scalar component) {
+    return std::abs(component) >= EPS ? Scalar(1) / component : Scalar(INFINITY);
+  }
   Ray::Ray(Tuple origin, Tuple direction) {
     this->origin = origin;
     this->direction = direction;
+    this->inverseDirection
+        = Tuple::vector(inverseComponent(direction.x), inverseComponent(direction.y),
+                        inverseComponent(direction.z));
+    this->sign[0] = this->inverseDirection.x < 0 ? 1 : 0;
+    this->sign[1] = this->inverseDirection.y < 0 ? 1 : 0;
+    this->sign[2] = this->inverseDirection.z < 0 ? 1 : 0;
   }
-  Tuple Ray::position(double t) const { return Tuple(this->origin + this->direction * t); }
-  Ray Ray::transform(const Matrix &matrix) const {
+  Tuple Ray::position(Scalar t) const { return Tuple(this->origin + this->direction * t); }
+  Ray Ray::transform(const Transform &matrix) const {
+    if (matrix.kind() == TransformKind::Translation) {
+      // Translation leaves the direction, and so its inverse and signs, unchanged
+      Ray result = *this;
+      result.origin = matrix * this->origin;
+      return result;
+    }
     return {matrix * this->origin, matrix * this->direction};
   }
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <raytracerchallenge/Constants.h>
+#include <raytracerchallenge/base/Transform.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace raytracerchallenge {
+  template <typename M> TransformKind classifyTransform(const M &m) {
+    if (m(3, 0) != 0 || m(3, 1) != 0 || m(3, 2) != 0 || m(3, 3) != 1) {
+      return TransformKind::Projective;
+    }
+    if (m(0, 1) != 0 || m(0, 2) != 0 || m(1, 0) != 0 || m(1, 2) != 0 || m(2, 0) != 0
+        || m(2, 1) != 0 || m(0, 0) != m(1, 1) || m(0, 0) != m(2, 2)) {
+      return TransformKind::Affine;
+    }
+    return m(0, 0) == 1 ? TransformKind::Translation : TransformKind::UniformScale;
+  }
+  template <typename T> BasicTransform<T>::BasicTransform() : m(Matrix4::Identity()) {}
+  template <typename T>
+  BasicTransform<T>::BasicTransform(const Matrix &matrix) : m(matrix.m.template cast<T>()) {
+    this->transformKind = classifyTransform(this->m);
+  }
+  template <typename T> BasicTransform<T>::BasicTransform(const Matrix4 &m) : m(m) {
+    this->transformKind = classifyTransform(m);
+  }
+  template <typename T> bool BasicTransform<T>::operator==(const BasicTransform &transform) const {
+    return this->m.isApprox(transform.m, epsilon<T>);
+  }
+  template <typename T> bool BasicTransform<T>::operator!=(const BasicTransform &transform) const {
+    return !(*this == transform);
+  }
+  template <typename T>
+  BasicTransform<T> BasicTransform<T>::operator*(const BasicTransform &transform) const {
+    auto result = BasicTransform();
+    if (this->transformKind <= TransformKind::UniformScale
+        && transform.transformKind <= TransformKind::UniformScale) {
+      // (s1 I, t1) * (s2 I, t2) is (s1 s2 I, s1 t2 + t1)
+      T scale = this->m(0, 0);
+      result.m.diagonal().template head<3>().setConstant(scale * transform.m(0, 0));
+      result.m.template topRightCorner<3, 1>()
+          = scale * transform.m.template topRightCorner<3, 1>()
+            + this->m.template topRightCorner<3, 1>();
+      result.transformKind = std::max(this->transformKind, transform.transformKind);
+      return result;
+    }
+    if (this->isAffine() && transform.isAffine()) {
+      // The bottom row of the product of two affine transforms is already (0, 0, 0, 1)
+      result.m.template topRows<3>().noalias() = this->m.template topRows<3>() * transform.m;
+      result.transformKind = TransformKind::Affine;
+      return result;
+    }
+    result.m.noalias() = this->m * transform.m;
+    result.transformKind = classifyTransform(result.m);
+    return result;
+  }
+  template <typename T>
+  BasicTuple<T> BasicTransform<T>::operator*(const BasicTuple<T> &tuple) const {
+    const auto &a = this->m;
+    switch (this->transformKind) {
+      case TransformKind::Translation:
+        return {tuple.x + a(0, 3) * tuple.w, tuple.y + a(1, 3) * tuple.w,
+                tuple.z + a(2, 3) * tuple.w, tuple.w};
+      case TransformKind::UniformScale:
+        return {a(0, 0) * tuple.x + a(0, 3) * tuple.w, a(0, 0) * tuple.y + a(1, 3) * tuple.w,
+                a(0, 0) * tuple.z + a(2, 3) * tuple.w, tuple.w};
+      default:
+        break;
+    }
+    auto x = a(0, 0) * tuple.x + a(0, 1) * tuple.y + a(0, 2) * tuple.z + a(0, 3) * tuple.w;
+    auto y = a(1, 0) * tuple.x + a(1, 1) * tuple.y + a(1, 2) * tuple.z + a(1, 3) * tuple.w;
+    auto z = a(2, 0) * tuple.x + a(2, 1) * tuple.y + a(2, 2) * tuple.z + a(2, 3) * tuple.w;
+    if (this->transformKind == TransformKind::Affine) {
+      return {x, y, z, tuple.w};
+    }
+    return {x, y, z, a(3, 0) * tuple.x + a(3, 1) * tuple.y + a(3, 2) * tuple.z + a(3, 3) * tuple.w};
+  }
+  template <typename T> bool BasicTransform<T>::isAffine() const {
+    return this->transformKind != TransformKind::Projective;
+  }
+  template <typename T> TransformKind BasicTransform<T>::kind() const {
+    return this->transformKind;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::transposed() const {
+    return BasicTransform(Matrix4(this->m.transpose()));
+  }
+  template <typename T> T BasicTransform<T>::determinant() const {
+    switch (this->transformKind) {
+      case TransformKind::Translation:
+        return T(1);
+      case TransformKind::UniformScale:
+        return this->m(0, 0) * this->m(0, 0) * this->m(0, 0);
+      case TransformKind::Affine:
+        return this->m.template topLeftCorner<3, 3>().determinant();
+      default:
+        return this->m.determinant();
+    }
+  }
+  template <typename T> bool BasicTransform<T>::invertible() const {
+    return this->determinant() != 0;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::inverse() const {
+    auto result = BasicTransform();
+    switch (this->transformKind) {
+      case TransformKind::Translation:
+        result.m.template topRightCorner<3, 1>() = -this->m.template topRightCorner<3, 1>();
+        return result;
+      case TransformKind::UniformScale: {
+        // The inverse of [sI t] is [I/s -t/s]
+        T scale = T(1) / this->m(0, 0);
+        result.m.diagonal().template head<3>().setConstant(scale);
+        result.m.template topRightCorner<3, 1>() = -scale * this->m.template topRightCorner<3, 1>();
+        result.transformKind = TransformKind::UniformScale;
+        return result;
+      }
+      case TransformKind::Affine: {
+        // The inverse of [A t] is [A^-1 -A^-1 t]
+        Eigen::Matrix<T, 3, 3> linear = this->m.template topLeftCorner<3, 3>().inverse();
+        result.m.template topLeftCorner<3, 3>() = linear;
+        result.m.template topRightCorner<3, 1>()
+            = -linear * this->m.template topRightCorner<3, 1>();
+        result.transformKind = TransformKind::Affine;
+        return result;
+      }
+      default:
+        return BasicTransform(Matrix4(this->m.inverse()));
+    }
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::translated(T x, T y, T z) const {
+    return translation(x, y, z) * *this;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::scaled(T x, T y, T z) const {
+    return scaling(x, y, z) * *this;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::rotatedX(T radians) const {
+    return rotationX(radians) * *this;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::rotatedY(T radians) const {
+    return rotationY(radians) * *this;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::rotatedZ(T radians) const {
+    return rotationZ(radians) * *this;
+  }
+  template <typename T>
+  BasicTransform<T> BasicTransform<T>::sheared(T xy, T xz, T yx, T yz, T zx, T zy) const {
+    return shearing(xy, xz, yx, yz, zx, zy) * *this;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::identity() { return {}; }
+  template <typename T> BasicTransform<T> BasicTransform<T>::translation(T x, T y, T z) {
+    auto result = BasicTransform();
+    result.m(0, 3) = x;
+    result.m(1, 3) = y;
+    result.m(2, 3) = z;
+    return result;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::scaling(T x, T y, T z) {
+    auto result = BasicTransform();
+    result.m(0, 0) = x;
+    result.m(1, 1) = y;
+    result.m(2, 2) = z;
+    result.transformKind
+        = x == y && x == z ? TransformKind::UniformScale : TransformKind::Affine;
+    return result;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::rotationX(T radians) {
+    auto result = BasicTransform();
+    result.m(1, 1) = std::cos(radians);
+    result.m(1, 2) = -std::sin(radians);
+    result.m(2, 1) = std::sin(radians);
+    result.m(2, 2) = std::cos(radians);
+    result.transformKind = TransformKind::Affine;
+    return result;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::rotationY(T radians) {
+    auto result = BasicTransform();
+    result.m(0, 0) = std::cos(radians);
+    result.m(0, 2) = std::sin(radians);
+    result.m(2, 0) = -std::sin(radians);
+    result.m(2, 2) = std::cos(radians);
+    result.transformKind = TransformKind::Affine;
+    return result;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::rotationZ(T radians) {
+    auto result = BasicTransform();
+    result.m(0, 0) = std::cos(radians);
+    result.m(0, 1) = -std::sin(radians);
+    result.m(1, 0) = std::sin(radians);
+    result.m(1, 1) = std::cos(radians);
+    result.transformKind = TransformKind::Affine;
+    return result;
+  }
+  template <typename T>
+  BasicTransform<T> BasicTransform<T>::shearing(T xy, T xz, T yx, T yz, T zx, T zy) {
+    auto result = BasicTransform();
+    result.m(0, 1) = xy;
+    result.m(0, 2) = xz;
+    result.m(1, 0) = yx;
+    result.m(1, 2) = yz;
+    result.m(2, 0) = zx;
+    result.m(2, 1) = zy;
+    result.transformKind = TransformKind::Affine;
+    return result;
+  }
+  template <typename T> BasicTransform<T> BasicTransform<T>::view(BasicTuple<T> from,
+                                                                  BasicTuple<T> to,
+                                                                  BasicTuple<T> up) {
+    auto forward = (to - from).normalize();
+    auto left = forward.cross(up.normalize());
+    auto trueUp = left.cross(forward);
+    Matrix4 orientation = Matrix4::Identity();
+    orientation.row(0) << left.x, left.y, left.z, T(0);
+    orientation.row(1) << trueUp.x, trueUp.y, trueUp.z, T(0);
+    orientation.row(2) << -forward.x, -forward.y, -forward.z, T(0);
+    return BasicTransform(orientation) * translation(-from.x, -from.y, -from.z);
+  }
+  template class BasicTransform<float>;
+  template class BasicTransform<double>;
+}  // namespace raytracerchallenge
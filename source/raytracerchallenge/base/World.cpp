@@ -1,11 +1,54 @@
+#include <raytracerchallenge/acceleration/LinearBVH.h>
+#include <raytracerchallenge/acceleration/WideBVH.h>
+#include <raytracerchallenge/base/AffineTransform.h>
 #include <raytracerchallenge/base/World.h>
 #include <raytracerchallenge/shapes/Sphere.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace raytracerchallenge {
+  /* Rays traced together by the packet queries */
+  constexpr unsigned int PACKET_SIZE = 16;
+  template <unsigned int Width>
+  unsigned int closestInPacket(LinearBVH &bvh, const Ray *rays, unsigned int count,
+                               Intersection *closest) {
+    RayPacket<Width> packet{};
+    for (auto lane = 0U; lane < count; lane++) {
+      setRayLane(packet, lane, rays[lane], 0.0, INFINITY);
+    }
+    return bvh.localIntersectClosest(packet, rays, closest);
+  }
+  template <unsigned int Width>
+  unsigned int blockedInPacket(LinearBVH &bvh, const Ray *rays, unsigned int count) {
+    RayPacket<Width> packet{};
+    for (auto lane = 0U; lane < count; lane++) {
+      setRayLane(packet, lane, rays[lane], 0.0, 1.0);
+    }
+    return bvh.localIntersectsAny(packet, rays);
+  }
   World::World() = default;
   bool World::isEmpty() const { return this->objects.empty(); }
-  void World::add(const std::shared_ptr<Shape> &object) { this->objects.push_back(object); }
+  void World::add(const std::shared_ptr<Shape> &object) {
+    this->objects.push_back(object);
+    this->built = false;
+  }
+  void World::build(const BVHOptions &options) {
+    std::vector<std::shared_ptr<Shape>> bounded;
+    this->unbounded.clear();
+    for (const auto &object : this->objects) {
+      object->freeze();
+      (object->parentSpaceBounds().isFinite() ? bounded : this->unbounded).push_back(object);
+    }
+    this->accelerator = options.width > 2 ? WideBVH::create(bounded, options)
+                                          : LinearBVH::create(bounded, options);
+    this->buildOptions = options;
+    this->builtCount = this->objects.size();
+    this->built = true;
+  }
+  void World::build() { this->build(this->buildOptions); }
   World World::defaultWorld() {
+    constexpr auto innerScaling = AffineTransform::scaling(0.5, 0.5, 0.5);
     World world;
     world.light = PointLight(Tuple::point(-10.0, 10.0, -10.0), Color(1.0, 1.0, 1.0));
     auto sphere1 = Sphere::create();
@@ -13,26 +56,108 @@ namespace raytracerchallenge {
     sphere1->material->diffuse = 0.7;
     sphere1->material->specular = 0.2;
     auto sphere2 = Sphere::create();
-    sphere2->transform = Matrix::scaling(0.5, 0.5, 0.5);
+    sphere2->transform = innerScaling;
     world.add(sphere1);
     world.add(sphere2);
     return world;
   }
-  Intersections World::intersect(Ray ray) {
-    Intersections intersections;
+  void World::refit() {
+    if (!this->built || this->builtCount != this->objects.size()) {
+      for (const auto &object : this->objects) {
+        object->refit();
+      }
+      this->build();
+      return;
+    }
+    this->accelerator->refit();
+    for (const auto &object : this->unbounded) {
+      object->refit();
+    }
     for (const auto &object : this->objects) {
-      intersections.addAll(object->intersect(ray));
+      object->freeze();
     }
-    intersections.sort();
+  }
+  void World::buildIfStale() {
+    if (!this->built || this->builtCount != this->objects.size()) {
+      this->build();
+    }
+  }
+  Intersections World::intersect(Ray ray) {
+    auto intersections = Intersections();
+    this->intersect(ray, intersections);
     return intersections;
   }
+  void World::intersect(const Ray &ray, Intersections &xs) {
+    this->buildIfStale();
+    this->accelerator->localIntersect(ray, xs);
+    for (const auto &object : this->unbounded) {
+      object->intersect(ray, xs);
+    }
+    xs.sort();
+  }
+  std::optional<Intersection> World::intersectClosest(Ray ray, Scalar tMin, Scalar tMax) {
+    this->buildIfStale();
+    auto closest = Intersection();
+    auto found = this->accelerator->localIntersectClosest(ray, tMin, tMax, closest);
+    if (found) {
+      tMax = closest.t;
+    }
+    for (const auto &object : this->unbounded) {
+      if (object->intersectClosest(ray, tMin, tMax, closest)) {
+        tMax = closest.t;
+        found = true;
+      }
+    }
+    if (!found) {
+      return {};
+    }
+    return closest;
+  }
+  void World::intersectClosest(const Ray *rays, unsigned int count,
+                               std::optional<Intersection> *hits) {
+    this->buildIfStale();
+    // A WideBVH already tests each ray against all of a node's children at once, so sharing
+    // its traversal between rays costs more than it saves; its rays are traced one at a time
+    auto *bvh = dynamic_cast<LinearBVH *>(this->accelerator.get());
+    for (auto first = 0U; first < count; first += PACKET_SIZE) {
+      auto size = std::min(PACKET_SIZE, count - first);
+      const auto *packetRays = rays + first;
+      Intersection closest[PACKET_SIZE];
+      auto found = 0U;
+      if (bvh != nullptr && size > 1) {
+        found = size <= 4   ? closestInPacket<4>(*bvh, packetRays, size, closest)
+                : size <= 8 ? closestInPacket<8>(*bvh, packetRays, size, closest)
+                            : closestInPacket<16>(*bvh, packetRays, size, closest);
+      } else {
+        for (auto lane = 0U; lane < size; lane++) {
+          if (this->accelerator->localIntersectClosest(packetRays[lane], 0.0, INFINITY,
+                                                       closest[lane])) {
+            found |= 1U << lane;
+          }
+        }
+      }
+      for (auto lane = 0U; lane < size; lane++) {
+        auto tMax = (found & (1U << lane)) != 0 ? closest[lane].t : Scalar(INFINITY);
+        for (const auto &object : this->unbounded) {
+          if (object->intersectClosest(packetRays[lane], 0.0, tMax, closest[lane])) {
+            tMax = closest[lane].t;
+            found |= 1U << lane;
+          }
+        }
+        hits[first + lane] = (found & (1U << lane)) != 0 ? std::optional(closest[lane])
+                                                         : std::nullopt;
+      }
+    }
+  }
   Color World::shadeHit(const Computations &computations, int remaining) {
-    bool shadowed = isShadowed(computations.overPoint);
-    auto surface = lighting(computations.object, this->light.value(), computations.overPoint,
+    return this->shadeHit(computations, remaining, isShadowed(computations.overPoint));
+  }
+  Color World::shadeHit(const Computations &computations, int remaining, bool shadowed) {
+    auto surface = lighting(*computations.object, this->light.value(), computations.overPoint,
                             computations.eyeVector, computations.normalVector, shadowed);
     auto reflected = this->reflectedColorAt(computations, remaining);
     auto refracted = this->refractedColorAt(computations, remaining);
-    auto material = computations.object->material;
+    const auto &material = computations.object->material;
     if (material->reflective > 0.0 && material->transparency > 0.0) {
       auto reflectance = Computations::schlick(computations);
       return surface + reflected * reflectance + refracted * (1 - reflectance);
@@ -40,12 +165,56 @@ namespace raytracerchallenge {
     return surface + reflected + refracted;
   }
   Color World::colorAt(Ray ray, int remaining) {
-    Intersections intersections = this->intersect(ray);
-    std::optional<Intersection> hit = intersections.hit();
+    std::optional<Intersection> hit = this->intersectClosest(ray);
     if (!hit.has_value()) {
       return {0.0, 0.0, 0.0};
     }
-    return shadeHit(hit.value().prepareComputations(ray, intersections), remaining);
+    return this->colorAtHit(ray, *hit, remaining);
+  }
+  void World::colorAt(const Ray *rays, unsigned int count, int remaining, Color *colors) {
+    for (auto first = 0U; first < count; first += PACKET_SIZE) {
+      auto size = std::min(PACKET_SIZE, count - first);
+      std::optional<Intersection> hits[PACKET_SIZE];
+      this->intersectClosest(rays + first, size, hits);
+      // Opaque hits are gathered so that their shadow rays can be traced as a packet
+      Computations computations[PACKET_SIZE];
+      Tuple points[PACKET_SIZE];
+      unsigned int lanes[PACKET_SIZE];
+      auto opaque = 0U;
+      for (auto lane = 0U; lane < size; lane++) {
+        const auto &ray = rays[first + lane];
+        if (!hits[lane].has_value()) {
+          colors[first + lane] = BLACK;
+        } else if (hits[lane]->object->material->transparency != 0.0 || !this->light) {
+          colors[first + lane] = this->colorAtHit(ray, *hits[lane], remaining);
+        } else {
+          computations[opaque] = hits[lane]->prepareComputations(ray);
+          points[opaque] = computations[opaque].overPoint;
+          lanes[opaque++] = lane;
+        }
+      }
+      bool shadowed[PACKET_SIZE];
+      if (opaque > 0) {
+        this->occluded(points, opaque, this->light->position, shadowed);
+      }
+      for (auto i = 0U; i < opaque; i++) {
+        colors[first + lanes[i]] = this->shadeHit(computations[i], remaining, shadowed[i]);
+      }
+    }
+  }
+  Color World::colorAtHit(const Ray &ray, const Intersection &hit, int remaining) {
+    if (hit.object->material->transparency == 0.0) {
+      return shadeHit(hit.prepareComputations(ray), remaining);
+    }
+    // Refractive indices depend on every surface the ray has crossed, so
+    // transparent hits still need the full list of intersections. The list is
+    // reused by every transparent hit on this thread, which is safe as it is
+    // consumed before shadeHit recurses.
+    thread_local auto intersections = Intersections();
+    intersections.clear();
+    this->intersect(ray, intersections);
+    auto computations = hit.prepareComputations(ray, intersections);
+    return shadeHit(computations, remaining);
   }
   Color World::reflectedColorAt(const Computations &computations, int remaining) {
     if (computations.object->material->reflective == 0.0 || remaining == 0) {
@@ -71,14 +240,50 @@ namespace raytracerchallenge {
     auto color = colorAt(refractRay, remaining - 1) * computations.object->material->transparency;
     return color;
   }
-  bool World::isShadowed(Tuple point) {
-    auto distance = (light->position - point).magnitude();
-    auto direction = (light->position - point).normalize();
-    auto ray = Ray(point, direction);
-    auto hit = intersect(ray).hit();
-    if (hit.has_value() && hit.value().t < distance && hit.value().object->material->castShadow) {
+  bool World::occluded(Tuple point, Tuple target) {
+    this->buildIfStale();
+    // The direction is left unnormalized so the segment spans t in [0, 1)
+    auto ray = Ray(point, target - point);
+    if (this->accelerator->localIntersectsAny(ray, 0.0, 1.0)) {
       return true;
     }
-    return false;
+    return std::any_of(this->unbounded.cbegin(), this->unbounded.cend(),
+                       [&ray](const auto &object) { return object->intersectsAny(ray, 0.0, 1.0); });
+  }
+  void World::occluded(const Tuple *points, unsigned int count, Tuple target, bool *blocked) {
+    this->buildIfStale();
+    // Only a LinearBVH traces the segments as packets, as in intersectClosest
+    auto *bvh = dynamic_cast<LinearBVH *>(this->accelerator.get());
+    // Reused by every batch on this thread, as shadow tests never shade and so never re-enter
+    thread_local std::vector<Ray> rays;
+    for (auto first = 0U; first < count; first += PACKET_SIZE) {
+      auto size = std::min(PACKET_SIZE, count - first);
+      rays.clear();
+      for (auto lane = 0U; lane < size; lane++) {
+        rays.emplace_back(points[first + lane], target - points[first + lane]);
+      }
+      auto found = 0U;
+      if (bvh != nullptr && size > 1) {
+        found = size <= 4   ? blockedInPacket<4>(*bvh, rays.data(), size)
+                : size <= 8 ? blockedInPacket<8>(*bvh, rays.data(), size)
+                            : blockedInPacket<16>(*bvh, rays.data(), size);
+      } else {
+        for (auto lane = 0U; lane < size; lane++) {
+          if (this->accelerator->localIntersectsAny(rays[lane], 0.0, 1.0)) {
+            found |= 1U << lane;
+          }
+        }
+      }
+      for (auto lane = 0U; lane < size; lane++) {
+        const auto &ray = rays[lane];
+        blocked[first + lane]
+            = (found & (1U << lane)) != 0
+              || std::any_of(this->unbounded.cbegin(), this->unbounded.cend(),
+                             [&ray](const auto &object) {
+                               return object->intersectsAny(ray, 0.0, 1.0);
+                             });
+      }
+    }
   }
+  bool World::isShadowed(Tuple point) { return this->occluded(point, this->light->position); }
 }  // namespace raytracerchallenge
\ No newline at end of file
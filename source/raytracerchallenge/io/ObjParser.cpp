@@ -1,31 +1,68 @@
 #include <raytracerchallenge/io/ObjParser.h>
 #include <raytracerchallenge/shapes/SmoothTriangle.h>
 #include <raytracerchallenge/shapes/Triangle.h>
+#include <raytracerchallenge/shapes/TriangleMesh.h>
 
 #include <iostream>
+#include <map>
 #include <regex>
 
 namespace raytracerchallenge {
-  std::vector<std::shared_ptr<Shape>> fanTriangulation(std::vector<Tuple> vertices) {
+  std::vector<std::shared_ptr<Shape>> fanTriangulation(std::vector<Tuple> vertices,
+                                                       bool watertight) {
     auto triangles = std::vector<std::shared_ptr<Shape>>();
     for (int index = 2; index < int(vertices.size()) - 1; ++index) {
       auto tri = Triangle::create(vertices[1], vertices[index], vertices[index + 1]);
+      std::dynamic_pointer_cast<Triangle>(tri)->watertight = watertight;
       triangles.push_back(tri);
     }
     return triangles;
   }
   std::vector<std::shared_ptr<Shape>> fanTriangulation(std::vector<Tuple> vertices,
-                                                       std::vector<Tuple> normals) {
+                                                       std::vector<Tuple> normals,
+                                                       bool watertight) {
     auto triangles = std::vector<std::shared_ptr<Shape>>();
     for (int index = 2; index < int(vertices.size()) - 1; ++index) {
       auto tri = SmoothTriangle::create(vertices[1], vertices[index], vertices[index + 1],
                                         normals[1], normals[index], normals[index + 1]);
+      std::dynamic_pointer_cast<Triangle>(tri)->watertight = watertight;
       triangles.push_back(tri);
     }
     return triangles;
   }
-  ObjParser ObjParser::parse(std::stringstream &lines) {
+  /**
+   * @brief Faces of one group waiting to be built into TriangleMeshes, as
+   * three indices per triangle
+   */
+  struct ObjMeshFaces {
+    std::vector<std::uint32_t> flat;
+    std::vector<std::uint32_t> smooth;
+    std::vector<std::uint32_t> smoothNormals;
+  };
+  void addFan(std::vector<std::uint32_t> &triangles, const std::vector<std::uint32_t> &polygon) {
+    for (size_t index = 1; index + 1 < polygon.size(); ++index) {
+      triangles.insert(triangles.end(), {polygon[0], polygon[index], polygon[index + 1]});
+    }
+  }
+  std::shared_ptr<Group> objGroup(ObjParser &parser, const std::string &name) {
+    if (name.empty()) {
+      return std::dynamic_pointer_cast<Group>(parser.defaultGroup);
+    }
+    if (!parser.groups.count(name)) {
+      parser.groups[name] = Group::create();
+    }
+    return std::dynamic_pointer_cast<Group>(parser.groups[name]);
+  }
+  std::shared_ptr<const TupleArrays> objArrays(const std::vector<Tuple> &tuples) {
+    auto arrays = std::make_shared<TupleArrays>();
+    for (const auto &tuple : tuples) {
+      arrays->add(tuple);
+    }
+    return arrays;
+  }
+  ObjParser ObjParser::parse(std::stringstream &lines, const ObjParserOptions &options) {
     auto parser = ObjParser();
+    std::map<std::string, ObjMeshFaces> meshFaces;
     parser.vertices.emplace_back();
     parser.normals.emplace_back();
     std::string oneLine;
@@ -52,43 +89,31 @@ namespace raytracerchallenge {
         auto n3 = std::stod(subMatch.str(6));
         parser.normals.push_back(Tuple::vector(n1, n2, n3));
       } else if (std::regex_match(oneLine, subMatch, faceLinePattern)) {
-        auto bounds = BoundingBox();
-        for (auto vert : parser.vertices) {
-          bounds.add(vert);
-        }
-        auto sx = bounds.max.x - bounds.min.x;
-        auto sy = bounds.max.y - bounds.min.y;
-        auto sz = bounds.max.z - bounds.min.z;
-        auto scale = std::max({sx, sy, sz}) / 2;
-        for (auto vert : parser.vertices) {
-          vert.x = (vert.x - (bounds.min.x + sx / 2)) / scale;
-          vert.y = (vert.y - (bounds.min.y + sy / 2)) / scale;
-          vert.z = (vert.z - (bounds.min.z + sz / 2)) / scale;
-        }
         auto indices = subMatch.str(2);
         std::stringstream ss(indices);
         std::string s;
         std::vector<Tuple> targetVertices;
+        std::vector<std::uint32_t> polygon;
         targetVertices.emplace_back();
         while (std::getline(ss, s, ' ')) {
           targetVertices.push_back(parser.vertices[std::stoi(s)]);
+          polygon.push_back(std::uint32_t(std::stoi(s)));
         }
-        auto triangles = fanTriangulation(targetVertices);
+        if (options.triangleMeshes) {
+          addFan(meshFaces[lastMentionedGroup].flat, polygon);
+          continue;
+        }
+        auto triangles = fanTriangulation(targetVertices, options.watertight);
         for (const auto &triangle : triangles) {
-          if (lastMentionedGroup.empty()) {
-            std::dynamic_pointer_cast<Group>(parser.defaultGroup)->add(triangle);
-          } else {
-            if (!parser.groups.count(lastMentionedGroup)) {
-              parser.groups[lastMentionedGroup] = Group::create();
-            }
-            std::dynamic_pointer_cast<Group>(parser.groups[lastMentionedGroup])->add(triangle);
-          }
+          objGroup(parser, lastMentionedGroup)->add(triangle);
         }
       } else if (std::regex_match(oneLine, faceLinePatternWithNormals)) {
         std::stringstream ss(oneLine);
         std::string s;
         std::vector<Tuple> targetVertices;
         std::vector<Tuple> targetNormals;
+        std::vector<std::uint32_t> polygon;
+        std::vector<std::uint32_t> polygonNormals;
         targetVertices.emplace_back();
         targetNormals.emplace_back();
         while (std::getline(ss, s, ' ')) {
@@ -97,25 +122,49 @@ namespace raytracerchallenge {
           }
           auto firstSlashIndex = s.find('/');
           auto lastSlashIndex = s.rfind('/');
-          targetVertices.push_back(parser.vertices[std::stoi(s.substr(0, firstSlashIndex))]);
-          targetNormals.push_back(
-              parser.normals[stoi(s.substr(lastSlashIndex + 1, s.size() - lastSlashIndex - 1))]);
+          auto vertex = std::stoi(s.substr(0, firstSlashIndex));
+          auto normal = stoi(s.substr(lastSlashIndex + 1, s.size() - lastSlashIndex - 1));
+          targetVertices.push_back(parser.vertices[vertex]);
+          targetNormals.push_back(parser.normals[normal]);
+          polygon.push_back(std::uint32_t(vertex));
+          polygonNormals.push_back(std::uint32_t(normal));
+        }
+        if (options.triangleMeshes) {
+          addFan(meshFaces[lastMentionedGroup].smooth, polygon);
+          addFan(meshFaces[lastMentionedGroup].smoothNormals, polygonNormals);
+          continue;
         }
-        auto triangles = fanTriangulation(targetVertices, targetNormals);
+        auto triangles = fanTriangulation(targetVertices, targetNormals, options.watertight);
         for (const auto &triangle : triangles) {
-          if (lastMentionedGroup.empty()) {
-            std::dynamic_pointer_cast<Group>(parser.defaultGroup)->add(triangle);
-          } else {
-            if (!parser.groups.count(lastMentionedGroup)) {
-              parser.groups[lastMentionedGroup] = Group::create();
-            }
-            std::dynamic_pointer_cast<Group>(parser.groups[lastMentionedGroup])->add(triangle);
-          }
+          objGroup(parser, lastMentionedGroup)->add(triangle);
         }
       } else {
         std::cout << "Skipped line: " << oneLine << std::endl;
       }
     }
+    if (meshFaces.empty()) {
+      return parser;
+    }
+    // Every mesh indexes the same arrays, which keep the unused first entry so OBJ indices apply
+    auto vertices = objArrays(parser.vertices);
+    auto normals = objArrays(parser.normals);
+    for (auto &[name, faces] : meshFaces) {
+      auto group = objGroup(parser, name);
+      std::vector<std::shared_ptr<Shape>> meshes;
+      if (!faces.flat.empty()) {
+        meshes.push_back(
+            TriangleMesh::create(vertices, std::move(faces.flat), options.meshOptions));
+      }
+      if (!faces.smooth.empty()) {
+        meshes.push_back(TriangleMesh::create(vertices, std::move(faces.smooth), normals,
+                                              std::move(faces.smoothNormals),
+                                              options.meshOptions));
+      }
+      for (const auto &mesh : meshes) {
+        std::dynamic_pointer_cast<TriangleMesh>(mesh)->watertight = options.watertight;
+        group->add(mesh);
+      }
+    }
     return parser;
   }
   std::shared_ptr<Shape> ObjParser::getObjects() {
@@ -5,8 +5,8 @@ namespace raytracerchallenge {
     this->a = a;
     this->b = b;
   }
-  Color CheckersPattern::colorAt(std::shared_ptr<Shape> shape, Tuple point) {
-    auto objectPoint = shape->transform.inverse() * point;
+  Color CheckersPattern::colorAt(const Shape &shape, Tuple point) {
+    auto objectPoint = shape.transform.inverse() * point;
     auto patternPoint = this->transform.inverse() * objectPoint;
     auto vectorSum = int(floor(patternPoint.x) + floor(patternPoint.y) + floor(patternPoint.z));
     if (vectorSum % 2 == 0) {
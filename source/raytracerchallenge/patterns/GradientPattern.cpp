@@ -5,8 +5,8 @@ namespace raytracerchallenge {
     this->a = a;
     this->b = b;
   }
-  Color GradientPattern::colorAt(std::shared_ptr<Shape> shape, Tuple point) {
-    auto objectPoint = shape->transform.inverse() * point;
+  Color GradientPattern::colorAt(const Shape &shape, Tuple point) {
+    auto objectPoint = shape.transform.inverse() * point;
     auto patternPoint = this->transform.inverse() * objectPoint;
     auto distance = this->b - this->a;
     auto fraction = patternPoint.x - floor(patternPoint.x);
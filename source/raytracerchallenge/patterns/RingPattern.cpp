@@ -5,8 +5,8 @@ namespace raytracerchallenge {
     this->a = a;
     this->b = b;
   }
-  Color RingPattern::colorAt(std::shared_ptr<Shape> shape, Tuple point) {
-    auto objectPoint = shape->transform.inverse() * point;
+  Color RingPattern::colorAt(const Shape &shape, Tuple point) {
+    auto objectPoint = shape.transform.inverse() * point;
     auto patternPoint = this->transform.inverse() * objectPoint;
     auto xSquared = pow(patternPoint.x, 2);
     auto zSquared = pow(patternPoint.z, 2);
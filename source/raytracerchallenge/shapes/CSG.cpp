@@ -13,15 +13,16 @@ namespace raytracerchallenge {
     box.add(this->right->parentSpaceBounds());
     return box;
   }
-  Intersections CSG::localIntersect(Ray ray) {
-    auto xs = Intersections();
+  void CSG::localIntersect(const Ray &ray, Intersections &xs) {
     if (!this->bounds().intersects(ray)) {
-      return xs;
+      return;
     }
-    xs.addAll(this->left->intersect(ray));
-    xs.addAll(this->right->intersect(ray));
-    xs.sort();
-    return filterIntersections(xs);
+    // Filtering needs the children's intersections on their own and in order
+    auto children = Intersections();
+    this->left->intersect(ray, children);
+    this->right->intersect(ray, children);
+    children.sort();
+    xs.addAll(filterIntersections(children));
   }
   bool CSG::intersectionAllowed(CSG::Operation op, bool leftHit, bool inLeft, bool inRight) {
     switch (op) {
@@ -39,10 +40,10 @@ namespace raytracerchallenge {
     bool inLeft = false;
     bool inRight = false;
     auto result = Intersections();
-    for (const auto &intersection : intersections.intersections) {
+    for (const auto &intersection : intersections) {
       auto lhit = this->left->includes(*intersection.object);
       if (intersectionAllowed(this->operation, lhit, inLeft, inRight)) {
-        result.intersections.push_back(intersection);
+        result.add(intersection);
       }
       if (lhit) {
         inLeft = !inLeft;
@@ -59,4 +60,18 @@ namespace raytracerchallenge {
     this->left->divide(threshold);
     this->right->divide(threshold);
   }
+  void CSG::divide(const BVHOptions &options) {
+    this->left->divide(options);
+    this->right->divide(options);
+  }
+  void CSG::freeze() {
+    this->freezeTransform();
+    this->left->freeze();
+    this->right->freeze();
+  }
+  void CSG::thaw() {
+    Shape::thaw();
+    this->left->thaw();
+    this->right->thaw();
+  }
 }  // namespace raytracerchallenge
\ No newline at end of file
@@ -3,35 +3,34 @@
 #include <raytracerchallenge/shapes/Cube.h>
 
 namespace raytracerchallenge {
-  std::array<double, 2> checkAxis(double origin, double direction, double min = -1.0,
-                                  double max = 1.0) {
-    auto tminNumerator = (min - origin);
-    auto tmaxNumerator = (max - origin);
-    double tmin;
-    double tmax;
-    if (abs(direction) >= EPS) {
-      tmin = tminNumerator / direction;
-      tmax = tmaxNumerator / direction;
-    } else {
-      tmin = tminNumerator * INFINITY;
-      tmax = tmaxNumerator * INFINITY;
-    }
-    if (tmin > tmax) {
-      std::swap(tmin, tmax);
-    }
-    return {tmin, tmax};
+  /**
+   * @brief Return the distances at which a ray enters and leaves the unit cube
+   */
+  std::array<Scalar, 2> cubeSlabs(const Ray &ray) {
+    static const auto box
+        = BoundingBox(Tuple::point(-1.0, -1.0, -1.0), Tuple::point(1.0, 1.0, 1.0));
+    auto tMin = Scalar(-INFINITY);
+    auto tMax = Scalar(INFINITY);
+    box.clip(ray, tMin, tMax);
+    return {tMin, tMax};
   }
-  Intersections Cube::localIntersect(Ray ray) {
-    auto xMinMax = checkAxis(ray.origin.x, ray.direction.x);
-    auto yMinMax = checkAxis(ray.origin.y, ray.direction.y);
-    auto zMinMax = checkAxis(ray.origin.z, ray.direction.z);
-    auto tMin = std::max({xMinMax[0], yMinMax[0], zMinMax[0]});
-    auto tMax = std::min({xMinMax[1], yMinMax[1], zMinMax[1]});
+  void Cube::localIntersect(const Ray &ray, Intersections &xs) {
+    auto [tMin, tMax] = cubeSlabs(ray);
     if (tMin > tMax) {
-      return {};
+      return;
+    }
+    xs.add(Intersection(tMin, this));
+    xs.add(Intersection(tMax, this));
+  }
+  bool Cube::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    if (!this->material->castShadow) {
+      return false;
+    }
+    auto [near, far] = cubeSlabs(ray);
+    if (near > far) {
+      return false;
     }
-    return Intersections(std::vector<Intersection>{Intersection(tMin, this->sharedPtr),
-                                                   Intersection(tMax, this->sharedPtr)});
+    return (near >= tMin && near < tMax) || (far >= tMin && far < tMax);
   }
   Tuple Cube::localNormalAt(Tuple point, Intersection hit) {
     (void)hit;
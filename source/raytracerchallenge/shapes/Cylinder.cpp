@@ -2,10 +2,16 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Cylinder.h>
 
+#include <cmath>
+#include <type_traits>
+
 namespace raytracerchallenge {
+  /* Distance beyond the rim at which single precision still accepts a point on a cap, allowing
+     for rounding in rays aimed at the rim; double precision keeps the exact test */
+  constexpr Scalar CAP_RIM_SLACK = std::is_same_v<Scalar, float> ? EPS : Scalar(0);
   Tuple Cylinder::localNormalAt(Tuple point, Intersection hit) {
     (void)hit;
-    auto dist = pow(point.x, 2.0) + pow(point.z, 2.0);
+    auto dist = point.x * point.x + point.z * point.z;
     if (dist < 1.0 && point.y >= this->maximum - EPS) {
       return {0.0, 1.0, 0.0, 0.0};
     } else if (dist < 1.0 && point.y <= this->minimum + EPS) {
@@ -13,48 +19,46 @@ namespace raytracerchallenge {
     }
     return {point.x, 0.0, point.z, 0.0};
   }
-  bool checkCap(Ray ray, double t, double capRadius = 1.0) {
+  bool checkCap(Ray ray, Scalar t, Scalar capRadius = 1.0) {
     auto x = ray.origin.x + t * ray.direction.x;
     auto z = ray.origin.z + t * ray.direction.z;
-    return (pow(x, 2) + pow(z, 2)) <= capRadius;
+    return x * x + z * z <= capRadius + CAP_RIM_SLACK;
   }
-  void intersectCaps(Cylinder &cyl, Ray ray, Intersections &xs) {
-    if (!cyl.closed || abs(ray.direction.y) < EPS) {
+  void intersectCaps(Cylinder &cyl, const Ray &ray, Intersections &xs) {
+    if (!cyl.closed || std::abs(ray.direction.y) < EPS) {
       return;
     }
     auto t = (cyl.minimum - ray.origin.y) / ray.direction.y;
     if (checkCap(ray, t)) {
-      xs.intersections.emplace_back(t, cyl.sharedPtr);
+      xs.add(Intersection(t, &cyl));
     }
     t = (cyl.maximum - ray.origin.y) / ray.direction.y;
     if (checkCap(ray, t)) {
-      xs.intersections.emplace_back(t, cyl.sharedPtr);
+      xs.add(Intersection(t, &cyl));
     }
   }
-  Intersections Cylinder::localIntersect(Ray ray) {
-    auto a = pow(ray.direction.x, 2) + pow(ray.direction.z, 2);
+  void Cylinder::localIntersect(const Ray &ray, Intersections &xs) {
+    auto a = ray.direction.x * ray.direction.x + ray.direction.z * ray.direction.z;
     auto b = 2 * ray.origin.x * ray.direction.x + 2 * ray.origin.z * ray.direction.z;
-    auto c = pow(ray.origin.x, 2) + pow(ray.origin.z, 2) - 1.0;
-    auto disc = pow(b, 2) - 4.0 * a * c;
+    auto c = ray.origin.x * ray.origin.x + ray.origin.z * ray.origin.z - 1;
+    auto disc = b * b - 4 * a * c;
     if (disc < 0) {
-      return {};
+      return;
     }
-    auto t0 = (-b - sqrt(disc)) / (2.0 * a);
-    auto t1 = (-b + sqrt(disc)) / (2.0 * a);
+    auto t0 = (-b - std::sqrt(disc)) / (2 * a);
+    auto t1 = (-b + std::sqrt(disc)) / (2 * a);
     if (t0 > t1) {
       std::swap(t0, t1);
     }
-    auto xs = Intersections();
     auto y0 = ray.origin.y + t0 * ray.direction.y;
     if (this->minimum < y0 && y0 < this->maximum) {
-      xs.intersections.emplace_back(t0, this->sharedPtr);
+      xs.add(Intersection(t0, this));
     }
     auto y1 = ray.origin.y + t1 * ray.direction.y;
     if (this->minimum < y1 && y1 < this->maximum) {
-      xs.intersections.emplace_back(t1, this->sharedPtr);
+      xs.add(Intersection(t1, this));
     }
     intersectCaps(*this, ray, xs);
-    return xs;
   }
   BoundingBox Cylinder::bounds() {
     if (this->closed) {
@@ -1,14 +1,30 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Group.h>
 
+#include <chrono>
+#include <cmath>
+
 namespace raytracerchallenge {
   void Group::add(const std::shared_ptr<Shape>& object) {
     object->parent = this->sharedPtr;
+    object->thaw();
     object->setMaterial(material);
     this->objects.push_back(object);
     auto cbox = object->parentSpaceBounds();
     this->currentBounds.add(cbox);
   }
+  void Group::freeze() {
+    this->freezeTransform();
+    for (const auto& object : this->objects) {
+      object->freeze();
+    }
+  }
+  void Group::thaw() {
+    Shape::thaw();
+    for (const auto& object : this->objects) {
+      object->thaw();
+    }
+  }
   void Group::setMaterial(std::shared_ptr<Material>& newMaterial) {
     this->material = newMaterial;
     for (const auto& obj : this->objects) {
@@ -24,16 +40,35 @@ namespace raytracerchallenge {
     (void)point;
     return {};
   }
-  Intersections Group::localIntersect(Ray ray) {
-    auto xs = Intersections();
+  void Group::localIntersect(const Ray& ray, Intersections& xs) {
     if (!this->bounds().intersects(ray)) {
-      return xs;
+      return;
+    }
+    auto first = xs.size();
+    for (auto& object : this->objects) {
+      object->intersect(ray, xs);
     }
+    xs.sort(first);
+  }
+  bool Group::localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax, Intersection& closest) {
+    if (!this->bounds().intersects(ray, tMin, tMax)) {
+      return false;
+    }
+    auto found = false;
     for (auto& object : this->objects) {
-      xs.addAll(object->intersect(ray));
+      if (object->intersectClosest(ray, tMin, tMax, closest)) {
+        tMax = closest.t;
+        found = true;
+      }
     }
-    xs.sort();
-    return xs;
+    return found;
+  }
+  bool Group::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    if (!this->bounds().intersects(ray, tMin, tMax)) {
+      return false;
+    }
+    return std::any_of(this->objects.cbegin(), this->objects.cend(),
+                       [&](const auto& object) { return object->intersectsAny(ray, tMin, tMax); });
   }
   BoundingBox Group::bounds() { return currentBounds; }
   bool Group::includes(const Shape& object) const {
@@ -78,4 +113,118 @@ namespace raytracerchallenge {
       shape->divide(threshold);
     }
   }
+  void Group::adopt(const std::shared_ptr<Shape>& object, const BoundingBox& box) {
+    object->parent = this->sharedPtr;
+    this->objects.push_back(object);
+    this->currentBounds.add(box);
+  }
+  std::shared_ptr<Shape> Group::makeNode(const BVHBuildNode& node,
+                                         const std::vector<std::shared_ptr<Shape>>& shapes,
+                                         const std::vector<size_t>& order) {
+    if (node.isLeaf() && node.count == 1) {
+      return shapes[order[node.first]];
+    }
+    auto group = new Group();
+    group->material = this->material;
+    group->hierarchyNode = true;
+    if (node.isLeaf()) {
+      for (auto i = node.first; i < node.first + node.count; i++) {
+        auto shape = shapes[order[i]];
+        group->adopt(shape, shape->parentSpaceBounds());
+      }
+    } else {
+      group->adopt(this->makeNode(*node.left, shapes, order), node.left->bounds);
+      group->adopt(this->makeNode(*node.right, shapes, order), node.right->bounds);
+    }
+    return group->sharedPtr;
+  }
+  void Group::divide(const BVHOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& shape : this->objects) {
+      shape->divide(options);
+    }
+    this->build(options);
+    this->buildStats.buildSeconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  void Group::build(const BVHOptions& options) {
+    this->buildStats = BVHBuildStats();
+    std::vector<std::shared_ptr<Shape>> bounded;
+    std::vector<std::shared_ptr<Shape>> unbounded;
+    std::vector<BoundingBox> bounds;
+    for (const auto& shape : this->objects) {
+      auto box = shape->parentSpaceBounds();
+      if (box.isFinite()) {
+        bounded.push_back(shape);
+        bounds.push_back(box);
+      } else {
+        unbounded.push_back(shape);
+      }
+    }
+    if (bounded.size() > options.maxLeafSize) {
+      // A group cannot hold the same shape twice, so it never splits shapes in space
+      auto objectOptions = options;
+      objectOptions.spatialSplits = false;
+      auto builder = BVHBuilder(objectOptions);
+      auto root = builder.build(bounds);
+      this->buildStats = builder.stats();
+      if (!root->isLeaf()) {
+        this->objects = unbounded;
+        this->adopt(this->makeNode(*root->left, bounded, builder.order()), root->left->bounds);
+        this->adopt(this->makeNode(*root->right, bounded, builder.order()), root->right->bounds);
+      }
+    }
+    this->built = true;
+    this->buildOptions = options;
+    this->builtCost = this->sahCost(options);
+  }
+  void Group::collect(std::vector<std::shared_ptr<Shape>>& shapes) const {
+    for (const auto& object : this->objects) {
+      auto group = std::dynamic_pointer_cast<Group>(object);
+      if (group != nullptr && group->hierarchyNode) {
+        group->collect(shapes);
+      } else {
+        shapes.push_back(object);
+      }
+    }
+  }
+  void Group::refit() {
+    for (const auto& object : this->objects) {
+      object->refit();
+    }
+    this->currentBounds = BoundingBox();
+    for (const auto& object : this->objects) {
+      this->currentBounds.add(object->parentSpaceBounds());
+    }
+    if (!this->built
+        || this->sahCost(this->buildOptions)
+               <= this->buildOptions.rebuildThreshold * this->builtCost) {
+      return;
+    }
+    std::vector<std::shared_ptr<Shape>> shapes;
+    this->collect(shapes);
+    this->objects.clear();
+    this->currentBounds = BoundingBox();
+    for (const auto& shape : shapes) {
+      this->adopt(shape, shape->parentSpaceBounds());
+    }
+    this->build(this->buildOptions);
+  }
+  double Group::sahCost(const BVHOptions& options) {
+    return this->nodeCost(this->bounds().surfaceArea(), options);
+  }
+  double Group::nodeCost(double rootArea, const BVHOptions& options) {
+    auto finite = rootArea > 0.0 && std::isfinite(rootArea);
+    auto probability = finite ? this->bounds().surfaceArea() / rootArea : 1.0;
+    auto cost = probability * options.traversalCost;
+    for (const auto& object : this->objects) {
+      auto group = std::dynamic_pointer_cast<Group>(object);
+      if (group != nullptr && group->hierarchyNode) {
+        cost += group->nodeCost(rootArea, options);
+      } else {
+        cost += probability * options.intersectionCost;
+      }
+    }
+    return cost;
+  }
 }  // namespace raytracerchallenge
\ No newline at end of file
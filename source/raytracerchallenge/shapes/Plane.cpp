@@ -3,18 +3,27 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Plane.h>
 
+#include <cmath>
+
 namespace raytracerchallenge {
   Tuple Plane::localNormalAt(Tuple point, Intersection hit) {
     (void)point;
     (void)hit;
     return Tuple::vector(0.0, 1.0, 0.0);
   }
-  Intersections Plane::localIntersect(Ray ray) {
-    if (abs(ray.direction.y) < EPS) {
-      return {};
+  void Plane::localIntersect(const Ray &ray, Intersections &xs) {
+    if (std::abs(ray.direction.y) < EPS) {
+      return;
+    }
+    auto t = -ray.origin.y / ray.direction.y;
+    xs.add(Intersection(t, this));
+  }
+  bool Plane::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    if (!this->material->castShadow || std::abs(ray.direction.y) < EPS) {
+      return false;
     }
     auto t = -ray.origin.y / ray.direction.y;
-    return Intersections({Intersection(t, this->sharedPtr)});
+    return t >= tMin && t < tMax;
   }
   BoundingBox Plane::bounds() {
     return {Tuple(NEGATIVE_INFINITY, 0.0, NEGATIVE_INFINITY, 1.0),
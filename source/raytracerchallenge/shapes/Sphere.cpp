@@ -4,24 +4,42 @@
 #include <raytracerchallenge/base/Ray.h>
 #include <raytracerchallenge/shapes/Sphere.h>
 
+#include <cmath>
+
 namespace raytracerchallenge {
   Tuple Sphere::localNormalAt(Tuple point, Intersection hit) {
     (void)hit;
     return point - Tuple::point(0.0, 0.0, 0.0);
   }
-  Intersections Sphere::localIntersect(Ray ray) {
+  void Sphere::localIntersect(const Ray &ray, Intersections &xs) {
+    Tuple sphereToRay = ray.origin - Tuple::point(0.0, 0.0, 0.0);
+    Scalar a = ray.direction.dot(ray.direction);
+    Scalar b = 2 * ray.direction.dot(sphereToRay);
+    Scalar c = sphereToRay.dot(sphereToRay) - 1;
+    Scalar discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) {
+      return;
+    }
+    Scalar t1 = (-b - std::sqrt(discriminant)) / (2 * a);
+    Scalar t2 = (-b + std::sqrt(discriminant)) / (2 * a);
+    xs.add(Intersection(t1, this));
+    xs.add(Intersection(t2, this));
+  }
+  bool Sphere::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    if (!this->material->castShadow) {
+      return false;
+    }
     Tuple sphereToRay = ray.origin - Tuple::point(0.0, 0.0, 0.0);
-    double a = ray.direction.dot(ray.direction);
-    double b = 2.0 * ray.direction.dot(sphereToRay);
-    double c = sphereToRay.dot(sphereToRay) - 1.0;
-    double discriminant = pow(b, 2.0) - 4.0 * a * c;
-    if (discriminant < 0.0) {
-      return Intersections(std::vector<Intersection>(0));
+    Scalar a = ray.direction.dot(ray.direction);
+    Scalar b = 2 * ray.direction.dot(sphereToRay);
+    Scalar c = sphereToRay.dot(sphereToRay) - 1;
+    Scalar discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) {
+      return false;
     }
-    double t1 = (-b - sqrt(discriminant)) / (2.0 * a);
-    double t2 = (-b + sqrt(discriminant)) / (2.0 * a);
-    return Intersections(std::vector<Intersection>{Intersection(t1, this->sharedPtr),
-                                                   Intersection(t2, this->sharedPtr)});
+    Scalar t1 = (-b - std::sqrt(discriminant)) / (2 * a);
+    Scalar t2 = (-b + std::sqrt(discriminant)) / (2 * a);
+    return (t1 >= tMin && t1 < tMax) || (t2 >= tMin && t2 < tMax);
   }
   BoundingBox Sphere::bounds() { return {{-1.0, -1.0, -1.0, 1.0}, {1.0, 1.0, 1.0, 1.0}}; }
 }  // namespace raytracerchallenge
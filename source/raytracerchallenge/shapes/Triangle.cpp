@@ -2,34 +2,150 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Triangle.h>
 
+#include <cmath>
+#include <utility>
+
 namespace raytracerchallenge {
+  Scalar component(const Tuple &tuple, int axis) {
+    return axis == 0 ? tuple.x : (axis == 1 ? tuple.y : tuple.z);
+  }
+  /**
+   * a * b - c * d to within 1.5 units in the last place (Kahan's algorithm),
+   * so that its sign is exact. Unlike computing in long double, which is no
+   * wider than double on some compilers, this holds on every platform.
+   */
+  Scalar differenceOfProducts(Scalar a, Scalar b, Scalar c, Scalar d) {
+    auto cd = c * d;
+    auto error = std::fma(-c, d, cd);
+    return std::fma(a, b, -cd) + error;
+  }
+  WatertightRay::WatertightRay(const Ray &ray) : origin(ray.origin) {
+    auto x = std::abs(ray.direction.x);
+    auto y = std::abs(ray.direction.y);
+    auto z = std::abs(ray.direction.z);
+    this->kz = x > y ? (x > z ? 0 : 2) : (y > z ? 1 : 2);
+    this->kx = (this->kz + 1) % 3;
+    this->ky = (this->kx + 1) % 3;
+    // Keep the winding of the sheared triangle independent of the direction's sign
+    if (component(ray.direction, this->kz) < 0.0) {
+      std::swap(this->kx, this->ky);
+    }
+    auto dz = component(ray.direction, this->kz);
+    this->sx = component(ray.direction, this->kx) / dz;
+    this->sy = component(ray.direction, this->ky) / dz;
+    this->sz = Scalar(1) / dz;
+  }
+  bool Triangle::intersectWatertight(const WatertightRay &ray, const Tuple &p1, const Tuple &p2,
+                                     const Tuple &p3, Scalar &t, Scalar &u, Scalar &v) {
+    auto a = p1 - ray.origin;
+    auto b = p2 - ray.origin;
+    auto c = p3 - ray.origin;
+    auto ax = component(a, ray.kx) - ray.sx * component(a, ray.kz);
+    auto ay = component(a, ray.ky) - ray.sy * component(a, ray.kz);
+    auto bx = component(b, ray.kx) - ray.sx * component(b, ray.kz);
+    auto by = component(b, ray.ky) - ray.sy * component(b, ray.kz);
+    auto cx = component(c, ray.kx) - ray.sx * component(c, ray.kz);
+    auto cy = component(c, ray.ky) - ray.sy * component(c, ray.kz);
+    // Edge tests opposite p1, p2 and p3, which are proportional to their barycentric weights
+    auto w1 = cx * by - cy * bx;
+    auto w2 = ax * cy - ay * cx;
+    auto w3 = bx * ay - by * ax;
+    if (w1 == 0.0 || w2 == 0.0 || w3 == 0.0) {
+      // A zero may be rounding, so the sign of each edge is settled exactly
+      w1 = differenceOfProducts(cx, by, cy, bx);
+      w2 = differenceOfProducts(ax, cy, ay, cx);
+      w3 = differenceOfProducts(bx, ay, by, ax);
+    }
+    if ((w1 < 0.0 || w2 < 0.0 || w3 < 0.0) && (w1 > 0.0 || w2 > 0.0 || w3 > 0.0)) {
+      return false;
+    }
+    auto det = w1 + w2 + w3;
+    if (det == 0.0) {
+      return false;
+    }
+    auto az = ray.sz * component(a, ray.kz);
+    auto bz = ray.sz * component(b, ray.kz);
+    auto cz = ray.sz * component(c, ray.kz);
+    auto inverse = Scalar(1) / det;
+    t = (w1 * az + w2 * bz + w3 * cz) * inverse;
+    u = w2 * inverse;
+    v = w3 * inverse;
+    return true;
+  }
   Tuple Triangle::localNormalAt(Tuple point, Intersection hit) {
     (void)point;
     (void)hit;
     return this->normal;
   }
-  Intersections Triangle::localIntersect(Ray ray) {
+  bool Triangle::intersectTriangle(const Ray &ray, Scalar &t, Scalar &u, Scalar &v) const {
+    if (this->watertight) {
+      return intersectWatertight(WatertightRay(ray), this->p1, this->p2, this->p3, t, u, v);
+    }
     auto dirCrossE2 = ray.direction.cross(this->e2);
     auto det = this->e1.dot(dirCrossE2);
-    if (abs(det) < 0.0) {
-      return {};
+    if (det == 0.0) {
+      return false;
     }
-    auto f = 1.0 / det;
+    auto f = Scalar(1) / det;
     auto p1ToOrigin = ray.origin - this->p1;
-    auto u = f * p1ToOrigin.dot(dirCrossE2);
+    u = f * p1ToOrigin.dot(dirCrossE2);
     if (u <= 0.0 || u > 1.0) {
-      return {};
+      return false;
     }
     auto originCrossE1 = p1ToOrigin.cross(this->e1);
-    auto v = f * ray.direction.dot(originCrossE1);
+    v = f * ray.direction.dot(originCrossE1);
     if (v <= 0.0 || (u + v) > 1.0) {
-      return {};
+      return false;
+    }
+    t = f * this->e2.dot(originCrossE1);
+    return true;
+  }
+  void Triangle::localIntersect(const Ray &ray, Intersections &xs) {
+    auto i = Intersection(0.0, this);
+    if (this->intersectTriangle(ray, i.t, i.u, i.v)) {
+      xs.add(i);
+    }
+  }
+  bool Triangle::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    Scalar t;
+    Scalar u;
+    Scalar v;
+    if (!this->material->castShadow || !this->intersectTriangle(ray, t, u, v)) {
+      return false;
+    }
+    return t >= tMin && t < tMax;
+  }
+  BoundingBox Triangle::clippedBounds(const BoundingBox &clip) {
+    // Clip the triangle against each face of the box in turn (Sutherland-Hodgman)
+    std::vector<Tuple> polygon
+        = {this->transform * this->p1, this->transform * this->p2, this->transform * this->p3};
+    for (auto axis = 0; axis < 3 && !polygon.empty(); axis++) {
+      for (auto side = 0; side < 2 && !polygon.empty(); side++) {
+        auto bound = side == 0 ? component(clip.min, axis) : component(clip.max, axis);
+        auto inside = [axis, side, bound](const Tuple &p) {
+          return side == 0 ? component(p, axis) >= bound : component(p, axis) <= bound;
+        };
+        std::vector<Tuple> result;
+        for (size_t i = 0; i < polygon.size(); i++) {
+          const auto &current = polygon[i];
+          const auto &next = polygon[(i + 1) % polygon.size()];
+          if (inside(current)) {
+            result.push_back(current);
+          }
+          if (inside(current) != inside(next)) {
+            auto t = (bound - component(current, axis))
+                     / (component(next, axis) - component(current, axis));
+            result.push_back(current + (next - current) * t);
+          }
+        }
+        polygon = result;
+      }
+    }
+    auto box = BoundingBox();
+    for (const auto &p : polygon) {
+      box.add(p);
     }
-    auto t = f * this->e2.dot(originCrossE1);
-    auto i = Intersection(t, this->sharedPtr);
-    i.u = u;
-    i.v = v;
-    return Intersections({i});
+    return box.clipped(clip);
   }
   BoundingBox Triangle::bounds() {
     auto b = BoundingBox();
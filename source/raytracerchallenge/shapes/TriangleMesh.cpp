@@ -0,0 +1,297 @@
+#include <raytracerchallenge/Constants.h>
+#include <raytracerchallenge/acceleration/WideBVH.h>
+#include <raytracerchallenge/base/Intersections.h>
+#include <raytracerchallenge/shapes/TriangleMesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace raytracerchallenge {
+  std::shared_ptr<Shape> TriangleMesh::create(std::shared_ptr<const TupleArrays> vertices,
+                                              std::vector<std::uint32_t> indices,
+                                              const BVHOptions &options) {
+    auto mesh = new TriangleMesh();
+    mesh->vertices = std::move(vertices);
+    mesh->indices = std::move(indices);
+    mesh->build(options);
+    return mesh->sharedPtr;
+  }
+  std::shared_ptr<Shape> TriangleMesh::create(std::shared_ptr<const TupleArrays> vertices,
+                                              std::vector<std::uint32_t> indices,
+                                              std::shared_ptr<const TupleArrays> normals,
+                                              std::vector<std::uint32_t> normalIndices,
+                                              const BVHOptions &options) {
+    auto mesh = new TriangleMesh();
+    mesh->vertices = std::move(vertices);
+    mesh->indices = std::move(indices);
+    mesh->normals = std::move(normals);
+    mesh->normalIndices = std::move(normalIndices);
+    mesh->build(options);
+    return mesh->sharedPtr;
+  }
+  size_t TriangleMesh::triangleCount() const { return this->indices.size() / 3; }
+  bool TriangleMesh::isSmooth() const { return this->normals != nullptr; }
+  unsigned int TriangleMesh::packetWidth() const { return this->packets8.empty() ? 4 : 8; }
+  void TriangleMesh::build(const BVHOptions &options) {
+    std::vector<BoundingBox> bounds;
+    bounds.reserve(this->triangleCount());
+    for (size_t i = 0; i < this->triangleCount(); i++) {
+      auto box = BoundingBox();
+      for (size_t corner = 0; corner < 3; corner++) {
+        box.add(this->vertices->point(this->indices[3 * i + corner]));
+      }
+      bounds.push_back(box);
+      this->meshBounds.add(box);
+    }
+    // Triangles are reordered so that each leaf covers a contiguous range,
+    // which rules out spatial splits as they reference a primitive twice.
+    // A packet costs about as much to test as one triangle, so leaves may
+    // grow to fill one.
+    auto width = WideBVH::supportsWidth(8) ? 8U : 4U;
+    auto leafOptions = options;
+    leafOptions.spatialSplits = false;
+    leafOptions.intersectionCost = options.intersectionCost / width;
+    leafOptions.maxLeafSize = std::min(std::max(options.maxLeafSize, width),
+                                       unsigned(std::numeric_limits<std::uint16_t>::max()));
+    auto builder = BVHBuilder(leafOptions);
+    auto root = builder.build(bounds);
+    if (root == nullptr) {
+      return;
+    }
+    const auto &order = builder.order();
+    auto reorder = [&order](const std::vector<std::uint32_t> &from) {
+      std::vector<std::uint32_t> to;
+      to.reserve(from.size());
+      for (auto triangle : order) {
+        auto first = from.begin() + long(3 * triangle);
+        to.insert(to.end(), first, first + 3);
+      }
+      return to;
+    };
+    this->indices = reorder(this->indices);
+    if (this->isSmooth()) {
+      this->normalIndices = reorder(this->normalIndices);
+    }
+    this->emit(*root, width, 1);
+  }
+  template <unsigned int Width>
+  std::uint32_t TriangleMesh::pack(std::vector<TrianglePacket<Width>> &packets, size_t first,
+                                   size_t count) {
+    auto index = std::uint32_t(packets.size());
+    for (auto packetFirst = first; packetFirst < first + count; packetFirst += Width) {
+      packets.emplace_back();
+      auto &packet = packets.back();
+      for (auto lane = 0U; lane < Width; lane++) {
+        auto triangle = packetFirst + lane;
+        if (triangle >= first + count) {
+          clearTriangleLane(packet, lane);
+          continue;
+        }
+        const auto *corners = &this->indices[3 * triangle];
+        setTriangleLane(packet, lane, this->vertices->point(corners[0]),
+                        this->vertices->point(corners[1]), this->vertices->point(corners[2]),
+                        std::uint32_t(triangle));
+      }
+    }
+    return index;
+  }
+  std::uint32_t TriangleMesh::emit(const BVHBuildNode &node, unsigned int width,
+                                   unsigned int level) {
+    this->depth = std::max(this->depth, level);
+    auto index = std::uint32_t(this->nodes.size());
+    auto packed = packNode(node.bounds);
+    packed.axis = std::uint8_t(node.axis);
+    if (node.isLeaf()) {
+      packed.offset = width == 8 ? this->pack(this->packets8, node.first, node.count)
+                                 : this->pack(this->packets4, node.first, node.count);
+      packed.count = std::uint16_t(node.count);
+      this->nodes.push_back(packed);
+      return index;
+    }
+    this->nodes.push_back(packed);
+    this->emit(*node.left, width, level + 1);
+    this->nodes[index].offset = this->emit(*node.right, width, level + 1);
+    return index;
+  }
+  std::optional<WatertightRay> TriangleMesh::shear(const Ray &ray) const {
+    if (!this->watertight) {
+      return std::nullopt;
+    }
+    return WatertightRay(ray);
+  }
+  bool TriangleMesh::intersectTriangle(std::uint32_t triangle, const Ray &ray,
+                                       const std::optional<WatertightRay> &sheared, Scalar &t,
+                                       Scalar &u, Scalar &v) const {
+    const auto *corners = &this->indices[3 * size_t(triangle)];
+    auto p1 = this->vertices->point(corners[0]);
+    if (sheared.has_value()) {
+      return Triangle::intersectWatertight(*sheared, p1, this->vertices->point(corners[1]),
+                                           this->vertices->point(corners[2]), t, u, v);
+    }
+    auto e1 = this->vertices->point(corners[1]) - p1;
+    auto e2 = this->vertices->point(corners[2]) - p1;
+    auto dirCrossE2 = ray.direction.cross(e2);
+    auto det = e1.dot(dirCrossE2);
+    if (det == 0.0) {
+      return false;
+    }
+    auto f = Scalar(1) / det;
+    auto p1ToOrigin = ray.origin - p1;
+    u = f * p1ToOrigin.dot(dirCrossE2);
+    if (u <= 0.0 || u > 1.0) {
+      return false;
+    }
+    auto originCrossE1 = p1ToOrigin.cross(e1);
+    v = f * ray.direction.dot(originCrossE1);
+    if (v <= 0.0 || (u + v) > 1.0) {
+      return false;
+    }
+    t = f * e2.dot(originCrossE1);
+    return true;
+  }
+  template <typename Visit>
+  void TriangleMesh::traverse(const Ray &ray, Scalar tMin, Scalar &tMax, Visit visit) const {
+    if (this->nodes.empty()) {
+      return;
+    }
+    auto nodeRay = NodeRay(ray);
+    std::uint32_t inlineStack[64];
+    std::vector<std::uint32_t> heapStack;
+    auto stack = inlineStack;
+    if (this->depth > 64) {
+      heapStack.resize(this->depth);
+      stack = heapStack.data();
+    }
+    auto top = 0U;
+    std::uint32_t current = 0;
+    while (true) {
+      const auto &node = this->nodes[current];
+      if (intersectsNode(node, nodeRay, tMin, tMax)) {
+        if (node.count > 0) {
+          if (visit(node.offset, std::uint32_t(node.count), tMax)) {
+            return;
+          }
+        } else if (nodeRay.sign[node.axis] != 0) {
+          stack[top++] = current + 1;
+          current = node.offset;
+          continue;
+        } else {
+          stack[top++] = node.offset;
+          current = current + 1;
+          continue;
+        }
+      }
+      if (top == 0) {
+        break;
+      }
+      current = stack[--top];
+    }
+  }
+  template <unsigned int Width, typename Candidate>
+  bool TriangleMesh::forEachCandidate(const std::vector<TrianglePacket<Width>> &packets,
+                                      std::uint32_t first, std::uint32_t count,
+                                      const PacketRay &ray, float tMin, float tMax,
+                                      Candidate candidate) const {
+    auto last = first + (count + Width - 1) / Width;
+    for (auto index = first; index < last; index++) {
+      const auto &packet = packets[index];
+      auto mask = intersectPacket(packet, ray, tMin, tMax);
+      for (auto lane = 0U; mask != 0 && lane < Width; lane++) {
+        if ((mask & (1U << lane)) != 0 && candidate(packet.triangle[lane])) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+  template <typename Candidate>
+  bool TriangleMesh::forEachCandidate(std::uint32_t first, std::uint32_t count,
+                                      const PacketRay &ray, float tMin, float tMax,
+                                      Candidate candidate) const {
+    if (this->packetWidth() == 8) {
+      return this->forEachCandidate(this->packets8, first, count, ray, tMin, tMax, candidate);
+    }
+    return this->forEachCandidate(this->packets4, first, count, ray, tMin, tMax, candidate);
+  }
+  void TriangleMesh::localIntersect(const Ray &ray, Intersections &xs) {
+    auto first = xs.size();
+    auto tMax = Scalar(INFINITY);
+    auto packetRay = PacketRay(ray);
+    auto sheared = this->shear(ray);
+    // Packets only filter out misses; each candidate is confirmed at full precision
+    auto confirm = [this, &ray, &sheared, &xs](std::uint32_t triangle) {
+      auto hit = Intersection(0.0, this);
+      if (this->intersectTriangle(triangle, ray, sheared, hit.t, hit.u, hit.v)) {
+        hit.primitive = triangle;
+        xs.add(hit);
+      }
+      return false;
+    };
+    this->traverse(ray, NEGATIVE_INFINITY, tMax,
+                   [this, &packetRay, &confirm](std::uint32_t first, std::uint32_t count,
+                                                Scalar &) {
+                     return this->forEachCandidate(first, count, packetRay, -INFINITY, INFINITY,
+                                                   confirm);
+                   });
+    xs.sort(first);
+  }
+  bool TriangleMesh::localIntersectClosest(Ray ray, Scalar tMin, Scalar tMax,
+                                           Intersection &closest) {
+    auto found = false;
+    auto packetRay = PacketRay(ray);
+    auto sheared = this->shear(ray);
+    this->traverse(ray, tMin, tMax, [this, &ray, &packetRay, &sheared, tMin, &closest, &found](
+                                        std::uint32_t first, std::uint32_t count, Scalar &tFar) {
+      auto confirm = [this, &ray, &sheared, tMin, &tFar, &closest, &found](std::uint32_t triangle) {
+        auto hit = Intersection(0.0, this);
+        if (this->intersectTriangle(triangle, ray, sheared, hit.t, hit.u, hit.v) && hit.t >= tMin
+            && hit.t < tFar) {
+          hit.primitive = triangle;
+          closest = hit;
+          tFar = hit.t;
+          found = true;
+        }
+        return false;
+      };
+      return this->forEachCandidate(first, count, packetRay, float(tMin), float(tFar), confirm);
+    });
+    return found;
+  }
+  bool TriangleMesh::localIntersectsAny(Ray ray, Scalar tMin, Scalar tMax) {
+    if (!this->material->castShadow) {
+      return false;
+    }
+    auto found = false;
+    auto packetRay = PacketRay(ray);
+    auto sheared = this->shear(ray);
+    this->traverse(ray, tMin, tMax, [this, &ray, &packetRay, &sheared, tMin, &found](
+                                        std::uint32_t first, std::uint32_t count, Scalar &tFar) {
+      auto confirm = [this, &ray, &sheared, tMin, tFar](std::uint32_t triangle) {
+        Scalar t;
+        Scalar u;
+        Scalar v;
+        return this->intersectTriangle(triangle, ray, sheared, t, u, v) && t >= tMin && t < tFar;
+      };
+      found = this->forEachCandidate(first, count, packetRay, float(tMin), float(tFar), confirm);
+      return found;
+    });
+    return found;
+  }
+  Tuple TriangleMesh::localNormalAt(Tuple point, Intersection hit) {
+    (void)point;
+    auto triangle = 3 * size_t(hit.primitive);
+    if (this->isSmooth()) {
+      const auto *corners = &this->normalIndices[triangle];
+      return this->normals->vector(corners[1]) * hit.u + this->normals->vector(corners[2]) * hit.v
+             + this->normals->vector(corners[0]) * (1 - hit.u - hit.v);
+    }
+    const auto *corners = &this->indices[triangle];
+    auto p1 = this->vertices->point(corners[0]);
+    auto e1 = this->vertices->point(corners[1]) - p1;
+    auto e2 = this->vertices->point(corners[2]) - p1;
+    return e2.cross(e1).normalize();
+  }
+  BoundingBox TriangleMesh::bounds() { return this->meshBounds; }
+}  // namespace raytracerchallenge
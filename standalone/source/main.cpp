@@ -1,3 +1,4 @@
+#include <raytracerchallenge/acceleration/LinearBVH.h>
 #include <raytracerchallenge/shapes/Cube.h>
 #include <raytracerchallenge/shapes/Plane.h>
 
@@ -5,6 +6,7 @@
 #include <fstream>
 #include <iostream>
 
+#include "raytracerchallenge/base/AffineTransform.h"
 #include "raytracerchallenge/base/Camera.h"
 #include "raytracerchallenge/base/Tuple.h"
 #include "raytracerchallenge/base/World.h"
@@ -19,10 +21,11 @@ auto main() -> int {
   World world;
 
   Camera camera(800, 800, 1.047);
-  auto from = Tuple::point(1.0, 1.0, -10.0);
-  auto to = Tuple::point(1.0, 0.0, 0.0);
-  auto up = Tuple::vector(0.0, 1.0, 0.0);
-  camera.transform = Matrix::view(from, to, up);
+  constexpr auto from = Tuple::point(1.0, 1.0, -10.0);
+  constexpr auto to = Tuple::point(1.0, 0.0, 0.0);
+  constexpr auto up = Tuple::vector(0.0, 1.0, 0.0);
+  constexpr auto view = AffineTransform::view(from, to, up);
+  camera.transform = view;
 
   world.light = PointLight(Tuple::point(0.75, 3.0, -8.0), Color(0.8, 0.8, 0.8));
   std::cout << "Loading file" << std::endl;
@@ -33,7 +36,9 @@ auto main() -> int {
   std::cout << "Read the file" << std::endl;
   auto parser = ObjParser::parse(buffer);
   auto objects = parser.getObjects();
-  objects->divide(1);
+  objects->divide(BVHOptions());
+  auto buildSeconds = std::dynamic_pointer_cast<Group>(objects)->buildStats.buildSeconds;
+  std::cout << "Built the BVH in " << buildSeconds << " seconds" << std::endl;
 
   std::cout << "Parsed the file" << std::endl;
   std::cout << "Found " << std::dynamic_pointer_cast<Group>(objects)->objects.size() << " objects"
@@ -44,7 +49,7 @@ auto main() -> int {
   auto plane = Plane::create();
   plane->material->reflective = 0.9;
   plane->material->color = {0.0, 0.0, 0.0};
-  world.add(objects);
+  world.add(LinearBVH::create(objects));
   world.add(plane);
   auto image = camera.render(world);
 
@@ -0,0 +1,219 @@
+#include <doctest/doctest.h>
+#include <raytracerchallenge/acceleration/BVHBuilder.h>
+
+#include <algorithm>
+
+using namespace raytracerchallenge;
+
+static BoundingBox unitBoxAt(double x, double y, double z) {
+  return {Tuple::point(x - 0.5, y - 0.5, z - 0.5), Tuple::point(x + 0.5, y + 0.5, z + 0.5)};
+}
+
+static bool sameTree(const BVHBuildNode &a, const BVHBuildNode &b) {
+  if (a.first != b.first || a.count != b.count || a.axis != b.axis || a.isLeaf() != b.isLeaf()
+      || !(a.bounds.min == b.bounds.min) || !(a.bounds.max == b.bounds.max)) {
+    return false;
+  }
+  return a.isLeaf() || (sameTree(*a.left, *b.left) && sameTree(*a.right, *b.right));
+}
+
+static std::vector<BoundingBox> scatteredBoxes(int count) {
+  std::vector<BoundingBox> bounds;
+  for (int i = 0; i < count; i++) {
+    bounds.push_back(unitBoxAt((i * 37) % 101, (i * 53) % 89, (i * 71) % 97));
+  }
+  return bounds;
+}
+
+TEST_CASE("BVH builder") {
+  SUBCASE("Building over no primitives returns no tree") {
+    auto builder = BVHBuilder();
+    CHECK(builder.build({}) == nullptr);
+  }
+  SUBCASE("A single primitive is built into a leaf") {
+    auto builder = BVHBuilder();
+    auto root = builder.build({unitBoxAt(0.0, 0.0, 0.0)});
+    CHECK(root->isLeaf());
+    CHECK(root->count == 1);
+    CHECK(root->bounds.min == Tuple::point(-0.5, -0.5, -0.5));
+  }
+  SUBCASE("Primitives which are cheaper to test together stay in one leaf") {
+    auto builder = BVHBuilder();
+    auto root = builder.build({unitBoxAt(0.0, 0.0, 0.0), unitBoxAt(0.1, 0.0, 0.0)});
+    CHECK(root->isLeaf());
+    CHECK(root->count == 2);
+  }
+  SUBCASE("Separated clusters are split along the axis of greatest spread") {
+    auto builder = BVHBuilder();
+    auto root = builder.build({unitBoxAt(-10.0, 0.0, 0.0), unitBoxAt(10.0, 0.0, 0.0),
+                               unitBoxAt(-10.0, 1.0, 0.0), unitBoxAt(10.0, 1.0, 0.0)});
+    CHECK(!root->isLeaf());
+    CHECK(root->axis == 0);
+    CHECK(root->left->bounds.max.x == 0.0 - 9.5);
+    CHECK(root->right->bounds.min.x == 9.5);
+    CHECK(root->left->count == 2);
+    CHECK(root->right->count == 2);
+  }
+  SUBCASE("Leaves never exceed the maximum leaf size") {
+    std::vector<BoundingBox> bounds;
+    for (int i = 0; i < 100; i++) {
+      bounds.push_back(unitBoxAt(0.0, 0.0, 0.0));
+    }
+    auto options = BVHOptions();
+    options.maxLeafSize = 3;
+    auto builder = BVHBuilder(options);
+    auto root = builder.build(bounds);
+    std::vector<const BVHBuildNode *> stack = {root.get()};
+    while (!stack.empty()) {
+      auto node = stack.back();
+      stack.pop_back();
+      if (node->isLeaf()) {
+        CHECK(node->count <= 3);
+      } else {
+        stack.push_back(node->left.get());
+        stack.push_back(node->right.get());
+      }
+    }
+  }
+  SUBCASE("Every primitive is referenced exactly once") {
+    std::vector<BoundingBox> bounds;
+    for (int i = 0; i < 50; i++) {
+      bounds.push_back(unitBoxAt(i % 7, i % 5, i % 3));
+    }
+    auto builder = BVHBuilder();
+    builder.build(bounds);
+    auto order = builder.order();
+    std::sort(order.begin(), order.end());
+    CHECK(order.size() == 50);
+    CHECK(std::adjacent_find(order.begin(), order.end()) == order.end());
+  }
+  SUBCASE("A parallel build produces the same tree as a sequential build") {
+    auto bounds = scatteredBoxes(2000);
+    auto sequentialOptions = BVHOptions();
+    sequentialOptions.parallelThreshold = bounds.size() + 1;
+    auto parallelOptions = BVHOptions();
+    parallelOptions.parallelThreshold = 64;
+    parallelOptions.buildThreads = 4;
+    auto sequential = BVHBuilder(sequentialOptions);
+    auto parallel = BVHBuilder(parallelOptions);
+    auto sequentialRoot = sequential.build(bounds);
+    auto parallelRoot = parallel.build(bounds);
+    CHECK(sameTree(*sequentialRoot, *parallelRoot));
+    CHECK(sequential.order() == parallel.order());
+  }
+  SUBCASE("A build reports its statistics") {
+    auto builder = BVHBuilder();
+    builder.build(scatteredBoxes(100));
+    auto stats = builder.stats();
+    CHECK(stats.buildSeconds >= 0.0);
+    CHECK(stats.leaves > 1);
+    CHECK(stats.nodes == 2 * stats.leaves - 1);
+  }
+  SUBCASE("A single leaf costs one intersection per primitive") {
+    auto builder = BVHBuilder();
+    builder.build({unitBoxAt(0.0, 0.0, 0.0), unitBoxAt(0.1, 0.0, 0.0)});
+    CHECK(builder.stats().sahCost == 2.0);
+  }
+  SUBCASE("A Morton build separates clusters on the highest differing bit") {
+    auto options = BVHOptions();
+    options.method = BVHMethod::Morton;
+    options.maxLeafSize = 2;
+    auto builder = BVHBuilder(options);
+    auto root = builder.build({unitBoxAt(-10.0, 0.0, 0.0), unitBoxAt(10.0, 0.0, 0.0),
+                               unitBoxAt(-10.0, 1.0, 0.0), unitBoxAt(10.0, 1.0, 0.0)});
+    CHECK(!root->isLeaf());
+    CHECK(root->axis == 0);
+    CHECK(root->left->bounds.max.x == 0.0 - 9.5);
+    CHECK(root->right->bounds.min.x == 9.5);
+    CHECK(root->left->count == 2);
+    CHECK(root->right->count == 2);
+  }
+  SUBCASE("A Morton build references every primitive once in small leaves") {
+    for (auto bits : {30U, 63U}) {
+      auto options = BVHOptions();
+      options.method = BVHMethod::Morton;
+      options.mortonBits = bits;
+      auto builder = BVHBuilder(options);
+      auto root = builder.build(scatteredBoxes(500));
+      CHECK(root->count == 500);
+      CHECK(root->bounds.min == Tuple::point(-0.5, -0.5, -0.5));
+      std::vector<const BVHBuildNode *> stack = {root.get()};
+      while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+        if (node->isLeaf()) {
+          CHECK(node->count <= options.maxLeafSize);
+        } else {
+          CHECK(node->left->first + node->left->count == node->right->first);
+          stack.push_back(node->left.get());
+          stack.push_back(node->right.get());
+        }
+      }
+      auto order = builder.order();
+      std::sort(order.begin(), order.end());
+      CHECK(std::adjacent_find(order.begin(), order.end()) == order.end());
+      CHECK(order.back() == 499);
+    }
+  }
+  SUBCASE("A Morton build of identical primitives falls back to splitting in the middle") {
+    std::vector<BoundingBox> bounds(9, unitBoxAt(1.0, 1.0, 1.0));
+    auto options = BVHOptions();
+    options.method = BVHMethod::Morton;
+    auto builder = BVHBuilder(options);
+    auto root = builder.build(bounds);
+    CHECK(root->left->count == 4);
+    CHECK(root->right->count == 5);
+  }
+  SUBCASE("Morton and SAH builds of the same scene can be compared by SAH cost") {
+    auto bounds = scatteredBoxes(500);
+    auto options = BVHOptions();
+    auto sah = BVHBuilder(options);
+    sah.build(bounds);
+    options.method = BVHMethod::Morton;
+    auto morton = BVHBuilder(options);
+    morton.build(bounds);
+    CHECK(sah.stats().sahCost > 0.0);
+    CHECK(morton.stats().sahCost > 0.0);
+    CHECK(sah.stats().sahCost <= morton.stats().sahCost);
+  }
+  SUBCASE("Spatial splits clip crossing primitives into both children within the budget") {
+    // A lattice of long thin sticks along x and y, which object splits cannot separate
+    std::vector<BoundingBox> bounds;
+    for (int i = 0; i < 20; i++) {
+      bounds.emplace_back(Tuple::point(0.0, i - 0.05, -0.05), Tuple::point(20.0, i + 0.05, 0.05));
+      bounds.emplace_back(Tuple::point(i - 0.05, 0.0, -0.05), Tuple::point(i + 0.05, 20.0, 0.05));
+    }
+    auto sah = BVHBuilder();
+    sah.build(bounds);
+    auto options = BVHOptions();
+    options.spatialSplits = true;
+    auto spatial = BVHBuilder(options);
+    auto root = spatial.build(bounds);
+    CHECK(spatial.stats().references > bounds.size());
+    CHECK(spatial.stats().references <= size_t(1.5 * double(bounds.size())));
+    CHECK(spatial.order().size() == spatial.stats().references);
+    CHECK(root->count == spatial.stats().references);
+    CHECK(spatial.stats().sahCost < sah.stats().sahCost);
+    auto order = spatial.order();
+    std::sort(order.begin(), order.end());
+    order.erase(std::unique(order.begin(), order.end()), order.end());
+    CHECK(order.size() == bounds.size());
+  }
+  SUBCASE("Spatial splits clip primitives with the provided clip function") {
+    std::vector<BoundingBox> bounds;
+    for (int i = 0; i < 20; i++) {
+      bounds.emplace_back(Tuple::point(0.0, i - 0.05, -0.05), Tuple::point(20.0, i + 0.05, 0.05));
+      bounds.emplace_back(Tuple::point(i - 0.05, 0.0, -0.05), Tuple::point(i + 0.05, 20.0, 0.05));
+    }
+    auto options = BVHOptions();
+    options.spatialSplits = true;
+    auto calls = 0;
+    auto builder = BVHBuilder(options);
+    builder.build(bounds, [&bounds, &calls](size_t primitive, const BoundingBox &box) {
+      calls++;
+      return bounds[primitive].clipped(box);
+    });
+    CHECK(calls > 0);
+    CHECK(builder.stats().references > bounds.size());
+  }
+}
@@ -0,0 +1,325 @@
+#define _USE_MATH_DEFINES
+#include <doctest/doctest.h>
+#include <raytracerchallenge/acceleration/LinearBVH.h>
+#include <raytracerchallenge/shapes/Group.h>
+#include <raytracerchallenge/shapes/Sphere.h>
+#include <raytracerchallenge/shapes/Triangle.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace raytracerchallenge;
+
+static std::shared_ptr<Shape> sphereGrid(int size) {
+  auto group = Group::create();
+  for (int x = 0; x < size; x++) {
+    for (int y = 0; y < size; y++) {
+      auto s = Sphere::create();
+      s->transform = s->transform.scaled(0.4, 0.4, 0.4).translated(x, y, (x * y) % 3);
+      std::dynamic_pointer_cast<Group>(group)->add(s);
+    }
+  }
+  return group;
+}
+
+static bool sameIntersections(const Intersections &a, const Intersections &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (!(a[i] == b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <unsigned int Width> static void checkPacketsAgainstRays(LinearBVH &bvh) {
+  for (int i = 0; i < 12; i++) {
+    // Half the packets fan out from one point, as primary rays do; the rest scatter
+    std::vector<Ray> rays;
+    for (auto lane = 0U; lane < Width; lane++) {
+      auto origin = i % 2 == 0 ? Tuple::point(2.5, 2.5, -8.0)
+                               : Tuple::point(lane * 0.6 - 2.0, i * 0.4, -6.0 + lane % 3);
+      auto target = Tuple::point(i * 0.5 + lane % 4 * 0.3, lane / 4 * 1.1 + i * 0.2, 1.0);
+      rays.emplace_back(origin, (target - origin).normalize());
+    }
+    RayPacket<Width> packet{};
+    for (auto lane = 0U; lane < Width - i % 3; lane++) {
+      setRayLane(packet, lane, rays[lane], 0.0, lane % 5 == 0 ? 8.0 : INFINITY);
+    }
+    Intersection closest[Width];
+    auto blocked = bvh.localIntersectsAny(packet, rays.data());
+    auto found = bvh.localIntersectClosest(packet, rays.data(), closest);
+    CHECK((found & ~packet.active) == 0U);
+    for (auto lane = 0U; lane < Width - i % 3; lane++) {
+      auto expected = Intersection();
+      auto tMax = lane % 5 == 0 ? 8.0 : INFINITY;
+      auto hit = bvh.localIntersectClosest(rays[lane], 0.0, tMax, expected);
+      CHECK(((found & (1U << lane)) != 0) == hit);
+      CHECK((!hit || closest[lane] == expected));
+      CHECK((!hit || packet.tMax[lane] == expected.t));
+      CHECK(((blocked & (1U << lane)) != 0) == bvh.localIntersectsAny(rays[lane], 0.0, tMax));
+    }
+  }
+}
+
+TEST_CASE("Linear BVH") {
+  SUBCASE("Nodes are packed into 32 bytes") { CHECK(sizeof(LinearBVHNode) == 32); }
+  SUBCASE("Compiling an empty group") {
+    auto bvh = LinearBVH::create(Group::create());
+    auto xs = bvh->intersect({{0.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}});
+    CHECK(xs.size() == 0);
+  }
+  SUBCASE("Compiling a single shape") {
+    auto s = Sphere::create();
+    s->transform = s->transform.translated(0.0, 0.0, 2.0);
+    auto bvh = LinearBVH::create(s);
+    auto xs = bvh->intersect({{0.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}});
+    CHECK(xs.size() == 2);
+    CHECK(xs[0].t == 6.0);
+    CHECK(xs[0].object == s.get());
+  }
+  SUBCASE("A compiled hierarchy returns the same intersections as the group") {
+    auto group = sphereGrid(6);
+    group->divide(BVHOptions());
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(group));
+    CHECK(bvh->nodes.size() > 1);
+    CHECK(bvh->primitives.size() == 36);
+    for (int i = 0; i < 20; i++) {
+      auto ray = Ray(Tuple::point(-3.0, i * 0.3 - 0.5, -5.0),
+                     Tuple::vector(1.0, 0.1 * (i % 4), 0.8).normalize());
+      CHECK(sameIntersections(bvh->intersect(ray), group->intersect(ray)));
+    }
+  }
+  SUBCASE("An undivided group is compiled into a single leaf") {
+    auto group = sphereGrid(3);
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(group));
+    CHECK(bvh->nodes.size() == 1);
+    CHECK(bvh->nodes[0].count == 9);
+  }
+  SUBCASE("A compiled group keeps the group's transform") {
+    auto group = sphereGrid(2);
+    group->transform = group->transform.rotatedY(M_PI / 2.0).translated(0.0, 0.0, 10.0);
+    auto bvh = LinearBVH::create(group);
+    CHECK(bvh->transform == group->transform);
+    auto ray = Ray(Tuple::point(1.0, 1.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(sameIntersections(bvh->intersect(ray), group->intersect(ray)));
+  }
+  SUBCASE("Transformed subgroups are kept as primitives") {
+    auto outer = Group::create();
+    auto inner = sphereGrid(2);
+    inner->transform = inner->transform.scaled(2.0, 2.0, 2.0);
+    std::dynamic_pointer_cast<Group>(outer)->add(inner);
+    auto s = Sphere::create();
+    std::dynamic_pointer_cast<Group>(outer)->add(s);
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(outer));
+    CHECK(bvh->primitives.size() == 2);
+    CHECK(bvh->includes(*s));
+    auto ray = Ray(Tuple::point(2.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(sameIntersections(bvh->intersect(ray), outer->intersect(ray)));
+  }
+  SUBCASE("Subgroups with a nearly identity transform are kept as primitives") {
+    auto outer = Group::create();
+    auto inner = sphereGrid(2);
+    inner->transform = inner->transform.rotatedZ(1e-4);
+    std::dynamic_pointer_cast<Group>(outer)->add(inner);
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(outer));
+    CHECK(bvh->primitives.size() == 1);
+    CHECK(bvh->primitives[0] == inner);
+  }
+  SUBCASE("Normals of hits are computed through the original hierarchy") {
+    auto group = sphereGrid(4);
+    group->transform = group->transform.scaled(2.0, 2.0, 2.0);
+    group->divide(BVHOptions());
+    auto bvh = LinearBVH::create(group);
+    auto ray = Ray(Tuple::point(2.0, 2.0, -10.0), Tuple::vector(0.0, 0.0, 1.0));
+    auto hit = bvh->intersect(ray).hit();
+    CHECK(hit.has_value());
+    auto normal = hit->object->normalAt(ray.position(hit->t), hit.value());
+    CHECK(normal == Tuple::vector(0.0, 0.0, -1.0));
+  }
+  SUBCASE("Building a hierarchy from a list of shapes") {
+    auto group = sphereGrid(6);
+    auto shapes = std::dynamic_pointer_cast<Group>(group)->objects;
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(shapes));
+    CHECK(bvh->nodes.size() > 1);
+    CHECK(bvh->primitives.size() == 36);
+    CHECK(bvh->includes(*shapes[7]));
+    for (int i = 0; i < 20; i++) {
+      auto ray = Ray(Tuple::point(-3.0, i * 0.3 - 0.5, -5.0),
+                     Tuple::vector(1.0, 0.1 * (i % 4), 0.8).normalize());
+      CHECK(sameIntersections(bvh->intersect(ray), group->intersect(ray)));
+    }
+  }
+  SUBCASE("Building a hierarchy from an empty list of shapes") {
+    auto bvh = LinearBVH::create(std::vector<std::shared_ptr<Shape>>());
+    auto xs = bvh->intersect({{0.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}});
+    CHECK(xs.size() == 0);
+  }
+  SUBCASE("The closest intersection with a compiled hierarchy is its hit") {
+    auto group = sphereGrid(6);
+    group->divide(BVHOptions());
+    auto bvh = LinearBVH::create(group);
+    for (int i = 0; i < 20; i++) {
+      auto ray = Ray(Tuple::point(-3.0, i * 0.3 - 0.5, -5.0),
+                     Tuple::vector(1.0, 0.1 * (i % 4), 0.8).normalize());
+      auto hit = bvh->intersect(ray).hit();
+      auto closest = Intersection();
+      CHECK(bvh->intersectClosest(ray, 0.0, INFINITY, closest) == hit.has_value());
+      if (hit.has_value()) {
+        CHECK(closest == hit.value());
+      }
+    }
+  }
+  SUBCASE("Closest intersections beyond tMax are ignored") {
+    auto s = Sphere::create();
+    auto bvh = LinearBVH::create(std::vector<std::shared_ptr<Shape>>{s});
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    auto closest = Intersection();
+    CHECK_FALSE(bvh->intersectClosest(ray, 0.0, 3.0, closest));
+    CHECK(bvh->intersectClosest(ray, 0.0, 5.0, closest));
+    CHECK(closest.t == 4.0);
+  }
+  SUBCASE("Any intersection with a compiled hierarchy agrees with its hit") {
+    auto group = sphereGrid(6);
+    group->divide(BVHOptions());
+    auto bvh = LinearBVH::create(group);
+    for (int i = 0; i < 20; i++) {
+      auto ray = Ray(Tuple::point(-3.0, i * 0.3 - 0.5, -5.0),
+                     Tuple::vector(1.0, 0.1 * (i % 4), 0.8).normalize());
+      auto hit = bvh->intersect(ray).hit();
+      CHECK(bvh->intersectsAny(ray, 0.0, INFINITY) == hit.has_value());
+      if (hit.has_value()) {
+        CHECK_FALSE(bvh->intersectsAny(ray, 0.0, hit->t));
+      }
+    }
+  }
+  SUBCASE("Packets of rays find the same hits as the rays alone") {
+    auto group = sphereGrid(6);
+    group->divide(BVHOptions());
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(group));
+    checkPacketsAgainstRays<4>(*bvh);
+    checkPacketsAgainstRays<8>(*bvh);
+    checkPacketsAgainstRays<16>(*bvh);
+  }
+  SUBCASE("Refitting a hierarchy after primitives have moved") {
+    auto group = sphereGrid(6);
+    auto shapes = std::dynamic_pointer_cast<Group>(group)->objects;
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(shapes));
+    auto nodes = bvh->nodes.size();
+    auto primitives = bvh->primitives;
+    shapes[0]->transform = shapes[0]->transform.translated(0.0, 0.0, -0.2);
+    bvh->refit();
+    CHECK(bvh->nodes.size() == nodes);
+    CHECK(bvh->primitives == primitives);
+    for (int i = 0; i < 20; i++) {
+      auto ray = Ray(Tuple::point(-3.0, i * 0.3 - 0.5, -5.0),
+                     Tuple::vector(1.0, 0.1 * (i % 4), 0.8).normalize());
+      CHECK(sameIntersections(bvh->intersect(ray), group->intersect(ray)));
+    }
+  }
+  SUBCASE("Refitting rebuilds a hierarchy whose cost has degraded") {
+    auto group = sphereGrid(6);
+    auto shapes = std::dynamic_pointer_cast<Group>(group)->objects;
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(shapes));
+    auto options = BVHOptions();
+    options.rebuildThreshold = INFINITY;
+    auto refitOnly = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(shapes, options));
+    auto cost = bvh->sahCost();
+    for (int i = 0; i < 36; i++) {
+      auto x = i * 7 % 36 / 6;
+      auto y = i * 7 % 36 % 6;
+      shapes[i]->transform = Matrix::identity(4).scaled(0.4, 0.4, 0.4).translated(x, y, 0.0);
+    }
+    bvh->refit();
+    refitOnly->refit();
+    CHECK(refitOnly->sahCost() > 1.5 * cost);
+    CHECK(bvh->sahCost() <= 1.5 * cost);
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(sameIntersections(bvh->intersect(ray), group->intersect(ray)));
+  }
+  SUBCASE("Refitting a compiled group refits the group") {
+    auto group = sphereGrid(4);
+    group->divide(BVHOptions());
+    auto bvh = LinearBVH::create(group);
+    auto s = Sphere::create();
+    s->transform = Matrix::translation(10.0, 10.0, 0.0);
+    std::dynamic_pointer_cast<Group>(group)->add(s);
+    s->transform = Matrix::translation(1.0, 1.0, -5.0);
+    bvh->refit();
+    CHECK(bvh->bounds().min.z == -6.0);
+  }
+  SUBCASE("Rebuilding a compiled group releases the old hierarchy") {
+    auto group = sphereGrid(6);
+    auto options = BVHOptions();
+    options.rebuildThreshold = INFINITY;
+    group->divide(options);
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(group));
+    auto uses = group.use_count();
+    auto cost = bvh->sahCost();
+    auto i = 0;
+    for (const auto &primitive : bvh->primitives) {
+      auto x = i * 7 % 36 / 6;
+      auto y = i * 7 % 36 % 6;
+      primitive->transform = Matrix::identity(4).scaled(0.4, 0.4, 0.4).translated(x, y, 0.0);
+      i++;
+    }
+    bvh->refit();
+    CHECK(bvh->sahCost() > 1.5 * cost);
+    CHECK(group.use_count() == uses);
+  }
+  SUBCASE("A hierarchy with spatial splits reports each intersection once") {
+    // A lattice of long slivers, whose bounding boxes overlap wherever they cross
+    auto group = Group::create();
+    for (int i = 0; i < 20; i++) {
+      std::dynamic_pointer_cast<Group>(group)->add(
+          Triangle::create(Tuple::point(0.0, i, 0.0), Tuple::point(20.0, i, 0.0),
+                           Tuple::point(20.0, i + 0.1, 0.1)));
+      std::dynamic_pointer_cast<Group>(group)->add(
+          Triangle::create(Tuple::point(i, 0.0, 0.0), Tuple::point(i, 20.0, 0.0),
+                           Tuple::point(i + 0.1, 20.0, 0.1)));
+    }
+    auto shapes = std::dynamic_pointer_cast<Group>(group)->objects;
+    auto options = BVHOptions();
+    options.spatialSplits = true;
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(shapes, options));
+    CHECK(bvh->primitives.size() > shapes.size());
+    auto objectSplits = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(shapes));
+    CHECK(bvh->sahCost() < objectSplits->sahCost());
+    for (int i = 0; i < 200; i++) {
+      auto ray = Ray(Tuple::point(i * 0.1 + 0.03, (i * 7) % 200 * 0.1 + 0.02, -5.0),
+                     Tuple::vector(0.0, 0.0, 1.0));
+      CHECK(sameIntersections(bvh->intersect(ray), group->intersect(ray)));
+      auto closest = Intersection();
+      auto hit = group->intersect(ray).hit();
+      CHECK(bvh->intersectClosest(ray, 0.0, INFINITY, closest) == hit.has_value());
+      CHECK((!hit.has_value() || closest == *hit));
+    }
+  }
+  SUBCASE("A hierarchy with spatial splits keeps repeated intersections with one primitive") {
+    // A lattice of long ellipsoids, one of which a ray grazes, meeting it twice at the same t
+    std::vector<std::shared_ptr<Shape>> shapes;
+    for (int i = 0; i < 20; i++) {
+      shapes.push_back(Sphere::create());
+      shapes.back()->transform = Matrix::scaling(10.0, 0.25, 0.25).translated(10.0, i, 0.0);
+      shapes.push_back(Sphere::create());
+      shapes.back()->transform = Matrix::scaling(0.25, 10.0, 0.25).translated(i, 10.0, 0.0);
+    }
+    auto grazed = shapes[10];
+    auto options = BVHOptions();
+    options.spatialSplits = true;
+    auto bvh = std::dynamic_pointer_cast<LinearBVH>(LinearBVH::create(shapes, options));
+    CHECK(std::count(bvh->primitives.begin(), bvh->primitives.end(), grazed) > 1);
+    auto xs = bvh->intersect(Ray(Tuple::point(10.0, 5.25, -8.0), Tuple::vector(0.0, 0.0, 1.0)));
+    auto grazes = 0;
+    for (size_t i = 0; i < xs.size(); i++) {
+      if (xs[i].object == grazed.get()) {
+        CHECK(xs[i].t == 8.0);
+        grazes++;
+      }
+    }
+    CHECK(grazes == 2);
+  }
+}
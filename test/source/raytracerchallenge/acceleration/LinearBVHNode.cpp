@@ -0,0 +1,30 @@
+#include <doctest/doctest.h>
+#include <raytracerchallenge/acceleration/LinearBVHNode.h>
+
+using namespace raytracerchallenge;
+
+TEST_CASE("Linear BVH nodes") {
+  SUBCASE("Values are rounded outwards to floats") {
+    CHECK(double(roundDown(0.1)) <= 0.1);
+    CHECK(double(roundUp(0.1)) >= 0.1);
+    CHECK(roundDown(0.1) < roundUp(0.1));
+    CHECK(roundDown(0.5) == 0.5F);
+    CHECK(roundUp(0.5) == 0.5F);
+  }
+  SUBCASE("A packed node holds its box and splits along its longest axis") {
+    auto node = packNode({Tuple::point(-0.1, 0.0, 0.0), Tuple::point(1.0, 3.0, 0.3)});
+    CHECK(double(node.min[0]) <= -0.1);
+    CHECK(double(node.max[2]) >= 0.3);
+    CHECK(node.axis == 1);
+    CHECK(node.count == 0);
+  }
+  SUBCASE("A ray along an edge of a node passes through it") {
+    auto node = packNode({Tuple::point(0.0, 0.0, 0.0), Tuple::point(1.0, 1.0, 1.0)});
+    auto ray = Ray(Tuple::point(-1.0, 1.0, 0.0), Tuple::vector(1.0, 0.0, 0.0));
+    CHECK(intersectsNode(node, NodeRay(ray), 0.0, INFINITY));
+    auto diagonal = Ray(Tuple::point(-1.0, -1.0, -1.0), Tuple::vector(1.0, 1.0, 1.0).normalize());
+    CHECK(intersectsNode(node, NodeRay(diagonal), 0.0, INFINITY));
+    auto miss = Ray(Tuple::point(-1.0, 1.5, 0.0), Tuple::vector(1.0, 0.0, 0.0));
+    CHECK_FALSE(intersectsNode(node, NodeRay(miss), 0.0, INFINITY));
+  }
+}
@@ -0,0 +1,60 @@
+#include <doctest/doctest.h>
+#include <raytracerchallenge/acceleration/RayPacket.h>
+#include <raytracerchallenge/base/BoundingBox.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace raytracerchallenge;
+
+/**
+ * Rays through and around a box, in every direction, some running along its faces
+ */
+static std::vector<Ray> raysAroundBox(unsigned int count) {
+  std::vector<Ray> rays;
+  for (auto i = 0U; i < count; i++) {
+    auto origin = Tuple::point(3.0 * std::sin(i * 0.9), 2.0 * std::cos(i * 1.3), -3.0 + i % 5);
+    auto target = Tuple::point(std::sin(i * 0.4), std::cos(i * 0.7), std::sin(i * 1.1));
+    rays.emplace_back(origin, (target - origin).normalize());
+  }
+  rays.emplace_back(Tuple::point(-1.0, 0.5, -3.0), Tuple::vector(0.0, 0.0, 1.0));
+  rays.emplace_back(Tuple::point(0.5, 2.0, -3.0), Tuple::vector(0.0, 0.0, -1.0));
+  return rays;
+}
+
+template <unsigned int Width> static void checkPacketsAgainstBox(const BoundingBox &box) {
+  const float min[3] = {float(box.min.x), float(box.min.y), float(box.min.z)};
+  const float max[3] = {float(box.max.x), float(box.max.y), float(box.max.z)};
+  auto rays = raysAroundBox(3 * Width - 2);
+  for (size_t first = 0; first < rays.size(); first += Width) {
+    RayPacket<Width> packet{};
+    auto count = unsigned(std::min(size_t(Width), rays.size() - first));
+    for (auto lane = 0U; lane < count; lane++) {
+      auto tMax = lane % 3 == 0 ? Scalar(2.5) : Scalar(INFINITY);
+      setRayLane(packet, lane, rays[first + lane], 0.0, tMax);
+    }
+    auto mask = intersectBounds(packet, min, max, packet.active);
+    CHECK((mask & ~packet.active) == 0U);
+    for (auto lane = 0U; lane < count; lane++) {
+      auto expected = box.intersects(rays[first + lane], packet.tMin[lane], packet.tMax[lane]);
+      CHECK(((mask & (1U << lane)) != 0) == expected);
+    }
+    CHECK(intersectBounds(packet, min, max, 0U) == 0U);
+  }
+}
+
+TEST_CASE("Ray packets") {
+  auto box = BoundingBox(Tuple::point(-1.0, -0.5, -0.25), Tuple::point(0.5, 2.0, 1.5));
+  SUBCASE("Four-ray packets test boxes as single rays do") { checkPacketsAgainstBox<4>(box); }
+  SUBCASE("Eight-ray packets test boxes as single rays do") { checkPacketsAgainstBox<8>(box); }
+  SUBCASE("Sixteen-ray packets test boxes as single rays do") { checkPacketsAgainstBox<16>(box); }
+  SUBCASE("A ray running along a face of a box passes through it") {
+    RayPacket<4> packet{};
+    setRayLane(packet, 2, Ray(Tuple::point(-1.0, 0.5, -3.0), Tuple::vector(0.0, 0.0, 1.0)), 0.0,
+               INFINITY);
+    const float min[3] = {-1.0F, -0.5F, -0.25F};
+    const float max[3] = {0.5F, 2.0F, 1.5F};
+    CHECK(packet.active == 4U);
+    CHECK(intersectBounds(packet, min, max, packet.active) == 4U);
+  }
+}
@@ -0,0 +1,117 @@
+#include <doctest/doctest.h>
+#include <raytracerchallenge/acceleration/TrianglePacket.h>
+#include <raytracerchallenge/base/Intersections.h>
+#include <raytracerchallenge/shapes/Triangle.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace raytracerchallenge;
+
+/**
+ * Triangles of varied size and orientation scattered around a centre, within
+ * a region the given scale across
+ */
+static std::vector<std::shared_ptr<Shape>> scatteredTriangles(unsigned int count, double scale,
+                                                              const Tuple &offset) {
+  std::vector<std::shared_ptr<Shape>> triangles;
+  for (auto i = 0U; i < count; i++) {
+    auto centre = offset + Tuple::vector(std::sin(i * 1.3), std::cos(i * 0.7), std::sin(i * 0.3))
+                               * scale;
+    auto size = (0.5 + 0.4 * std::sin(i * 2.1)) * scale;
+    triangles.push_back(Triangle::create(
+        centre + Tuple::vector(size, 0.0, std::cos(i * 0.9) * size),
+        centre + Tuple::vector(-size * 0.5, size, 0.2 * scale),
+        centre + Tuple::vector(-size * 0.3, -size, std::sin(i * 1.7) * size)));
+  }
+  return triangles;
+}
+
+/**
+ * Check that packets report every triangle that a ray hits, for rays aimed at
+ * points inside the triangles and on their edges and corners
+ */
+template <unsigned int Width>
+static void checkPacketsAgainstTriangles(double scale = 1.0,
+                                         const Tuple &offset = Tuple::point(0.0, 0.0, 0.0)) {
+  auto triangles = scatteredTriangles(Width + Width / 2, scale, offset);
+  std::vector<TrianglePacket<Width>> packets((triangles.size() + Width - 1) / Width);
+  for (size_t i = 0; i < packets.size() * Width; i++) {
+    auto &packet = packets[i / Width];
+    auto lane = unsigned(i % Width);
+    if (i >= triangles.size()) {
+      clearTriangleLane(packet, lane);
+      continue;
+    }
+    auto triangle = std::dynamic_pointer_cast<Triangle>(triangles[i]);
+    setTriangleLane(packet, lane, triangle->p1, triangle->p2, triangle->p3, std::uint32_t(i));
+  }
+  auto checked = 0;
+  for (auto i = 0; i < 400; i++) {
+    auto toOrigin = Tuple::vector(3.0 * std::sin(i * 0.37), 3.0 * std::cos(i * 0.11), -4.0);
+    auto toTarget = Tuple::vector(std::sin(i * 0.53), std::cos(i * 0.29), std::sin(i * 0.17));
+    auto origin = offset + toOrigin * scale;
+    auto target = offset + toTarget * scale;
+    if (i % 2 == 1) {
+      // Aim at an edge or corner of one of the triangles
+      auto triangle = std::dynamic_pointer_cast<Triangle>(triangles[size_t(i) % triangles.size()]);
+      auto weight = (i / 2) % 3 == 0 ? 0.0 : std::abs(std::sin(i * 0.7));
+      target = triangle->p1 + (triangle->p2 - triangle->p1) * weight;
+    }
+    auto ray = Ray(origin, (target - origin).normalize());
+    auto packetRay = PacketRay(ray);
+    for (size_t index = 0; index < packets.size(); index++) {
+      auto mask = intersectPacket(packets[index], packetRay, 0.0F, INFINITY);
+      for (auto lane = 0U; lane < Width; lane++) {
+        auto triangle = index * Width + lane;
+        auto reported = (mask & (1U << lane)) != 0;
+        if (triangle >= triangles.size()) {
+          CHECK_FALSE(reported);
+          continue;
+        }
+        CHECK(packets[index].triangle[lane] == triangle);
+        auto xs = triangles[triangle]->localIntersect(ray);
+        if (xs.size() == 1 && xs[0].t >= 0.0) {
+          CHECK(reported);
+          checked++;
+        }
+      }
+    }
+  }
+  CHECK(checked > 100);
+}
+
+TEST_CASE("Triangle packets") {
+  SUBCASE("Four-wide packets report every triangle a ray hits") {
+    checkPacketsAgainstTriangles<4>();
+  }
+  SUBCASE("Eight-wide packets report every triangle a ray hits") {
+    checkPacketsAgainstTriangles<8>();
+  }
+  SUBCASE("Packets report every hit on tiny triangles") {
+    checkPacketsAgainstTriangles<4>(0.0002, Tuple::point(0.3, -0.2, 0.1));
+    checkPacketsAgainstTriangles<8>(0.0002, Tuple::point(0.3, -0.2, 0.1));
+  }
+  SUBCASE("Packets report every hit on triangles far from the origin") {
+    checkPacketsAgainstTriangles<4>(1.0, Tuple::point(10000.0, -7000.0, 12000.0));
+    checkPacketsAgainstTriangles<8>(1.0, Tuple::point(10000.0, -7000.0, 12000.0));
+  }
+  SUBCASE("Packets reject clear misses and hits outside the range") {
+    TrianglePacket<4> packet{};
+    setTriangleLane(packet, 0, Tuple::point(0.0, 1.0, 0.0), Tuple::point(-1.0, 0.0, 0.0),
+                    Tuple::point(1.0, 0.0, 0.0), 7);
+    for (auto lane = 1U; lane < 4; lane++) {
+      clearTriangleLane(packet, lane);
+    }
+    auto hit = PacketRay(Ray(Tuple::point(0.0, 0.5, -2.0), Tuple::vector(0.0, 0.0, 1.0)));
+    auto miss = PacketRay(Ray(Tuple::point(1.0, 1.0, -2.0), Tuple::vector(0.0, 0.0, 1.0)));
+    auto parallel = PacketRay(Ray(Tuple::point(0.0, -1.0, -2.0), Tuple::vector(0.0, 1.0, 0.0)));
+    CHECK(intersectPacket(packet, hit, 0.0F, INFINITY) == 1U);
+    CHECK(intersectPacket(packet, hit, 0.0F, 1.5F) == 0U);
+    CHECK(intersectPacket(packet, hit, 2.5F, INFINITY) == 0U);
+    CHECK(intersectPacket(packet, miss, 0.0F, INFINITY) == 0U);
+    // The sign of det is in doubt for a parallel ray, so it is left to the exact test
+    CHECK(intersectPacket(packet, parallel, 0.0F, INFINITY) == 1U);
+  }
+}
@@ -0,0 +1,157 @@
+#include <doctest/doctest.h>
+#include <raytracerchallenge/acceleration/WideBVH.h>
+#include <raytracerchallenge/base/World.h>
+#include <raytracerchallenge/shapes/Group.h>
+#include <raytracerchallenge/shapes/Sphere.h>
+#include <raytracerchallenge/shapes/Triangle.h>
+
+#include <cmath>
+
+using namespace raytracerchallenge;
+
+static std::vector<std::shared_ptr<Shape>> sphereLattice(int size) {
+  std::vector<std::shared_ptr<Shape>> shapes;
+  for (int x = 0; x < size; x++) {
+    for (int y = 0; y < size; y++) {
+      for (int z = 0; z < size; z++) {
+        auto s = Sphere::create();
+        s->transform = s->transform.scaled(0.3, 0.3, 0.3).translated(x, y, z);
+        shapes.push_back(s);
+      }
+    }
+  }
+  return shapes;
+}
+
+static std::vector<unsigned int> testedWidths() {
+  std::vector<unsigned int> widths = {4};
+  if (WideBVH::supportsWidth(8)) {
+    widths.push_back(8);
+  }
+  return widths;
+}
+
+TEST_CASE("Wide BVH") {
+  SUBCASE("Every primitive is referenced once and nodes use their lanes") {
+    auto shapes = sphereLattice(5);
+    std::vector<BoundingBox> bounds;
+    for (const auto &shape : shapes) {
+      bounds.push_back(shape->parentSpaceBounds());
+    }
+    auto binary = BVHBuilder();
+    binary.build(bounds);
+    auto interior = binary.stats().nodes - binary.stats().leaves;
+    for (auto width : testedWidths()) {
+      auto options = BVHOptions();
+      options.width = width;
+      auto bvh = std::dynamic_pointer_cast<WideBVH>(WideBVH::create(shapes, options));
+      CHECK(bvh->width() == width);
+      CHECK(bvh->primitives.size() == shapes.size());
+      // Each wide node absorbs up to width - 1 interior nodes of the binary hierarchy
+      auto nodes = width == 8 ? bvh->nodes8.size() : bvh->nodes4.size();
+      CHECK(nodes > 0);
+      CHECK(nodes * 2 < interior);
+      CHECK(bvh->bounds().min == Tuple::point(-0.3, -0.3, -0.3));
+    }
+  }
+  SUBCASE("Asking for eight children falls back to four without AVX2") {
+    auto options = BVHOptions();
+    options.width = 8;
+    auto bvh = std::dynamic_pointer_cast<WideBVH>(WideBVH::create(sphereLattice(2), options));
+    CHECK(bvh->width() == (WideBVH::supportsWidth(8) ? 8U : 4U));
+  }
+  SUBCASE("A wide BVH finds the same intersections as a group") {
+    auto shapes = sphereLattice(5);
+    auto group = Group::create();
+    for (const auto &shape : shapes) {
+      std::dynamic_pointer_cast<Group>(group)->add(shape);
+    }
+    for (auto width : testedWidths()) {
+      auto options = BVHOptions();
+      options.width = width;
+      auto bvh = WideBVH::create(shapes, options);
+      for (int i = 0; i < 50; i++) {
+        auto ray = Ray(Tuple::point(-2.0, i * 0.1 - 0.3, -3.0),
+                       Tuple::vector(1.0, 0.05 * (i % 5), 0.7 + 0.01 * i).normalize());
+        auto expected = group->intersect(ray);
+        auto actual = bvh->intersect(ray);
+        CHECK(actual.size() == expected.size());
+        for (size_t j = 0; j < std::min(actual.size(), expected.size()); j++) {
+          CHECK(actual[j] == expected[j]);
+        }
+        auto closest = Intersection();
+        auto hit = expected.hit();
+        CHECK(bvh->intersectClosest(ray, 0.0, INFINITY, closest) == hit.has_value());
+        CHECK((!hit.has_value() || closest == *hit));
+        CHECK(bvh->intersectsAny(ray, 0.0, INFINITY) == hit.has_value());
+      }
+    }
+  }
+  SUBCASE("Rays along an axis intersect triangles in a wide BVH") {
+    std::vector<std::shared_ptr<Shape>> shapes;
+    for (int i = 0; i < 40; i++) {
+      shapes.push_back(Triangle::create(Tuple::point(i, 0.0, 0.0), Tuple::point(i + 1.0, 0.0, 0.0),
+                                        Tuple::point(i, 1.0, 0.0)));
+    }
+    for (auto width : testedWidths()) {
+      auto options = BVHOptions();
+      options.width = width;
+      auto bvh = WideBVH::create(shapes, options);
+      for (int i = 0; i < 40; i++) {
+        auto xs = bvh->intersect(Ray(Tuple::point(i + 0.25, 0.25, -2.0), Tuple::vector(0, 0, 1)));
+        CHECK(xs.size() == 1);
+        CHECK((xs.size() == 1 && xs[0].object == shapes[size_t(i)].get()));
+      }
+    }
+  }
+  SUBCASE("Refitting a wide BVH follows moved primitives") {
+    auto shapes = sphereLattice(3);
+    auto bvh = WideBVH::create(shapes);
+    shapes[0]->transform = Matrix::translation(10.0, 10.0, 10.0);
+    auto ray = Ray(Tuple::point(10.0, 10.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(bvh->intersect(ray).size() == 0);
+    bvh->refit();
+    CHECK(bvh->bounds().max == Tuple::point(11.0, 11.0, 11.0));
+    auto xs = bvh->intersect(ray);
+    CHECK(xs.size() == 2);
+    CHECK(std::abs(xs[0].t - 14.0) < 1e-9);
+  }
+  SUBCASE("Refitting rebuilds a wide BVH whose cost has degraded") {
+    auto shapes = sphereLattice(4);
+    for (auto width : testedWidths()) {
+      auto options = BVHOptions();
+      options.width = width;
+      auto bvh = std::dynamic_pointer_cast<WideBVH>(WideBVH::create(shapes, options));
+      options.rebuildThreshold = INFINITY;
+      auto refitOnly = std::dynamic_pointer_cast<WideBVH>(WideBVH::create(shapes, options));
+      auto cost = bvh->sahCost();
+      for (int i = 0; i < 64; i++) {
+        auto j = i * 23 % 64;
+        shapes[size_t(i)]->transform
+            = Matrix::identity(4).scaled(0.3, 0.3, 0.3).translated(j / 16, j / 4 % 4, j % 4);
+      }
+      bvh->refit();
+      refitOnly->refit();
+      CHECK(refitOnly->sahCost() > 1.5 * cost);
+      CHECK(bvh->sahCost() <= 1.5 * cost);
+      CHECK(bvh->width() == width);
+      auto ray = Ray(Tuple::point(1.0, 2.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+      auto xs = bvh->intersect(ray);
+      CHECK(xs.size() == 8);
+      for (int i = 0; i < 64; i++) {
+        shapes[size_t(i)]->transform = Matrix::identity(4).scaled(0.3, 0.3, 0.3).translated(
+            i / 16, i / 4 % 4, i % 4);
+      }
+    }
+  }
+  SUBCASE("A world can be built with a wide BVH") {
+    auto world = World::defaultWorld();
+    auto options = BVHOptions();
+    options.width = 4;
+    world.build(options);
+    auto xs = world.intersect(Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0)));
+    CHECK(xs.size() == 4);
+    CHECK(xs[0].t == 4.0);
+    CHECK(xs[3].t == 6.0);
+  }
+}
@@ -0,0 +1,69 @@
+#define _USE_MATH_DEFINES
+#include <doctest/doctest.h>
+#include <raytracerchallenge/base/AffineTransform.h>
+#include <raytracerchallenge/base/CachedTransform.h>
+
+#include <cmath>
+
+using namespace raytracerchallenge;
+
+TEST_CASE("Affine transforms") {
+  SUBCASE("Transforms are built at compile time") {
+    constexpr auto translation = AffineTransform::translation(5.0, -3.0, 2.0);
+    constexpr auto moved = translation * Tuple::point(-3.0, 4.0, 5.0);
+    static_assert(moved.x == 2.0 && moved.y == 1.0 && moved.z == 7.0 && moved.w == 1.0,
+                  "translation should be folded at compile time");
+    constexpr auto quarterTurn = AffineTransform::rotationZ(M_PI / 2.0);
+    static_assert(quarterTurn == AffineTransform::rotationZ(-M_PI / 2.0).rotatedZ(M_PI),
+                  "rotations should compose at compile time");
+    constexpr auto turned = quarterTurn * Tuple::point(0.0, 1.0, 0.0);
+    static_assert(turned.x < -0.9999 && turned.y < 1e-6 && turned.y > -1e-6,
+                  "a quarter turn about z should map y onto -x");
+    CHECK(Transform(translation) == Transform::translation(5.0, -3.0, 2.0));
+  }
+  SUBCASE("Chained builders match Transform") {
+    constexpr auto affine = AffineTransform::rotationX(M_PI / 2.0)
+                                .scaled(5.0, 5.0, 5.0)
+                                .translated(10.0, 5.0, 7.0)
+                                .sheared(1.0, 0.0, 0.0, 0.0, 0.0, 1.0)
+                                .rotatedY(0.3)
+                                .rotatedZ(-2.0);
+    auto transform = Transform::rotationX(M_PI / 2.0)
+                         .scaled(5.0, 5.0, 5.0)
+                         .translated(10.0, 5.0, 7.0)
+                         .sheared(1.0, 0.0, 0.0, 0.0, 0.0, 1.0)
+                         .rotatedY(0.3)
+                         .rotatedZ(-2.0);
+    CHECK(Transform(affine) == transform);
+    CHECK(Transform(affine).isAffine());
+  }
+  SUBCASE("The view transform matches Transform") {
+    constexpr auto from = Tuple::point(1.0, 3.0, 2.0);
+    constexpr auto to = Tuple::point(4.0, -2.0, 8.0);
+    constexpr auto up = Tuple::vector(1.0, 1.0, 0.0);
+    constexpr auto view = AffineTransform::view(from, to, up);
+    CHECK(Transform(view) == Transform::view(from, to, up));
+  }
+  SUBCASE("Affine transforms compare relatively, as Transform does") {
+    constexpr auto far = AffineTransform::translation(10000.0, 0.0, 0.0);
+    constexpr auto nearlyFar = AffineTransform::translation(10000.5, 0.0, 0.0);
+    static_assert(far == nearlyFar, "a small change to a large translation should compare equal");
+    CHECK(Transform(far) == Transform(nearlyFar));
+    CHECK(AffineTransform::translation(1.0, 0.0, 0.0)
+          != AffineTransform::translation(1.5, 0.0, 0.0));
+    CHECK(Transform::translation(1.0, 0.0, 0.0) != Transform::translation(1.5, 0.0, 0.0));
+  }
+  SUBCASE("Compile-time sine and cosine match the standard library") {
+    for (double radians = -20.0; radians <= 20.0; radians += 0.37) {
+      CHECK(std::abs(constexprSin(radians) - std::sin(radians)) < 1e-14);
+      CHECK(std::abs(constexprCos(radians) - std::cos(radians)) < 1e-14);
+    }
+    static_assert(constexprSqrt(2.25) == 1.5, "square roots should be constant expressions");
+    CHECK(std::abs(constexprSqrt(1e-8) - 1e-4) < 1e-18);
+  }
+  SUBCASE("An affine transform can be assigned to a shape's transform") {
+    CachedTransform transform;
+    transform = AffineTransform::scaling(2.0, 2.0, 2.0);
+    CHECK(transform.inverse() == Transform::scaling(0.5, 0.5, 0.5));
+  }
+}
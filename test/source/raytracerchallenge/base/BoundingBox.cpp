@@ -92,6 +92,35 @@ TEST_CASE("Bounding boxes") {
     CHECK(!box.intersects({{8.0, 6.0, -1.0, 1.0}, {0.0, -1.0, 0.0, 0.0}}));
     CHECK(!box.intersects({{12.0, 5.0, 4.0, 1.0}, {-1.0, 0.0, 0.0, 0.0}}));
   }
+  SUBCASE("Intersecting a ray with a bounding box within an interval") {
+    auto box = BoundingBox({-1.0, -1.0, -1.0, 1.0}, {1.0, 1.0, 1.0, 1.0});
+    auto ray = Ray({0.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    CHECK(box.intersects(ray, 0.0, INFINITY));
+    CHECK(box.intersects(ray, 5.0, 5.5));
+    CHECK(box.intersects(ray, 0.0, 4.0));
+    CHECK(!box.intersects(ray, 0.0, 3.5));
+    CHECK(!box.intersects(ray, 6.5, INFINITY));
+    CHECK(!box.intersects({{2.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}}, 0.0, INFINITY));
+  }
+  SUBCASE("Clipping an interval to a bounding box") {
+    auto box = BoundingBox({-1.0, -1.0, -1.0, 1.0}, {1.0, 1.0, 1.0, 1.0});
+    auto ray = Ray({0.0, 0.0, 5.0, 1.0}, {0.0, 0.0, -1.0, 0.0});
+    Scalar tMin = 0.0;
+    Scalar tMax = INFINITY;
+    CHECK(box.clip(ray, tMin, tMax));
+    CHECK(tMin == 4.0);
+    CHECK(tMax == 6.0);
+    tMin = 4.5;
+    tMax = 5.0;
+    CHECK(box.clip(ray, tMin, tMax));
+    CHECK(tMin == 4.5);
+    CHECK(tMax == 5.0);
+  }
+  SUBCASE("A ray running along the face of a bounding box intersects it") {
+    auto box = BoundingBox({-1.0, -1.0, -1.0, 1.0}, {1.0, 1.0, 1.0, 1.0});
+    auto ray = Ray({1.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    CHECK(box.intersects(ray, 0.0, INFINITY));
+  }
   SUBCASE("Splitting a perfect cube") {
     auto box = BoundingBox({-1.0, -4.0, -5.0, 1.0}, {9.0, 6.0, 5.0, 1.0});
     auto boxes = box.split();
@@ -142,4 +171,16 @@ TEST_CASE("Bounding boxes") {
     CHECK(right.min == Tuple(-1.0, -2.0, 2.0, 1.0));
     CHECK(right.max == Tuple(5.0, 3.0, 7.0, 1.0));
   }
-}
\ No newline at end of file
+  SUBCASE("Clipping a box to another box") {
+    auto box = BoundingBox(Tuple::point(-1.0, -2.0, -3.0), Tuple::point(5.0, 8.0, 3.0));
+    auto clipped = box.clipped({Tuple::point(0.0, -5.0, 1.0), Tuple::point(2.0, 5.0, 9.0)});
+    CHECK(clipped.min == Tuple::point(0.0, -2.0, 1.0));
+    CHECK(clipped.max == Tuple::point(2.0, 5.0, 3.0));
+    CHECK_FALSE(clipped.isEmpty());
+  }
+  SUBCASE("Clipping a box to a disjoint box leaves it empty") {
+    auto box = BoundingBox(Tuple::point(-1.0, -1.0, -1.0), Tuple::point(1.0, 1.0, 1.0));
+    CHECK(box.clipped({Tuple::point(2.0, 2.0, 2.0), Tuple::point(3.0, 3.0, 3.0)}).isEmpty());
+    CHECK(BoundingBox().isEmpty());
+  }
+}
@@ -0,0 +1,53 @@
+#include <doctest/doctest.h>
+#include <raytracerchallenge/base/CachedTransform.h>
+
+using namespace raytracerchallenge;
+
+TEST_CASE("Cached transforms") {
+  SUBCASE("A default cached transform and its inverse are the identity") {
+    auto transform = CachedTransform();
+    CHECK(transform == Transform::identity());
+    CHECK(transform.inverse() == Transform::identity());
+    CHECK(transform.normalMatrix() == Transform::identity());
+  }
+  SUBCASE("Assigning a transform updates its inverse") {
+    auto transform = CachedTransform();
+    transform = Matrix::translation(5.0, -3.0, 2.0);
+    CHECK(transform.inverse() == Transform::translation(-5.0, 3.0, -2.0));
+    transform = transform.scaled(2.0, 2.0, 2.0);
+    CHECK(transform.inverse() * Tuple::point(10.0, -6.0, 4.0) == Tuple::point(0.0, 0.0, 0.0));
+  }
+  SUBCASE("The normal matrix is the inverse transpose without translation") {
+    CachedTransform transform = Transform::scaling(1.0, 0.5, 1.0).rotatedZ(0.6).translated(3, 4, 5);
+    auto expected = transform.Transform::inverse().transposed() * Tuple::vector(0.2, 0.7, 0.1);
+    auto normal = transform.normalMatrix() * Tuple::vector(0.2, 0.7, 0.1);
+    CHECK(normal.w == 0.0);
+    normal.w = expected.w;
+    CHECK(normal == expected);
+  }
+  SUBCASE("The normal matrix of a uniform scale is its inverse scale") {
+    CachedTransform transform = Transform::scaling(4.0, 4.0, 4.0).translated(1.0, 2.0, 3.0);
+    CHECK(transform.normalMatrix() == Transform::scaling(0.25, 0.25, 0.25));
+    CHECK(transform.normalMatrix().kind() == TransformKind::UniformScale);
+    CachedTransform translation = Transform::translation(1.0, 2.0, 3.0);
+    CHECK(translation.normalMatrix() == Transform::identity());
+  }
+  SUBCASE("Copying a cached transform copies its inverse") {
+    CachedTransform transform = Transform::rotationX(0.4);
+    auto copy = transform;
+    CHECK(copy.inverse() == Transform::rotationX(-0.4));
+  }
+  SUBCASE("Assigning a transform increments the counter it reports changes to") {
+    auto counter = std::make_shared<std::atomic<std::uint64_t>>(0);
+    auto transform = CachedTransform();
+    transform.reportChangesTo(counter);
+    transform = Transform::translation(1.0, 2.0, 3.0);
+    CHECK(counter->load() == 1);
+    CachedTransform other = Transform::scaling(2.0, 2.0, 2.0);
+    transform = other;
+    CHECK(counter->load() == 2);
+    auto copy = transform;
+    copy = Transform::identity();
+    CHECK(counter->load() == 2);
+  }
+}
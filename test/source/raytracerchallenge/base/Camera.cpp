@@ -12,7 +12,7 @@ TEST_CASE("Camera") {
     auto camera = Camera(160, 120, M_PI / 2.0);
     CHECK(camera.hSize == 160);
     CHECK(camera.vSize == 120);
-    CHECK(camera.fieldOfView == M_PI / 2.0);
+    CHECK(camera.fieldOfView == Scalar(M_PI / 2.0));
     CHECK(camera.transform == Matrix::identity(4));
   }
   SUBCASE("The pixel size for a horizontal canvas") {
@@ -52,4 +52,16 @@ TEST_CASE("Camera") {
     auto image = camera.render(world);
     CHECK(image.pixelAt(5, 5) == Color(0.38066, 0.47583, 0.2855));
   }
+  SUBCASE("Rendering in tiles colors every pixel as its own ray would") {
+    auto world = World::defaultWorld();
+    auto camera = Camera(13, 7, M_PI / 2.0);
+    camera.transform = Matrix::view(Tuple::point(0.5, 1.0, -4.0), Tuple::point(0.0, 0.0, 0.0),
+                                    Tuple::vector(0.0, 1.0, 0.0));
+    auto image = camera.render(world);
+    for (int y = 0; y < camera.vSize; y++) {
+      for (int x = 0; x < camera.hSize; x++) {
+        CHECK(image.pixelAt(x, y) == world.colorAt(camera.rayForPixel(x, y), 4));
+      }
+    }
+  }
 }
\ No newline at end of file
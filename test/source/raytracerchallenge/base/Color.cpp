@@ -7,8 +7,8 @@ TEST_CASE("Colors") {
   SUBCASE("Colors are (red, green, blue) tuples") {
     Color c = Color(-0.5, 0.4, 1.7);
     CHECK(c.red == -0.5);
-    CHECK(c.green == 0.4);
-    CHECK(c.blue == 1.7);
+    CHECK(c.green == Scalar(0.4));
+    CHECK(c.blue == Scalar(1.7));
   }
   SUBCASE("Default Color is black") {
     Color c = Color();
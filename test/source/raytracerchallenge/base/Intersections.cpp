@@ -207,4 +207,45 @@ TEST_CASE("Ray-sphere intersections") {
     CHECK(comps.underPoint.z > 0.0001 / 2.0);
     CHECK(comps.point.z < comps.underPoint.z);
   }
-}
\ No newline at end of file
+  SUBCASE("Intersections and computations do not own their objects") {
+    auto sphere = Sphere::create();
+    auto owners = sphere.use_count();
+    auto r = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    auto xs = sphere->intersect(r);
+    auto comps = xs.hit()->prepareComputations(r, xs);
+    CHECK(xs[0].object == sphere.get());
+    CHECK(comps.object == sphere.get());
+    CHECK(sphere.use_count() == owners);
+  }
+  SUBCASE("Intersections spill beyond the inline buffer and back") {
+    auto sphere = Sphere::create();
+    auto xs = Intersections();
+    auto count = Intersections::inlineCapacity * 3;
+    for (size_t i = 0; i < count; i++) {
+      xs.add(Intersection(Scalar(count - i), sphere));
+    }
+    CHECK(xs.size() == count);
+    xs.sort();
+    for (size_t i = 0; i < count; i++) {
+      CHECK(xs[i].t == Scalar(i + 1));
+    }
+    xs.truncate(3);
+    CHECK(xs.size() == 3);
+    CHECK(xs[2].t == 3.0);
+    CHECK(xs.hit()->t == 1.0);
+    xs.clear();
+    CHECK(xs.empty());
+    CHECK_FALSE(xs.hit().has_value());
+  }
+  SUBCASE("Shapes append to the collection they are given") {
+    auto sphere = Sphere::create();
+    auto r = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    auto xs = Intersections({{-1.0, sphere}});
+    sphere->intersect(r, xs);
+    sphere->intersect(r, xs);
+    CHECK(xs.size() == 5);
+    CHECK(xs[0].t == -1.0);
+    CHECK(xs[1].t == 4.0);
+    CHECK(xs[4].t == 6.0);
+  }
+}
@@ -13,7 +13,7 @@ TEST_CASE("Lighting") {
     auto eyeVector = Tuple::vector(0.0, 0.0, -1.0);
     auto normalVector = Tuple::vector(0.0, 0.0, -1.0);
     auto light = PointLight(Tuple::point(0.0, 0.0, -10.0), Color(1.0, 1.0, 1.0));
-    auto result = lighting(s, light, position, eyeVector, normalVector, false);
+    auto result = lighting(*s, light, position, eyeVector, normalVector, false);
     CHECK(result == Color(1.9, 1.9, 1.9));
   }
   SUBCASE("Lighting with the eye between the light and the surface, eye offset 45 degrees") {
@@ -22,7 +22,7 @@ TEST_CASE("Lighting") {
     auto eyeVector = Tuple::vector(0.0, sqrt(2.0) / 2.0, -sqrt(2.0) / 2.0);
     auto normalVector = Tuple::vector(0.0, 0.0, -1.0);
     auto light = PointLight(Tuple::point(0.0, 0.0, -10.0), Color(1.0, 1.0, 1.0));
-    auto result = lighting(s, light, position, eyeVector, normalVector, false);
+    auto result = lighting(*s, light, position, eyeVector, normalVector, false);
     CHECK(result == Color(1.0, 1.0, 1.0));
   }
   SUBCASE("Lighting with the eye opposite surface, light offset 45 degrees") {
@@ -31,7 +31,7 @@ TEST_CASE("Lighting") {
     auto eyeVector = Tuple::vector(0.0, 0.0, -1.0);
     auto normalVector = Tuple::vector(0.0, 0.0, -1.0);
     auto light = PointLight(Tuple::point(0.0, 10.0, -10.0), Color(1.0, 1.0, 1.0));
-    auto result = lighting(s, light, position, eyeVector, normalVector, false);
+    auto result = lighting(*s, light, position, eyeVector, normalVector, false);
     CHECK(result == Color(0.7364, 0.7364, 0.7364));
   }
   SUBCASE("Lighting with eye in the path of the reflection vector") {
@@ -40,7 +40,7 @@ TEST_CASE("Lighting") {
     auto eyeVector = Tuple::vector(0.0, -sqrt(2.0) / 2.0, -sqrt(2.0) / 2.0);
     auto normalVector = Tuple::vector(0.0, 0.0, -1.0);
     auto light = PointLight(Tuple::point(0.0, 10.0, -10.0), Color(1.0, 1.0, 1.0));
-    auto result = lighting(s, light, position, eyeVector, normalVector, false);
+    auto result = lighting(*s, light, position, eyeVector, normalVector, false);
     CHECK(result == Color(1.63638, 1.63638, 1.63638));
   }
   SUBCASE("Lighting with the light behind the surface") {
@@ -49,7 +49,7 @@ TEST_CASE("Lighting") {
     auto eyeVector = Tuple::vector(0.0, 0.0, -1.0);
     auto normalVector = Tuple::vector(0.0, 0.0, -1.0);
     auto light = PointLight(Tuple::point(0.0, 0.0, 10.0), Color(1.0, 1.0, 1.0));
-    auto result = lighting(s, light, position, eyeVector, normalVector, false);
+    auto result = lighting(*s, light, position, eyeVector, normalVector, false);
     CHECK(result == Color(0.1, 0.1, 0.1));
   }
   SUBCASE("Lighting with the surface in shadow") {
@@ -58,7 +58,7 @@ TEST_CASE("Lighting") {
     auto eyeVector = Tuple::vector(0.0, 0.0, -1.0);
     auto normalVector = Tuple::vector(0.0, 0.0, -1.0);
     auto light = PointLight(Tuple::point(0.0, 0.0, -10.0), Color(1.0, 1.0, 1.0));
-    auto result = lighting(s, light, position, eyeVector, normalVector, true);
+    auto result = lighting(*s, light, position, eyeVector, normalVector, true);
     CHECK(result == Color(0.1, 0.1, 0.1));
   }
   SUBCASE("Lighting with a pattern applied") {
@@ -71,8 +71,8 @@ TEST_CASE("Lighting") {
     auto eyeVector = Tuple::vector(0.0, 0.0, -1.0);
     auto normalVector = Tuple::vector(0.0, 0.0, -1.0);
     auto light = PointLight(Tuple::point(0.0, 0.0, -10.0), Color(1.0, 1.0, 1.0));
-    auto c1 = lighting(s, light, {0.9, 0.0, 0.0, 1.0}, eyeVector, normalVector, false);
-    auto c2 = lighting(s, light, {1.1, 0.0, 0.0, 1.0}, eyeVector, normalVector, false);
+    auto c1 = lighting(*s, light, {0.9, 0.0, 0.0, 1.0}, eyeVector, normalVector, false);
+    auto c2 = lighting(*s, light, {1.1, 0.0, 0.0, 1.0}, eyeVector, normalVector, false);
     CHECK(c1 == WHITE);
     CHECK(c2 == BLACK);
   }
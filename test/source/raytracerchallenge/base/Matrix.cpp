@@ -4,6 +4,7 @@
 #include <raytracerchallenge/base/Tuple.h>
 
 #include <cmath>
+#include <thread>
 #include <vector>
 
 using namespace raytracerchallenge;
@@ -210,6 +211,57 @@ TEST_CASE("Matrices") {
     Matrix product = matrix1 * matrix2;
     CHECK(product * matrix2.inverse() == matrix1);
   }
+  SUBCASE("The cached inverse follows changes to the matrix") {
+    auto matrix = Matrix::scaling(2.0, 4.0, 8.0);
+    CHECK(matrix.inverse() == Matrix::scaling(0.5, 0.25, 0.125));
+    auto copy = matrix;
+    CHECK(copy.inverse() == Matrix::scaling(0.5, 0.25, 0.125));
+    matrix.m(0, 0) = 10.0;
+    CHECK(matrix.inverse() == Matrix::scaling(0.1, 0.25, 0.125));
+    matrix = Matrix::translation(1.0, 2.0, 3.0);
+    CHECK(matrix.inverse() == Matrix::translation(-1.0, -2.0, -3.0));
+    CHECK(copy.inverse() == Matrix::scaling(0.5, 0.25, 0.125));
+  }
+  SUBCASE("Threads can share a matrix's inverse") {
+    const auto matrix = Matrix::rotationY(0.7).translated(1.0, 2.0, 3.0);
+    const auto expected = Matrix(MatrixXd(matrix.m.inverse()));
+    std::vector<int> correct(8, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < correct.size(); i++) {
+      threads.emplace_back([&matrix, &expected, &correct, i]() {
+        for (int j = 0; j < 1000; j++) {
+          correct[i] += matrix.inverse() == expected ? 1 : 0;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (auto count : correct) {
+      CHECK(count == 1000);
+    }
+  }  SUBCASE("Threads can share a matrix's inverse after it is modified in place") {
+    auto matrix = Matrix::rotationY(0.7).translated(1.0, 2.0, 3.0);
+    CHECK(matrix.inverse() == Matrix(MatrixXd(matrix.m.inverse())));
+    matrix.m(0, 3) = 5.0;
+    const auto expected = Matrix(MatrixXd(matrix.m.inverse()));
+    std::vector<int> correct(8, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < correct.size(); i++) {
+      threads.emplace_back([&matrix, &expected, &correct, i]() {
+        for (int j = 0; j < 1000; j++) {
+          correct[i] += matrix.inverse() == expected ? 1 : 0;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (auto count : correct) {
+      CHECK(count == 1000);
+    }
+    CHECK(Matrix(matrix).inverse() == expected);
+  }
 }
 TEST_CASE("Matrix transformations") {
   using namespace raytracerchallenge;
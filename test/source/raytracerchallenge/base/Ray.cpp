@@ -40,4 +40,27 @@ TEST_CASE("Rays") {
     CHECK(ray2.origin == Tuple::point(2.0, 6.0, 12.0));
     CHECK(ray2.direction == Tuple::vector(0.0, 3.0, 0.0));
   }
-}
\ No newline at end of file
+  SUBCASE("A ray precomputes its inverse direction and signs") {
+    Ray ray(Tuple::point(0.0, 0.0, 0.0), Tuple::vector(2.0, -4.0, 0.0));
+    CHECK(ray.inverseDirection.x == 0.5);
+    CHECK(ray.inverseDirection.y == -0.25);
+    CHECK(ray.inverseDirection.z == INFINITY);
+    CHECK(ray.sign[0] == 0);
+    CHECK(ray.sign[1] == 1);
+    CHECK(ray.sign[2] == 0);
+  }
+  SUBCASE("A transformed ray recomputes its inverse direction") {
+    Ray ray(Tuple::point(1.0, 2.0, 3.0), Tuple::vector(0.0, 1.0, 0.0));
+    Ray ray2 = ray.transform(Transform::scaling(2.0, -4.0, 4.0));
+    CHECK(ray2.inverseDirection.y == -0.25);
+    CHECK(ray2.sign[1] == 1);
+  }
+  SUBCASE("A translated ray keeps its inverse direction") {
+    Ray ray(Tuple::point(1.0, 2.0, 3.0), Tuple::vector(0.0, -2.0, 4.0));
+    Ray ray2 = ray.transform(Transform::translation(3.0, 4.0, 5.0));
+    CHECK(ray2.origin == Tuple::point(4.0, 6.0, 8.0));
+    CHECK(ray2.direction == ray.direction);
+    CHECK(ray2.inverseDirection == ray.inverseDirection);
+    CHECK(ray2.sign[1] == 1);
+  }
+}
@@ -0,0 +1,94 @@
+#define _USE_MATH_DEFINES
+#include <doctest/doctest.h>
+#include <raytracerchallenge/base/Transform.h>
+
+#include <cmath>
+
+using namespace raytracerchallenge;
+
+TEST_CASE("Transforms") {
+  SUBCASE("A default transform is the identity") {
+    CHECK(Transform() == Matrix::identity(4));
+    CHECK(Transform().isAffine());
+  }
+  SUBCASE("A transform can be assigned from a Matrix") {
+    Transform transform = Matrix::translation(5.0, -3.0, 2.0);
+    CHECK(transform == Transform::translation(5.0, -3.0, 2.0));
+    CHECK(transform * Tuple::point(-3.0, 4.0, 5.0) == Tuple::point(2.0, 1.0, 7.0));
+  }
+  SUBCASE("Transforms which are approximately equal are not unequal") {
+    auto transform = Transform::translation(5.0, -3.0, 2.0);
+    auto nearly = Transform::translation(5.0, -3.0, 2.00001);
+    CHECK(transform == nearly);
+    CHECK_FALSE(transform != nearly);
+    CHECK(transform != Transform::translation(5.0, -3.0, 2.1));
+  }
+  SUBCASE("Builders match their Matrix equivalents") {
+    auto transform = Transform::rotationX(M_PI / 2.0)
+                         .scaled(5.0, 5.0, 5.0)
+                         .translated(10.0, 5.0, 7.0)
+                         .sheared(1.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+    auto matrix = Matrix::rotationX(M_PI / 2.0)
+                      .scaled(5.0, 5.0, 5.0)
+                      .translated(10.0, 5.0, 7.0)
+                      .sheared(1.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+    CHECK(transform == matrix);
+    auto from = Tuple::point(1.0, 3.0, 2.0);
+    auto to = Tuple::point(4.0, -2.0, 8.0);
+    auto up = Tuple::vector(1.0, 1.0, 0.0);
+    CHECK(Transform::view(from, to, up) == Matrix::view(from, to, up));
+  }
+  SUBCASE("The inverse of an affine transform") {
+    auto transform = Transform::rotationY(0.3).scaled(2.0, 3.0, 4.0).translated(1.0, -2.0, 3.0);
+    CHECK(transform.isAffine());
+    auto inverse = transform.inverse();
+    CHECK(inverse.isAffine());
+    CHECK(inverse * transform == Transform::identity());
+    auto point = Tuple::point(0.5, 1.5, -2.5);
+    CHECK(inverse * (transform * point) == point);
+  }
+  SUBCASE("A transform with a projective bottom row") {
+    auto matrix = Matrix(4, 4,
+                         {{1.0, 0.0, 0.0, 0.0},
+                          {0.0, 1.0, 0.0, 0.0},
+                          {0.0, 0.0, 1.0, 0.0},
+                          {0.0, 0.0, 1.0, 0.0}});
+    Transform transform = matrix;
+    CHECK_FALSE(transform.isAffine());
+    CHECK(transform * Tuple(1.0, 2.0, 3.0, 1.0) == Tuple(1.0, 2.0, 3.0, 3.0));
+    CHECK_FALSE((transform * Transform::translation(1.0, 0.0, 0.0)).isAffine());
+  }
+  SUBCASE("Transforming a vector ignores translation") {
+    auto transform = Transform::translation(5.0, -3.0, 2.0);
+    CHECK(transform * Tuple::vector(-3.0, 4.0, 5.0) == Tuple::vector(-3.0, 4.0, 5.0));
+    CHECK(transform.determinant() == 1.0);
+  }
+  SUBCASE("Builders are tagged with their kind") {
+    CHECK(Transform().kind() == TransformKind::Translation);
+    CHECK(Transform::translation(1.0, 2.0, 3.0).kind() == TransformKind::Translation);
+    CHECK(Transform::scaling(2.0, 2.0, 2.0).kind() == TransformKind::UniformScale);
+    CHECK(Transform::scaling(2.0, 3.0, 2.0).kind() == TransformKind::Affine);
+    CHECK(Transform::rotationY(0.3).kind() == TransformKind::Affine);
+    CHECK(Transform::scaling(2.0, 2.0, 2.0).translated(1.0, 0.0, 0.0).kind()
+          == TransformKind::UniformScale);
+    CHECK(Transform::translation(1.0, 0.0, 0.0).rotatedX(0.5).kind() == TransformKind::Affine);
+    Transform fromMatrix = Matrix::scaling(3.0, 3.0, 3.0).translated(1.0, 2.0, 3.0);
+    CHECK(fromMatrix.kind() == TransformKind::UniformScale);
+  }
+  SUBCASE("Translations and uniform scales match the general product") {
+    auto translation = Transform::translation(1.0, -2.0, 3.0);
+    auto scale = Transform::scaling(-2.5, -2.5, -2.5).translated(0.5, 1.5, -4.0);
+    auto point = Tuple::point(0.3, -1.7, 2.2);
+    for (const auto &transform : {translation, scale, translation * scale, scale * translation}) {
+      Eigen::Matrix<Scalar, 4, 1> expected
+          = transform.m * Eigen::Matrix<Scalar, 4, 1>(point.x, point.y, point.z, point.w);
+      CHECK(transform * point == Tuple(expected.x(), expected.y(), expected.z(), expected.w()));
+      CHECK(transform.inverse() * (transform * point) == point);
+      CHECK(transform.inverse() * transform == Transform::identity());
+      CHECK(std::abs(transform.determinant() - transform.m.determinant()) < 1e-3);
+    }
+    CHECK((translation * scale).kind() == TransformKind::UniformScale);
+    CHECK(translation.inverse().kind() == TransformKind::Translation);
+    CHECK(scale.inverse().kind() == TransformKind::UniformScale);
+  }
+}
@@ -16,17 +16,17 @@ TEST_CASE("Tuples") {
   }
   SUBCASE("A tuple with w=0.1 is a point") {
     Tuple tuple = Tuple(4.3, -4.2, 3.1, 1.0);
-    CHECK(tuple.x == 4.3);
-    CHECK(tuple.y == -4.2);
-    CHECK(tuple.z == 3.1);
+    CHECK(tuple.x == Scalar(4.3));
+    CHECK(tuple.y == Scalar(-4.2));
+    CHECK(tuple.z == Scalar(3.1));
     CHECK(tuple.w == 1.0);
     CHECK(tuple.isVector() == false);
   }
   SUBCASE("A tuple with w=0.0 is a vector") {
     Tuple tuple = Tuple(4.3, -4.2, 3.1, 0.0);
-    CHECK(tuple.x == 4.3);
-    CHECK(tuple.y == -4.2);
-    CHECK(tuple.z == 3.1);
+    CHECK(tuple.x == Scalar(4.3));
+    CHECK(tuple.y == Scalar(-4.2));
+    CHECK(tuple.z == Scalar(3.1));
     CHECK(tuple.w == 0.0);
     CHECK(tuple.isVector() == true);
   }
@@ -137,4 +137,24 @@ TEST_CASE("Tuples") {
     auto r = v.reflect(n);
     CHECK(r == Tuple::vector(1.0, 0.0, 0.0));
   }
-}
\ No newline at end of file
+  SUBCASE("Normalizing keeps full double precision") {
+    for (auto length : {1e-30, 1e-3, 1.0, 3.0, 7.5e4, 1e40}) {
+      auto v = BasicTuple<double>::vector(length, 2.0 * length, -2.0 * length).normalize();
+      CHECK(std::abs(v.x - 1.0 / 3.0) < 1e-15);
+      CHECK(std::abs(v.magnitude() - 1.0) < 1e-15);
+    }
+  }
+  SUBCASE("Normalizing keeps full float precision") {
+    for (auto length : {1e-15F, 1e-3F, 1.0F, 3.0F, 7.5e4F, 1e15F}) {
+      auto v = BasicTuple<float>::vector(length, 2.0F * length, -2.0F * length).normalize();
+      CHECK(std::abs(v.x - 1.0F / 3.0F) < 1e-7F);
+      CHECK(std::abs(v.magnitude() - 1.0F) < 1e-6F);
+    }
+    CHECK(BasicTuple<float>::vector(0.0F, 0.0F, 1.0F).normalize().z == 1.0F);
+  }
+  SUBCASE("Negating a tuple keeps the sign of zero") {
+    auto v = -Tuple::vector(0.0, 1.0, 0.0);
+    CHECK(std::signbit(v.x));
+    CHECK(std::signbit(v.z));
+  }
+}
@@ -1,9 +1,13 @@
+#define _USE_MATH_DEFINES
 #include <doctest/doctest.h>
 #include <raytracerchallenge/base/World.h>
 #include <raytracerchallenge/patterns/Pattern.h>
 #include <raytracerchallenge/shapes/Plane.h>
 #include <raytracerchallenge/shapes/Sphere.h>
 
+#include <cmath>
+#include <vector>
+
 using namespace raytracerchallenge;
 
 TEST_CASE("World") {
@@ -111,9 +115,158 @@ TEST_CASE("World") {
   SUBCASE("There is no shadow when the object does not cast shadows") {
     auto world = World::defaultWorld();
     world.objects[0]->material->castShadow = false;
+    world.objects[1]->material->castShadow = false;
     auto point = Tuple::point(10.0, -10.0, 10.0);
     CHECK(world.isShadowed(point) == false);
   }
+  SUBCASE("An object behind one which does not cast shadows still casts a shadow") {
+    auto world = World::defaultWorld();
+    world.objects[0]->material->castShadow = false;
+    auto point = Tuple::point(10.0, -10.0, 10.0);
+    CHECK(world.isShadowed(point));
+  }
+  SUBCASE("Occlusion is limited to the segment between two points") {
+    auto world = World::defaultWorld();
+    CHECK(world.occluded(Tuple::point(0.0, 0.0, -5.0), Tuple::point(0.0, 0.0, 5.0)));
+    CHECK_FALSE(world.occluded(Tuple::point(0.0, 0.0, -5.0), Tuple::point(0.0, 0.0, -2.0)));
+    CHECK_FALSE(world.occluded(Tuple::point(0.0, 0.0, 5.0), Tuple::point(0.0, 0.0, 1.5)));
+    CHECK_FALSE(world.occluded(Tuple::point(0.0, 2.0, -5.0), Tuple::point(0.0, 2.0, 5.0)));
+  }
+  SUBCASE("Unbounded objects occlude segments which cross them") {
+    auto world = World();
+    auto plane = Plane::create();
+    world.add(plane);
+    CHECK(world.occluded(Tuple::point(100.0, 1.0, 0.0), Tuple::point(100.0, -1.0, 0.0)));
+    CHECK_FALSE(world.occluded(Tuple::point(100.0, 1.0, 0.0), Tuple::point(100.0, 0.5, 0.0)));
+    plane->material->castShadow = false;
+    CHECK_FALSE(world.occluded(Tuple::point(100.0, 1.0, 0.0), Tuple::point(100.0, -1.0, 0.0)));
+  }
+  SUBCASE("Intersecting a world with many objects") {
+    World world;
+    for (int i = 0; i < 50; i++) {
+      auto s = Sphere::create();
+      s->transform = Matrix::translation(i % 10 - 5.0, i / 10 - 2.5, 2.0 * (i % 3));
+      world.add(s);
+    }
+    for (int i = 0; i < 20; i++) {
+      auto ray = Ray(Tuple::point(i * 0.5 - 5.0, 0.0, -5.0),
+                     Tuple::vector(0.1 * (i % 3), 0.05 * i - 0.5, 1.0).normalize());
+      Intersections expected;
+      for (const auto &object : world.objects) {
+        expected.addAll(object->intersect(ray));
+      }
+      expected.sort();
+      auto xs = world.intersect(ray);
+      CHECK(xs.size() == expected.size());
+      for (size_t j = 0; j < xs.size() && j < expected.size(); j++) {
+        CHECK(xs[j] == expected[j]);
+      }
+    }
+  }
+  SUBCASE("Finding the closest intersection in the world") {
+    auto world = World::defaultWorld();
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    auto hit = world.intersectClosest(ray);
+    CHECK(hit.has_value());
+    CHECK(hit->t == 4.0);
+    CHECK(hit->object == world.objects[0].get());
+    hit = world.intersectClosest(ray, 4.2);
+    CHECK(hit.has_value());
+    CHECK(hit->t == 4.5);
+    CHECK(hit->object == world.objects[1].get());
+    CHECK_FALSE(world.intersectClosest(ray, 0.0, 4.0).has_value());
+  }
+  SUBCASE("The closest intersection may be with an unbounded object") {
+    auto world = World::defaultWorld();
+    auto plane = Plane::create();
+    plane->transform = Matrix::rotationX(M_PI / 2.0).translated(0.0, 0.0, -2.0);
+    world.add(plane);
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    auto hit = world.intersectClosest(ray);
+    CHECK(hit.has_value());
+    CHECK(hit->object == plane.get());
+    CHECK(hit->t == 3.0);
+  }
+  SUBCASE("Unbounded objects are intersected alongside the hierarchy") {
+    auto world = World::defaultWorld();
+    auto plane = Plane::create();
+    plane->transform = Matrix::translation(0.0, -100.0, 0.0);
+    world.add(plane);
+    auto ray = Ray(Tuple::point(500.0, 0.0, 0.0), Tuple::vector(0.0, -1.0, 0.0));
+    auto xs = world.intersect(ray);
+    CHECK(xs.size() == 1);
+    CHECK(xs[0].object == plane.get());
+  }
+  SUBCASE("Tracing rays in packets gives the colors of tracing them alone") {
+    auto world = World::defaultWorld();
+    world.objects[1]->material->reflective = 0.5;
+    auto glass = Sphere::create();
+    glass->transform = Matrix::translation(1.5, 0.5, -1.0).scaled(0.5, 0.5, 0.5);
+    glass->material->transparency = 0.8;
+    glass->material->refractiveIndex = 1.5;
+    world.add(glass);
+    auto floor = Plane::create();
+    floor->transform = Matrix::translation(0.0, -1.0, 0.0);
+    world.add(floor);
+    std::vector<Ray> rays;
+    std::vector<Tuple> points;
+    for (int i = 0; i < 37; i++) {
+      auto target = Tuple::point(i % 6 * 0.5 - 1.2, i / 6 * 0.4 - 1.2, 0.0);
+      auto origin = Tuple::point(0.0, 0.5, -5.0);
+      rays.emplace_back(origin, (target - origin).normalize());
+      points.push_back(Tuple::point(i % 6 * 0.7 - 2.0, -0.99, i / 6 * 0.5 - 1.5));
+    }
+    // A LinearBVH traces the rays in packets; a WideBVH traces them one at a time
+    for (auto width : {2U, 4U, 8U}) {
+      auto options = BVHOptions();
+      options.width = width;
+      world.build(options);
+      for (auto count : {1U, 3U, 7U, 16U, 37U}) {
+        std::vector<Color> colors(count);
+        world.colorAt(rays.data(), count, 4, colors.data());
+        std::vector<std::optional<Intersection>> hits(count);
+        world.intersectClosest(rays.data(), count, hits.data());
+        bool blocked[37];
+        world.occluded(points.data(), count, world.light->position, blocked);
+        for (auto i = 0U; i < count; i++) {
+          CHECK(colors[i] == world.colorAt(rays[i], 4));
+          auto hit = world.intersectClosest(rays[i]);
+          CHECK(hits[i].has_value() == hit.has_value());
+          CHECK((!hit.has_value() || *hits[i] == *hit));
+          CHECK(blocked[i] == world.isShadowed(points[i]));
+        }
+      }
+    }
+  }
+  SUBCASE("Adding an object after intersecting rebuilds the hierarchy") {
+    auto world = World::defaultWorld();
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(world.intersect(ray).size() == 4);
+    auto s = Sphere::create();
+    s->transform = Matrix::translation(0.0, 0.0, 10.0);
+    world.add(s);
+    CHECK(world.intersect(ray).size() == 6);
+  }
+  SUBCASE("Refitting the world after an object has moved") {
+    auto world = World::defaultWorld();
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(world.intersect(ray).size() == 4);
+    world.objects[0]->transform = Matrix::translation(0.0, 0.0, 10.0);
+    world.refit();
+    auto xs = world.intersect(ray);
+    CHECK(xs.size() == 4);
+    CHECK(xs[3].t == 16.0);
+  }
+  SUBCASE("Moving an object requires an explicit rebuild") {
+    auto world = World::defaultWorld();
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(world.intersect(ray).size() == 4);
+    world.objects[0]->transform = Matrix::translation(0.0, 0.0, 10.0);
+    world.build();
+    auto xs = world.intersect(ray);
+    CHECK(xs.size() == 4);
+    CHECK(xs[3].t == 16.0);
+  }
 }
 TEST_CASE("Reflection") {
   using namespace raytracerchallenge;
@@ -219,7 +372,7 @@ TEST_CASE("Reflection") {
   SUBCASE("The refracted color with a refracted ray") {
     class TestPattern : public Pattern {
     public:
-      [[nodiscard]] Color colorAt(std::shared_ptr<Shape> shape, Tuple point) override {
+      [[nodiscard]] Color colorAt(const Shape &shape, Tuple point) override {
         (void)shape;
         return {point.x, point.y, point.z};
       }
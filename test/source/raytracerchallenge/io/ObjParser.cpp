@@ -3,6 +3,7 @@
 #include <raytracerchallenge/io/ObjParser.h>
 #include <raytracerchallenge/shapes/SmoothTriangle.h>
 #include <raytracerchallenge/shapes/Triangle.h>
+#include <raytracerchallenge/shapes/TriangleMesh.h>
 
 #include <memory>
 
@@ -161,4 +162,39 @@ TEST_CASE("OBJ file parser") {
     CHECK(t1->n3 == res.normals[2]);
     CHECK(*t1 == *t2);
   }
+  SUBCASE("Collecting faces into triangle meshes") {
+    auto f = std::stringstream(
+        ""
+        "v -1 1 0\n"
+        "v -1 0 0\n"
+        "v 1 0 0\n"
+        "v 1 1 0\n"
+        "vn 0 0 1\n"
+        "f 1 2 3 4\n"
+        "g Smooth\n"
+        "f 1//1 3//1 4//1\n"
+        "");
+    auto options = ObjParserOptions();
+    options.triangleMeshes = true;
+    auto res = ObjParser::parse(f, options);
+    auto flatObjects = std::dynamic_pointer_cast<Group>(res.defaultGroup)->objects;
+    auto smoothObjects = std::dynamic_pointer_cast<Group>(res.groups["Smooth"])->objects;
+    CHECK(flatObjects.size() == 1);
+    CHECK(smoothObjects.size() == 1);
+    auto flat = std::dynamic_pointer_cast<TriangleMesh>(flatObjects[0]);
+    auto smooth = std::dynamic_pointer_cast<TriangleMesh>(smoothObjects[0]);
+    CHECK(flat->triangleCount() == 2);
+    CHECK_FALSE(flat->isSmooth());
+    CHECK(smooth->triangleCount() == 1);
+    CHECK(smooth->isSmooth());
+    CHECK(flat->vertices == smooth->vertices);
+    CHECK(flat->vertices->point(4) == res.vertices[4]);
+    CHECK_FALSE(flat->watertight);
+    options.watertight = true;
+    f.clear();
+    f.seekg(0);
+    res = ObjParser::parse(f, options);
+    flatObjects = std::dynamic_pointer_cast<Group>(res.defaultGroup)->objects;
+    CHECK(std::dynamic_pointer_cast<TriangleMesh>(flatObjects[0])->watertight);
+  }
 }
\ No newline at end of file
@@ -28,8 +28,8 @@ TEST_CASE("Constructive Solid Geometry") {
                              Intersection(4.0, s2)});
     auto result = cc->filterIntersections(xs);
     CHECK(result.size() == 2);
-    CHECK(result.intersections[0] == Intersection(1, s1));
-    CHECK(result.intersections[1] == Intersection(4, s2));
+    CHECK(result[0] == Intersection(1, s1));
+    CHECK(result[1] == Intersection(4, s2));
   }
   SUBCASE("Filtering intersections for an Intersection") {
     auto s1 = Sphere::create();
@@ -40,8 +40,8 @@ TEST_CASE("Constructive Solid Geometry") {
                              Intersection(4.0, s2)});
     auto result = cc->filterIntersections(xs);
     CHECK(result.size() == 2);
-    CHECK(result.intersections[0] == Intersection(2.0, s2));
-    CHECK(result.intersections[1] == Intersection(3.0, s1));
+    CHECK(result[0] == Intersection(2.0, s2));
+    CHECK(result[1] == Intersection(3.0, s1));
   }
   SUBCASE("Filtering intersections for a Difference") {
     auto s1 = Sphere::create();
@@ -52,8 +52,8 @@ TEST_CASE("Constructive Solid Geometry") {
                              Intersection(4.0, s2)});
     auto result = cc->filterIntersections(xs);
     CHECK(result.size() == 2);
-    CHECK(result.intersections[0] == Intersection(1.0, s1));
-    CHECK(result.intersections[1] == Intersection(2.0, s2));
+    CHECK(result[0] == Intersection(1.0, s1));
+    CHECK(result[1] == Intersection(2.0, s2));
   }
   SUBCASE("A ray misses a CSG object") {
     auto s1 = Sphere::create();
@@ -72,9 +72,9 @@ TEST_CASE("Constructive Solid Geometry") {
     auto xs = c->localIntersect(r);
     CHECK(xs.size() == 2);
     CHECK(xs[0].t == 4);
-    CHECK(xs[0].object == s1);
+    CHECK(xs[0].object == s1.get());
     CHECK(xs[1].t == 6.5);
-    CHECK(xs[1].object == s2);
+    CHECK(xs[1].object == s2.get());
   }
   SUBCASE("A CSG has a bounding box which contains its children") {
     auto left = Sphere::create();
@@ -2,6 +2,8 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Cone.h>
 
+#include <type_traits>
+
 using namespace raytracerchallenge;
 
 static Intersections getIntersectionsForCone(const std::shared_ptr<Shape>& cone, Tuple origin,
@@ -41,6 +43,12 @@ TEST_CASE("Cones") {
                                         Tuple(0.0, 1.0, 0.0, 0.0).normalize());
     CHECK(res3.size() == 4);
   }
+  SUBCASE("Only single precision allows for rounding in a grazing ray's discriminant") {
+    auto cone = Cone::create();
+    auto res = getIntersectionsForCone(cone, Tuple(1.000005, 1.0, -5.0, 1.0),
+                                       Tuple(0.0, 0.0, 1.0, 0.0));
+    CHECK(res.size() == (std::is_same_v<Scalar, float> ? 2U : 0U));
+  }
   SUBCASE("Computing the normal vector on a cone") {
     auto cone = Cone::create();
     CHECK(cone->localNormalAt({0.0, 0.0, 0.0, 1.0}, {}) == Tuple(0.0, 0.0, 0.0, 0.0));
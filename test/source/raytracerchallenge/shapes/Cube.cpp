@@ -67,4 +67,14 @@ TEST_CASE("Cubes") {
     CHECK(b.min == Tuple(-1.0, -1.0, -1.0, 1.0));
     CHECK(b.max == Tuple(1.0, 1.0, 1.0, 1.0));
   }
-}
\ No newline at end of file
+  SUBCASE("Testing a segment against a cube for any intersection") {
+    auto cube = Cube::create();
+    auto ray = Ray({0.5, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    CHECK(cube->localIntersectsAny(ray, 0.0, INFINITY));
+    CHECK(cube->localIntersectsAny(ray, 5.5, 6.5));
+    CHECK_FALSE(cube->localIntersectsAny(ray, 0.0, 4.0));
+    CHECK_FALSE(cube->localIntersectsAny(ray, 6.5, INFINITY));
+    CHECK_FALSE(cube->localIntersectsAny({{2.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}}, 0.0,
+                                         INFINITY));
+  }
+}
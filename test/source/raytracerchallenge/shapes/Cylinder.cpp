@@ -2,6 +2,8 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Cylinder.h>
 
+#include <type_traits>
+
 using namespace raytracerchallenge;
 
 static Intersections getIntersectionsForCylinder(const std::shared_ptr<Shape>& cylinder,
@@ -84,6 +86,12 @@ TEST_CASE("Cylinders") {
                                             Tuple(0.0, 1.0, 1.0, 0.0).normalize());
     CHECK(res5.size() == 2);
   }
+  SUBCASE("Only single precision allows for rounding at the rim of an end cap") {
+    auto cyl = Cylinder::create(1.0, 2.0, true);
+    auto res = getIntersectionsForCylinder(cyl, Tuple(1.00003, 3.0, 0.0, 1.0),
+                                           Tuple(0.0, -1.0, 0.0, 0.0));
+    CHECK(res.size() == (std::is_same_v<Scalar, float> ? 2U : 0U));
+  }
   SUBCASE("The normal vector on a cylinder's end caps") {
     auto cone = Cylinder::create(1.0, 2.0, true);
     CHECK(cone->localNormalAt({0.0, 1.0, 0.0, 1.0}, {}) == Tuple(0.0, -1.0, 0.0, 0.0));
@@ -2,6 +2,7 @@
 #include <doctest/doctest.h>
 #include <raytracerchallenge/shapes/Cylinder.h>
 #include <raytracerchallenge/shapes/Group.h>
+#include <raytracerchallenge/shapes/Plane.h>
 #include <raytracerchallenge/shapes/Sphere.h>
 
 #include <cmath>
@@ -39,10 +40,41 @@ TEST_CASE("Groups") {
     std::dynamic_pointer_cast<Group>(g)->add(s3);
     auto r = Ray({0.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
     auto xs = g->localIntersect(r);
-    CHECK(xs[0].object == s2);
-    CHECK(xs[1].object == s2);
-    CHECK(xs[2].object == s1);
-    CHECK(xs[3].object == s1);
+    CHECK(xs[0].object == s2.get());
+    CHECK(xs[1].object == s2.get());
+    CHECK(xs[2].object == s1.get());
+    CHECK(xs[3].object == s1.get());
+  }
+  SUBCASE("Finding the closest intersection with a group") {
+    auto g = Group::create();
+    auto s1 = Sphere::create();
+    auto s2 = Sphere::create();
+    s2->transform = s2->transform.translated(0.0, 0.0, -3.0);
+    std::dynamic_pointer_cast<Group>(g)->add(s1);
+    std::dynamic_pointer_cast<Group>(g)->add(s2);
+    auto r = Ray({0.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    auto closest = Intersection();
+    CHECK(g->intersectClosest(r, 0.0, INFINITY, closest));
+    CHECK(closest.t == 1.0);
+    CHECK(closest.object == s2.get());
+    CHECK(g->intersectClosest(r, 3.5, INFINITY, closest));
+    CHECK(closest.t == 4.0);
+    CHECK(closest.object == s1.get());
+    CHECK_FALSE(g->intersectClosest(r, 0.0, 1.0, closest));
+    CHECK_FALSE(g->intersectClosest(r, 6.5, INFINITY, closest));
+  }
+  SUBCASE("Testing a segment against a group for any intersection") {
+    auto g = Group::create();
+    auto s1 = Sphere::create();
+    auto s2 = Sphere::create();
+    s2->transform = s2->transform.translated(0.0, 0.0, -3.0);
+    std::dynamic_pointer_cast<Group>(g)->add(s1);
+    std::dynamic_pointer_cast<Group>(g)->add(s2);
+    auto r = Ray({0.0, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    CHECK(g->intersectsAny(r, 0.0, INFINITY));
+    CHECK(g->intersectsAny(r, 3.5, 4.5));
+    CHECK_FALSE(g->intersectsAny(r, 0.0, 1.0));
+    CHECK_FALSE(g->intersectsAny(r, 6.5, INFINITY));
   }
   SUBCASE("Intersecting a transformed group") {
     auto g = Group::create();
@@ -90,6 +122,90 @@ TEST_CASE("Groups") {
     auto n = s->normalAt({1.7321, 1.1547, -5.5774, 1.0}, {});
     CHECK(n == Tuple(0.2857, 0.4286, -0.8571, 0.0));
   }
+  SUBCASE("A frozen child converts points and normals with composed transforms") {
+    auto g1 = Group::create();
+    g1->transform = g1->transform.rotatedY(M_PI / 2.0);
+    auto g2 = Group::create();
+    g2->transform = g2->transform.scaled(1.0, 2.0, 3.0);
+    std::dynamic_pointer_cast<Group>(g1)->add(g2);
+    auto s = Sphere::create();
+    s->transform = s->transform.translation(5.0, 0.0, 0.0);
+    std::dynamic_pointer_cast<Group>(g2)->add(s);
+    auto point = Tuple::point(-2.0, 1.0, -10.0);
+    auto normal = Tuple::vector(sqrt(3.0) / 3.0, sqrt(3.0) / 3.0, sqrt(3.0) / 3.0);
+    auto expectedPoint = s->worldToObject(point);
+    auto expectedNormal = s->normalToWorld(normal);
+    g1->freeze();
+    CHECK(s->worldToObject(point) == expectedPoint);
+    CHECK(s->normalToWorld(normal) == expectedNormal);
+    CHECK(s->normalAt({1.7321, 1.1547, -5.5774, 1.0}, {}) == Tuple(0.2857, 0.4286, -0.8571, 0.0));
+  }
+  SUBCASE("A frozen child follows changes to its own transform") {
+    auto g = Group::create();
+    g->transform = g->transform.scaled(2.0, 2.0, 2.0);
+    auto s = Sphere::create();
+    std::dynamic_pointer_cast<Group>(g)->add(s);
+    g->freeze();
+    s->transform = Transform::translation(5.0, 0.0, 0.0);
+    CHECK(s->worldToObject(Tuple::point(10.0, 0.0, 0.0)) == Tuple::point(0.0, 0.0, 0.0));
+  }
+  SUBCASE("A frozen child follows changes to a parent's transform") {
+    auto g1 = Group::create();
+    auto g2 = Group::create();
+    std::dynamic_pointer_cast<Group>(g1)->add(g2);
+    auto s = Sphere::create();
+    std::dynamic_pointer_cast<Group>(g2)->add(s);
+    g1->freeze();
+    g1->transform = Transform::scaling(1.0, 2.0, 1.0);
+    CHECK(s->worldToObject(Tuple::point(0.0, 2.0, 0.0)) == Tuple::point(0.0, 1.0, 0.0));
+    CHECK(s->normalToWorld(Tuple::vector(0.0, 1.0, 0.0)) == Tuple::vector(0.0, 1.0, 0.0));
+    CHECK(s->normalToWorld(Tuple::vector(1.0, 1.0, 0.0).normalize())
+          == Tuple::vector(2.0, 1.0, 0.0).normalize());
+    g1->thaw();
+    g1->transform = Transform::translation(0.0, 0.0, 4.0);
+    g2->freeze();
+    CHECK(s->worldToObject(Tuple::point(0.0, 0.0, 4.0)) == Tuple::point(0.0, 0.0, 0.0));
+  }
+  SUBCASE("A frozen child follows a parent's transform copied from another shape") {
+    auto g = Group::create();
+    auto s = Sphere::create();
+    std::dynamic_pointer_cast<Group>(g)->add(s);
+    g->freeze();
+    auto other = Sphere::create();
+    other->transform = Transform::translation(0.0, 0.0, 4.0);
+    g->transform = other->transform;
+    CHECK(s->worldToObject(Tuple::point(0.0, 0.0, 4.0)) == Tuple::point(0.0, 0.0, 0.0));
+    g->freeze();
+    CHECK(s->worldToObject(Tuple::point(0.0, 0.0, 4.0)) == Tuple::point(0.0, 0.0, 0.0));
+  }
+  SUBCASE("Refreezing a group recomposes the children of a moved subgroup") {
+    auto g1 = Group::create();
+    auto g2 = Group::create();
+    auto g3 = Group::create();
+    std::dynamic_pointer_cast<Group>(g1)->add(g2);
+    std::dynamic_pointer_cast<Group>(g1)->add(g3);
+    auto s2 = Sphere::create();
+    auto s3 = Sphere::create();
+    std::dynamic_pointer_cast<Group>(g2)->add(s2);
+    std::dynamic_pointer_cast<Group>(g3)->add(s3);
+    g1->freeze();
+    g2->transform = Transform::translation(0.0, 3.0, 0.0);
+    g1->freeze();
+    CHECK(s2->worldToObject(Tuple::point(0.0, 3.0, 0.0)) == Tuple::point(0.0, 0.0, 0.0));
+    CHECK(s3->worldToObject(Tuple::point(0.0, 3.0, 0.0)) == Tuple::point(0.0, 3.0, 0.0));
+    g1->transform = Transform::scaling(2.0, 2.0, 2.0);
+    g1->freeze();
+    CHECK(s2->worldToObject(Tuple::point(0.0, 6.0, 0.0)) == Tuple::point(0.0, 0.0, 0.0));
+    CHECK(s3->worldToObject(Tuple::point(0.0, 6.0, 0.0)) == Tuple::point(0.0, 3.0, 0.0));
+  }
+  SUBCASE("Adding a frozen shape to a group thaws it") {
+    auto s = Sphere::create();
+    s->freeze();
+    auto g = Group::create();
+    g->transform = Transform::translation(1.0, 0.0, 0.0);
+    std::dynamic_pointer_cast<Group>(g)->add(s);
+    CHECK(s->worldToObject(Tuple::point(1.0, 0.0, 0.0)) == Tuple::point(0.0, 0.0, 0.0));
+  }
   SUBCASE("A group has a bounding box which contains its children") {
     auto s = Sphere::create();
     s->transform = s->transform.scaled(2.0, 2.0, 2.0).translated(2.0, 5.0, -3.0);
@@ -168,6 +284,133 @@ TEST_CASE("Groups") {
     CHECK(subGroup.objects[1]->includes(*s2));
     CHECK(subGroup.objects[1]->includes(*s3));
   }
+  SUBCASE("Subdividing a group with the surface area heuristic") {
+    auto g = Group();
+    std::vector<std::shared_ptr<Shape>> left;
+    std::vector<std::shared_ptr<Shape>> right;
+    for (int i = 0; i < 4; i++) {
+      auto s1 = Sphere::create();
+      s1->transform = s1->transform.translated(-10.0, i * 2.0, 0.0);
+      auto s2 = Sphere::create();
+      s2->transform = s2->transform.translated(10.0, i * 2.0, 0.0);
+      g.add(s1);
+      g.add(s2);
+      left.push_back(s1);
+      right.push_back(s2);
+    }
+    auto options = BVHOptions();
+    options.maxLeafSize = 4;
+    g.divide(options);
+    CHECK(g.objects.size() == 2);
+    auto first = std::dynamic_pointer_cast<Group>(g.objects[0]);
+    auto second = std::dynamic_pointer_cast<Group>(g.objects[1]);
+    for (int i = 0; i < 4; i++) {
+      CHECK(first->includes(*left[i]));
+      CHECK(second->includes(*right[i]));
+      CHECK(left[i]->parent != nullptr);
+    }
+    CHECK(g.bounds().min == Tuple(-11.0, -1.0, -1.0, 1.0));
+    CHECK(g.bounds().max == Tuple(11.0, 7.0, 1.0, 1.0));
+    auto xs = g.localIntersect({{10.0, 4.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}});
+    CHECK(xs.size() == 2);
+    CHECK(xs[0].object == right[2].get());
+    CHECK(g.buildStats.leaves >= 2);
+    CHECK(g.buildStats.nodes == 2 * g.buildStats.leaves - 1);
+    CHECK(g.buildStats.buildSeconds >= 0.0);
+  }
+  SUBCASE("Subdividing a group with Morton codes") {
+    auto g = Group::create();
+    for (int i = 0; i < 20; i++) {
+      auto s = Sphere::create();
+      s->transform = s->transform.translated(i % 5 * 3.0, i / 5 * 3.0, 0.0);
+      std::dynamic_pointer_cast<Group>(g)->add(s);
+    }
+    auto r = Ray({6.0, 3.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    auto before = g->intersect(r);
+    auto options = BVHOptions();
+    options.method = BVHMethod::Morton;
+    g->divide(options);
+    auto group = std::dynamic_pointer_cast<Group>(g);
+    CHECK(group->objects.size() == 2);
+    CHECK(group->buildStats.sahCost > 0.0);
+    auto after = g->intersect(r);
+    CHECK(after.size() == 2);
+    CHECK(after[0] == before[0]);
+  }
+  SUBCASE("Subdividing with the surface area heuristic keeps unbounded children") {
+    auto g = Group();
+    auto plane = Plane::create();
+    g.add(plane);
+    for (int i = 0; i < 8; i++) {
+      auto s = Sphere::create();
+      s->transform = s->transform.translated(i * 3.0, 0.0, 0.0);
+      g.add(s);
+    }
+    auto options = BVHOptions();
+    options.maxLeafSize = 2;
+    g.divide(options);
+    CHECK(g.objects.size() == 3);
+    CHECK(g.objects[0] == plane);
+    CHECK(g.includes(*plane));
+  }
+  SUBCASE("Refitting a group recomputes its bounds") {
+    auto g = Group();
+    auto s1 = Sphere::create();
+    auto s2 = Sphere::create();
+    s2->transform = Matrix::translation(10.0, 0.0, 0.0);
+    g.add(s1);
+    g.add(s2);
+    CHECK(g.bounds().max == Tuple::point(11.0, 1.0, 1.0));
+    s2->transform = Matrix::translation(2.0, 0.0, 0.0);
+    g.refit();
+    CHECK(g.bounds().max == Tuple::point(3.0, 1.0, 1.0));
+    CHECK(g.bounds().min == Tuple::point(-1.0, -1.0, -1.0));
+  }
+  SUBCASE("Refitting a divided group keeps its hierarchy while it stays cheap") {
+    auto g = Group();
+    std::vector<std::shared_ptr<Shape>> spheres;
+    for (int i = 0; i < 16; i++) {
+      auto s = Sphere::create();
+      s->transform = Matrix::translation(i * 3.0, 0.0, 0.0);
+      g.add(s);
+      spheres.push_back(s);
+    }
+    auto options = BVHOptions();
+    options.maxLeafSize = 2;
+    g.divide(options);
+    auto children = g.objects;
+    spheres[15]->transform = Matrix::translation(45.5, 0.0, 0.0);
+    g.refit();
+    CHECK(g.objects == children);
+    CHECK(g.bounds().max == Tuple::point(46.5, 1.0, 1.0));
+    auto xs = g.localIntersect({{45.5, 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}});
+    CHECK(xs.size() == 2);
+    CHECK(xs[0].object == spheres[15].get());
+  }
+  SUBCASE("Refitting a divided group rebuilds it once its cost has degraded") {
+    auto g = Group();
+    std::vector<std::shared_ptr<Shape>> spheres;
+    for (int i = 0; i < 16; i++) {
+      auto s = Sphere::create();
+      s->transform = Matrix::translation(i * 3.0, 0.0, 0.0);
+      g.add(s);
+      spheres.push_back(s);
+    }
+    auto options = BVHOptions();
+    options.maxLeafSize = 2;
+    g.divide(options);
+    auto cost = g.sahCost(options);
+    for (int i = 0; i < 16; i++) {
+      spheres[i]->transform = Matrix::translation((i * 7 % 16) * 3.0, 0.0, 0.0);
+    }
+    g.refit();
+    CHECK(std::abs(g.sahCost(options) - cost) < 1e-9);
+    for (int i = 0; i < 16; i++) {
+      auto xs = g.localIntersect({{Scalar(i * 7 % 16 * 3), 0.0, -5.0, 1.0}, {0.0, 0.0, 1.0, 0.0}});
+      CHECK(xs.size() == 2);
+      CHECK(xs[0].object == spheres[i].get());
+    }
+  }
   SUBCASE("Child objects inherit their material from their group") {
     auto s1 = Sphere::create();
     auto s2 = Sphere::create();
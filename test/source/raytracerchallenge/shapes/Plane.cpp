@@ -38,7 +38,7 @@ TEST_CASE("Planes") {
     auto xs = plane->localIntersect(ray);
     CHECK(xs.size() == 1);
     CHECK(xs[0].t == 1);
-    CHECK(xs[0].object == plane);
+    CHECK(xs[0].object == plane.get());
   }
   SUBCASE("A ray intersecting a plane from below") {
     Tuple origin = Tuple::point(0.0, -1.0, 0.0);
@@ -48,7 +48,7 @@ TEST_CASE("Planes") {
     auto xs = plane->localIntersect(ray);
     CHECK(xs.size() == 1);
     CHECK(xs[0].t == 1);
-    CHECK(xs[0].object == plane);
+    CHECK(xs[0].object == plane.get());
   }
   SUBCASE("A plane has a bounding box") {
     auto plane = Plane::create();
@@ -56,4 +56,12 @@ TEST_CASE("Planes") {
     CHECK(b.min == Tuple(-INFINITY, 0.0, -INFINITY, 1.0));
     CHECK(b.max == Tuple(INFINITY, 0.0, INFINITY, 1.0));
   }
-}
\ No newline at end of file
+  SUBCASE("Testing a segment against a plane for any intersection") {
+    auto plane = Plane::create();
+    auto ray = Ray(Tuple::point(0.0, 1.0, 0.0), Tuple::vector(0.0, -1.0, 0.0));
+    CHECK(plane->localIntersectsAny(ray, 0.0, INFINITY));
+    CHECK_FALSE(plane->localIntersectsAny(ray, 0.0, 1.0));
+    CHECK_FALSE(plane->localIntersectsAny(
+        Ray(Tuple::point(0.0, 10.0, 0.0), Tuple::vector(0.0, 0.0, 1.0)), 0.0, INFINITY));
+  }
+}
@@ -72,4 +72,14 @@ TEST_CASE("Spheres") {
     CHECK(b.min == Tuple(-1.0, -1.0, -1.0, 1.0));
     CHECK(b.max == Tuple(1.0, 1.0, 1.0, 1.0));
   }
-}
\ No newline at end of file
+  SUBCASE("Testing a segment against a sphere for any intersection") {
+    auto sphere = Sphere::create();
+    auto ray = Ray(Tuple::point(0.0, 0.0, -5.0), Tuple::vector(0.0, 0.0, 1.0));
+    CHECK(sphere->localIntersectsAny(ray, 0.0, INFINITY));
+    CHECK(sphere->localIntersectsAny(ray, 5.0, INFINITY));
+    CHECK_FALSE(sphere->localIntersectsAny(ray, 0.0, 4.0));
+    CHECK_FALSE(sphere->localIntersectsAny(ray, 6.5, INFINITY));
+    sphere->material->castShadow = false;
+    CHECK_FALSE(sphere->localIntersectsAny(ray, 0.0, INFINITY));
+  }
+}
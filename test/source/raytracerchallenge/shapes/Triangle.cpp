@@ -2,6 +2,8 @@
 #include <raytracerchallenge/base/Intersections.h>
 #include <raytracerchallenge/shapes/Triangle.h>
 
+#include <cmath>
+
 using namespace raytracerchallenge;
 
 TEST_CASE("Triangles") {
@@ -42,6 +44,41 @@ TEST_CASE("Triangles") {
     CHECK(xs.size() == 1);
     CHECK(xs[0].t == 2.0);
   }
+  SUBCASE("The watertight test agrees with Möller–Trumbore inside a triangle") {
+    auto t = Triangle::create({0.0, 1.0, 0.0, 1.0}, {-1.0, 0.0, 0.0, 1.0}, {1.0, 0.0, 0.0, 1.0});
+    auto r = Ray({-0.2, 0.3, -2.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    auto expected = t->localIntersect(r);
+    std::dynamic_pointer_cast<Triangle>(t)->watertight = true;
+    auto xs = t->localIntersect(r);
+    CHECK(xs.size() == 1);
+    CHECK(std::abs(xs[0].t - expected[0].t) < EPS);
+    CHECK(std::abs(xs[0].u - expected[0].u) < EPS);
+    CHECK(std::abs(xs[0].v - expected[0].v) < EPS);
+    CHECK(t->localIntersect({{1.0, 1.0, -2.0, 1.0}, {0.0, 0.0, 1.0, 0.0}}).empty());
+    CHECK(t->localIntersect({{0.0, -1.0, -2.0, 1.0}, {0.0, 1.0, 0.0, 0.0}}).empty());
+  }
+  SUBCASE("A watertight ray through a shared edge hits a triangle") {
+    // Both triangles exclude the edge they share, which rounding leaves rays slipping through
+    auto p = Tuple::point(0.1, 0.2, 0.3);
+    auto q = Tuple::point(1.7, -0.9, 0.45);
+    auto a = Triangle::create(p, q, Tuple::point(0.3, 1.1, 0.2));
+    auto b = Triangle::create(q, p, Tuple::point(0.9, -1.5, 0.6));
+    auto missed = 0;
+    auto watertightMissed = 0;
+    for (auto i = 1; i < 200; i++) {
+      auto target = p + (q - p) * (i / 200.0);
+      auto origin = Tuple::point(0.3 + std::sin(i * 0.7), -0.2 + std::cos(i * 0.3), -1.0);
+      auto r = Ray(origin, (target - origin).normalize());
+      std::dynamic_pointer_cast<Triangle>(a)->watertight = false;
+      std::dynamic_pointer_cast<Triangle>(b)->watertight = false;
+      missed += a->localIntersect(r).size() + b->localIntersect(r).size() == 0 ? 1 : 0;
+      std::dynamic_pointer_cast<Triangle>(a)->watertight = true;
+      std::dynamic_pointer_cast<Triangle>(b)->watertight = true;
+      watertightMissed += a->localIntersect(r).size() + b->localIntersect(r).size() == 0 ? 1 : 0;
+    }
+    CHECK(missed > 0);
+    CHECK(watertightMissed == 0);
+  }
   SUBCASE("A triangle has a bounding box") {
     auto p1 = Tuple::point(-3.0, 7.0, 2.0);
     auto p2 = Tuple::point(6.0, 2.0, -4.0);
@@ -51,4 +88,29 @@ TEST_CASE("Triangles") {
     CHECK(box.max == Tuple::point(6.0, 7.0, 2.0));
     CHECK(box.min == Tuple::point(-3.0, -1.0, -4.0));
   }
-}
\ No newline at end of file
+  SUBCASE("Testing a segment against a triangle for any intersection") {
+    auto t = Triangle::create({0.0, 1.0, 0.0, 1.0}, {-1.0, 0.0, 0.0, 1.0}, {1.0, 0.0, 0.0, 1.0});
+    auto r = Ray({0.0, 0.5, -2.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    CHECK(t->localIntersectsAny(r, 0.0, INFINITY));
+    CHECK_FALSE(t->localIntersectsAny(r, 0.0, 2.0));
+    CHECK_FALSE(t->localIntersectsAny({{1.0, 1.0, -2.0, 1.0}, {0.0, 0.0, 1.0, 0.0}}, 0.0,
+                                      INFINITY));
+  }
+  SUBCASE("Clipping a triangle to a box bounds only the part inside it") {
+    auto t = Triangle::create(Tuple::point(0.0, 0.0, 0.0), Tuple::point(4.0, 0.0, 0.0),
+                              Tuple::point(0.0, 4.0, 0.0));
+    auto box = t->clippedBounds({Tuple::point(3.0, 3.0, -1.0), Tuple::point(5.0, 5.0, 1.0)});
+    CHECK(box.isEmpty());
+    box = t->clippedBounds({Tuple::point(2.0, -1.0, -1.0), Tuple::point(5.0, 5.0, 1.0)});
+    CHECK(box.min == Tuple::point(2.0, 0.0, 0.0));
+    CHECK(box.max == Tuple::point(4.0, 2.0, 0.0));
+  }
+  SUBCASE("Clipping a transformed triangle") {
+    auto t = Triangle::create(Tuple::point(0.0, 0.0, 0.0), Tuple::point(4.0, 0.0, 0.0),
+                              Tuple::point(0.0, 4.0, 0.0));
+    t->transform = Matrix::translation(10.0, 0.0, 0.0);
+    auto box = t->clippedBounds({Tuple::point(12.0, -1.0, -1.0), Tuple::point(20.0, 5.0, 1.0)});
+    CHECK(box.min == Tuple::point(12.0, 0.0, 0.0));
+    CHECK(box.max == Tuple::point(14.0, 2.0, 0.0));
+  }
+}
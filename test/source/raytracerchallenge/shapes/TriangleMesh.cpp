@@ -0,0 +1,199 @@
+#include <doctest/doctest.h>
+#include <raytracerchallenge/acceleration/WideBVH.h>
+#include <raytracerchallenge/base/Computations.h>
+#include <raytracerchallenge/base/Intersections.h>
+#include <raytracerchallenge/shapes/Group.h>
+#include <raytracerchallenge/shapes/SmoothTriangle.h>
+#include <raytracerchallenge/shapes/TriangleMesh.h>
+
+#include <cmath>
+
+using namespace raytracerchallenge;
+
+/**
+ * A bumpy height field of size x size quads, each split into two triangles
+ */
+static std::shared_ptr<TupleArrays> heightField(int size, std::vector<std::uint32_t> &indices) {
+  auto vertices = std::make_shared<TupleArrays>();
+  for (int z = 0; z <= size; z++) {
+    for (int x = 0; x <= size; x++) {
+      vertices->add(Tuple::point(x, 0.3 * std::sin(x * 0.7) * std::cos(z * 0.4), z));
+    }
+  }
+  auto vertex = [size](int x, int z) { return std::uint32_t(z * (size + 1) + x); };
+  for (int z = 0; z < size; z++) {
+    for (int x = 0; x < size; x++) {
+      indices.insert(indices.end(), {vertex(x, z), vertex(x + 1, z), vertex(x, z + 1)});
+      indices.insert(indices.end(), {vertex(x + 1, z), vertex(x + 1, z + 1), vertex(x, z + 1)});
+    }
+  }
+  return vertices;
+}
+
+/**
+ * Check that a height field shrunk by the given scale and moved to the given
+ * offset reports every hit that its triangles do alone, for rays aimed at the
+ * corners and edges of its triangles
+ */
+static void checkMeshAgainstTriangles(double scale, const Tuple &offset, bool watertight = false) {
+  std::vector<std::uint32_t> indices;
+  auto field = heightField(6, indices);
+  auto vertices = std::make_shared<TupleArrays>();
+  for (std::uint32_t i = 0; i < field->size(); i++) {
+    vertices->add(offset + field->vector(i) * scale);
+  }
+  auto mesh = TriangleMesh::create(vertices, indices);
+  std::dynamic_pointer_cast<TriangleMesh>(mesh)->watertight = watertight;
+  std::vector<std::shared_ptr<Shape>> triangles;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    triangles.push_back(Triangle::create(vertices->point(indices[i]),
+                                         vertices->point(indices[i + 1]),
+                                         vertices->point(indices[i + 2])));
+    std::dynamic_pointer_cast<Triangle>(triangles.back())->watertight = watertight;
+  }
+  auto hits = 0;
+  for (int i = 0; i < 150; i++) {
+    // Aim at a corner of one of the triangles, or somewhere along one of its edges
+    const auto *corners = &indices[3 * (size_t(i * 5) % triangles.size())];
+    auto from = vertices->point(corners[i % 3]);
+    auto to = vertices->point(corners[(i + 1) % 3]);
+    auto target = from + (to - from) * (i % 4 == 0 ? 0.0 : std::abs(std::sin(i * 0.9)));
+    auto origin
+        = target + Tuple::vector(3.0 * std::sin(i * 0.3), 4.0, 3.0 * std::cos(i * 0.5)) * scale;
+    auto ray = Ray(origin, (target - origin).normalize());
+    auto expected = 0U;
+    for (const auto &triangle : triangles) {
+      expected += unsigned(triangle->localIntersect(ray).size());
+    }
+    auto actual = mesh->intersect(ray);
+    CHECK(actual.size() == expected);
+    auto closest = Intersection();
+    CHECK(mesh->intersectClosest(ray, 0.0, INFINITY, closest) == (expected > 0));
+    CHECK(mesh->intersectsAny(ray, 0.0, INFINITY) == (expected > 0));
+    hits += expected > 0 ? 1 : 0;
+  }
+  CHECK(hits > 100);
+}
+
+TEST_CASE("Triangle meshes") {
+  SUBCASE("A mesh finds the same intersections as a group of triangles") {
+    std::vector<std::uint32_t> indices;
+    auto vertices = heightField(12, indices);
+    auto mesh = TriangleMesh::create(vertices, indices);
+    auto triangles = std::dynamic_pointer_cast<TriangleMesh>(mesh);
+    CHECK(triangles->triangleCount() == 12 * 12 * 2);
+    CHECK(triangles->packetWidth() == (WideBVH::supportsWidth(8) ? 8U : 4U));
+    auto group = Group::create();
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      std::dynamic_pointer_cast<Group>(group)->add(
+          Triangle::create(vertices->point(indices[i]), vertices->point(indices[i + 1]),
+                           vertices->point(indices[i + 2])));
+    }
+    CHECK(mesh->bounds().min == group->bounds().min);
+    CHECK(mesh->bounds().max == group->bounds().max);
+    for (int i = 0; i < 60; i++) {
+      auto ray = Ray(Tuple::point(0.37 + i * 0.19, 3.0, -2.0 + i * 0.11),
+                     Tuple::vector(0.1 * (i % 3), -1.0, 0.4).normalize());
+      auto expected = group->intersect(ray);
+      auto actual = mesh->intersect(ray);
+      CHECK(actual.size() == expected.size());
+      for (size_t j = 0; j < std::min(actual.size(), expected.size()); j++) {
+        CHECK(std::abs(actual[j].t - expected[j].t) < EPS);
+        CHECK(actual[j].object == mesh.get());
+        CHECK(mesh->normalAt(ray.position(actual[j].t), actual[j])
+              == expected[j].object->normalAt(ray.position(expected[j].t), expected[j]));
+      }
+      auto closest = Intersection();
+      auto hit = expected.hit();
+      CHECK(mesh->intersectClosest(ray, 0.0, INFINITY, closest) == hit.has_value());
+      CHECK((!hit.has_value() || std::abs(closest.t - hit->t) < EPS));
+      CHECK(mesh->intersectsAny(ray, 0.0, INFINITY) == hit.has_value());
+    }
+  }
+  SUBCASE("An intersection with a mesh records the triangle hit") {
+    auto vertices = std::make_shared<TupleArrays>();
+    for (int i = 0; i < 4; i++) {
+      vertices->add(Tuple::point(i, 0.0, 0.0));
+      vertices->add(Tuple::point(i, 1.0, 0.0));
+    }
+    auto mesh = TriangleMesh::create(vertices, {0, 2, 1, 2, 4, 3, 4, 6, 5});
+    auto triangles = std::dynamic_pointer_cast<TriangleMesh>(mesh);
+    for (int i = 0; i < 3; i++) {
+      auto xs = mesh->intersect(Ray(Tuple::point(i + 0.25, 0.25, -2.0), Tuple::vector(0, 0, 1)));
+      CHECK(xs.size() == 1);
+      CHECK(xs[0].t == 2.0);
+      const auto *corners = &triangles->indices[3 * xs[0].primitive];
+      CHECK(vertices->x[corners[0]] == Scalar(i));
+    }
+  }
+  SUBCASE("Hits on two triangles of a mesh at a shared edge are distinct") {
+    auto vertices = std::make_shared<TupleArrays>();
+    vertices->add(Tuple::point(0.0, 0.0, 0.0));
+    vertices->add(Tuple::point(1.0, 0.0, 0.0));
+    vertices->add(Tuple::point(0.0, 1.0, 0.0));
+    vertices->add(Tuple::point(1.0, 1.0, 0.0));
+    auto mesh = TriangleMesh::create(vertices, {0, 1, 2, 1, 3, 2});
+    std::dynamic_pointer_cast<TriangleMesh>(mesh)->watertight = true;
+    auto xs = mesh->intersect(Ray(Tuple::point(0.5, 0.5, -2.0), Tuple::vector(0.0, 0.0, 1.0)));
+    CHECK(xs.size() == 2);
+    CHECK(xs[0].t == xs[1].t);
+    CHECK(xs[0].primitive != xs[1].primitive);
+    CHECK_FALSE(xs[0] == xs[1]);
+  }
+  SUBCASE("A smooth mesh interpolates its vertex normals") {
+    auto vertices = std::make_shared<TupleArrays>();
+    vertices->add(Tuple::point(0.0, 1.0, 0.0));
+    vertices->add(Tuple::point(-1.0, 0.0, 0.0));
+    vertices->add(Tuple::point(1.0, 0.0, 0.0));
+    auto normals = std::make_shared<TupleArrays>();
+    normals->add(Tuple::vector(-1.0, 0.0, 0.0));
+    normals->add(Tuple::vector(1.0, 0.0, 0.0));
+    normals->add(Tuple::vector(0.0, 1.0, 0.0));
+    auto mesh = TriangleMesh::create(vertices, {0, 1, 2}, normals, {2, 0, 1});
+    CHECK(std::dynamic_pointer_cast<TriangleMesh>(mesh)->isSmooth());
+    auto r = Ray({-0.2, 0.3, -2.0, 1.0}, {0.0, 0.0, 1.0, 0.0});
+    auto xs = mesh->intersect(r);
+    CHECK(xs.size() == 1);
+    CHECK(std::abs(xs[0].u - 0.45) < 0.001);
+    CHECK(std::abs(xs[0].v - 0.25) < 0.001);
+    auto comps = xs[0].prepareComputations(r);
+    CHECK(comps.normalVector == Tuple::vector(-0.5547, 0.83205, 0.0));
+  }
+  SUBCASE("A watertight mesh lets no ray through its shared edges and vertices") {
+    std::vector<std::uint32_t> indices;
+    auto vertices = heightField(6, indices);
+    auto mesh = TriangleMesh::create(vertices, indices);
+    std::dynamic_pointer_cast<TriangleMesh>(mesh)->watertight = true;
+    auto missed = 0;
+    for (int z = 0; z <= 12; z++) {
+      for (int x = 0; x <= 12; x++) {
+        auto ray = Ray(Tuple::point(x * 0.5, 2.0, z * 0.5), Tuple::vector(0.0, -1.0, 0.0));
+        auto closest = Intersection();
+        if (mesh->intersect(ray).empty() || !mesh->intersectClosest(ray, 0.0, INFINITY, closest)
+            || !mesh->intersectsAny(ray, 0.0, INFINITY)) {
+          missed++;
+        }
+      }
+    }
+    CHECK(missed == 0);
+  }
+  SUBCASE("A tiny mesh reports every hit its triangles do") {
+    checkMeshAgainstTriangles(0.0001, Tuple::point(3.0, -2.0, 1.0));
+  }
+  SUBCASE("A mesh far from the origin reports every hit its triangles do") {
+    checkMeshAgainstTriangles(0.25, Tuple::point(10000.0, -7000.0, 12000.0));
+  }
+  SUBCASE("A watertight mesh reports every hit its triangles do at any scale") {
+    checkMeshAgainstTriangles(0.0001, Tuple::point(3.0, -2.0, 1.0), true);
+    checkMeshAgainstTriangles(0.25, Tuple::point(10000.0, -7000.0, 12000.0), true);
+  }
+  SUBCASE("A mesh which casts no shadow is ignored by shadow rays") {
+    std::vector<std::uint32_t> indices;
+    auto vertices = heightField(2, indices);
+    auto mesh = TriangleMesh::create(vertices, indices);
+    auto ray = Ray(Tuple::point(0.3, 2.0, 0.4), Tuple::vector(0.0, -1.0, 0.0));
+    CHECK(mesh->intersectsAny(ray, 0.0, INFINITY));
+    mesh->material->castShadow = false;
+    CHECK_FALSE(mesh->intersectsAny(ray, 0.0, INFINITY));
+  }
+}